@@ -0,0 +1,221 @@
+#include "AvlTreeBenchmarks.h"
+#include "AVLTree.h"
+#include <cstdint>
+#include <map>
+#include <random>
+#include <set>
+
+namespace {
+    typedef BST_P::AvlTree<int> AvlTreeSet;
+    typedef std::set<int> StdSet;
+    typedef std::map<int, int> StdMap;
+
+    constexpr std::uint32_t FILL_SEED = 1U;
+    constexpr std::uint32_t ACCESS_SEED = 2U;
+    constexpr std::uint32_t MIX_SEED = 3U;
+
+    // Results are written here so the compiler can't throw away the work that produced them.
+    volatile std::uint64_t sink = 0U;
+
+    inline bool InsertKey(AvlTreeSet & tree, int key) { return tree.Insert(key).first; }
+    inline bool InsertKey(StdSet & set, int key) { return set.insert(key).second; }
+    inline bool InsertKey(StdMap & map, int key) { return map.emplace(key, key).second; }
+    inline bool ContainsKey(AvlTreeSet const & tree, int key) { return tree.cFind(key) != tree.cend(); }
+    inline bool ContainsKey(StdSet const & set, int key) { return set.find(key) != set.cend(); }
+    inline bool ContainsKey(StdMap const & map, int key) { return map.find(key) != map.cend(); }
+    inline bool RemoveKey(AvlTreeSet & tree, int key) { return tree.Remove(key); }
+    inline bool RemoveKey(StdSet & set, int key) { return set.erase(key) > 0U; }
+    inline bool RemoveKey(StdMap & map, int key) { return map.erase(key) > 0U; }
+    inline int GetKey(int element) { return element; }
+    inline int GetKey(std::pair<int const, int> const & element) { return element.first; }
+
+    template<class Container> void FillContainer(Container & container, std::vector<int> const & keys) {
+        for (int key : keys) {
+            InsertKey(container, key);
+        }
+    }
+
+    // Times a case's operations, and counts hardware events over the same stretches, leaving its setup out of both.
+    class CaseRecorder final {
+    public:
+        inline CaseRecorder(char const * container, std::size_t size, BST_P::KeyPattern pattern, BST_P::PerfCounters & counters, std::vector<BST_P::BenchmarkResult> & results, std::ostream & log)
+            : _container{container}
+            , _size{size}
+            , _pattern{pattern}
+            , _counters{counters}
+            , _stopwatch{}
+            , _seconds{0.0}
+            , _results{results}
+            , _log{log} {}
+        CaseRecorder(CaseRecorder const &) = delete;
+        CaseRecorder(CaseRecorder &&) noexcept = delete;
+        CaseRecorder & operator=(CaseRecorder const &) = delete;
+        CaseRecorder & operator=(CaseRecorder &&) noexcept = delete;
+        inline ~CaseRecorder() = default;
+
+        // Called before each case's setup, so its peak includes the container it builds.
+        void Begin() {
+            BST_P::ResetPeakRss();
+            _counters.Reset();
+            _seconds = 0.0;
+        }
+
+        // The counters go on last and off first, so they see as little of the stopwatch as possible.
+        inline void StartTiming() {
+            _stopwatch.Restart();
+            _counters.Start();
+        }
+
+        inline void StopTiming() {
+            _counters.Stop();
+            _seconds += _stopwatch.GetElapsedSeconds();
+        }
+
+        void Record(char const * operation, std::uint64_t operationCount) {
+            _results.push_back(BST_P::BenchmarkResult{_container, operation, BST_P::GetKeyPatternName(_pattern), _size, operationCount, _seconds, BST_P::FindPeakRssBytes(), _counters.Read()});
+            BST_P::PrintResult(_log, _results.back());
+        }
+
+    private:
+        char const * _container;
+        std::size_t _size;
+        BST_P::KeyPattern _pattern;
+        BST_P::PerfCounters & _counters;
+        BST_P::Stopwatch _stopwatch;
+        double _seconds;
+        std::vector<BST_P::BenchmarkResult> & _results;
+        std::ostream & _log;
+    };
+
+    template<class Container> void BenchmarkContainer(CaseRecorder & recorder, std::size_t size, BST_P::KeyPattern pattern) {
+        std::size_t const repetitionCount = (MIN_OPERATIONS_PER_CASE + size - 1U) / size;
+        std::vector<int> const fillKeys = BST_P::GenerateKeys(BST_P::KeyPattern::Random, size, size, FILL_SEED);
+        std::uint64_t hits = 0U;
+
+        {
+            recorder.Begin();
+            std::vector<int> keys = BST_P::GenerateKeys(pattern, size, size, ACCESS_SEED);
+
+            for (std::size_t i = 0U; i < repetitionCount; ++i) {
+                Container container;
+                recorder.StartTiming();
+
+                for (int key : keys) {
+                    hits += InsertKey(container, key) ? 1U : 0U;
+                }
+
+                recorder.StopTiming();
+            }
+
+            recorder.Record("insert", static_cast<std::uint64_t>(size) * repetitionCount);
+        }
+
+        {
+            recorder.Begin();
+            Container container;
+            FillContainer(container, fillKeys);
+            std::vector<int> keys = BST_P::GenerateKeys(pattern, size * repetitionCount, size, ACCESS_SEED);
+            recorder.StartTiming();
+
+            for (int key : keys) {
+                hits += ContainsKey(container, key) ? 1U : 0U;
+            }
+
+            recorder.StopTiming();
+            recorder.Record("find", keys.size());
+        }
+
+        {
+            recorder.Begin();
+            std::vector<int> keys = BST_P::GenerateKeys(pattern, size, size, ACCESS_SEED);
+
+            for (std::size_t i = 0U; i < repetitionCount; ++i) {
+                Container container;
+                FillContainer(container, fillKeys);
+                recorder.StartTiming();
+
+                for (int key : keys) {
+                    hits += RemoveKey(container, key) ? 1U : 0U;
+                }
+
+                recorder.StopTiming();
+            }
+
+            recorder.Record("remove", static_cast<std::uint64_t>(size) * repetitionCount);
+        }
+
+        {
+            recorder.Begin();
+            Container container;
+            FillContainer(container, BST_P::GenerateKeys(pattern, size, size, ACCESS_SEED));
+            std::uint64_t visited = 0U;
+            recorder.StartTiming();
+
+            for (std::size_t i = 0U; i < repetitionCount; ++i) {
+                for (auto const & element : container) {
+                    hits += static_cast<std::uint64_t>(GetKey(element));
+                    ++visited;
+                }
+            }
+
+            recorder.StopTiming();
+            recorder.Record("iterate", visited);
+        }
+
+        {
+            recorder.Begin();
+            Container container;
+
+            for (int key : fillKeys) {
+                InsertKey(container, 2 * key);
+            }
+
+            std::vector<int> keys = BST_P::GenerateKeys(pattern, size * repetitionCount, 2U * size, ACCESS_SEED);
+            std::vector<std::uint8_t> operations(keys.size());
+            std::mt19937 random{MIX_SEED};
+            std::uniform_int_distribution<int> quarters{0, 3};
+
+            for (std::uint8_t & operation : operations) {
+                operation = static_cast<std::uint8_t>(quarters(random));
+            }
+
+            recorder.StartTiming();
+
+            for (std::size_t i = 0U; i < keys.size(); ++i) {
+                if (operations[i] < 2U) {
+                    hits += ContainsKey(container, keys[i]) ? 1U : 0U;
+                } else if (operations[i] == 2U) {
+                    hits += InsertKey(container, keys[i]) ? 1U : 0U;
+                } else {
+                    hits += RemoveKey(container, keys[i]) ? 1U : 0U;
+                }
+            }
+
+            recorder.StopTiming();
+            recorder.Record("mixed", keys.size());
+        }
+
+        sink = hits;
+    }
+}
+
+void BenchmarkAvlTree(std::vector<std::size_t> const & sizes, std::vector<BST_P::BenchmarkResult> & results, std::ostream & log) {
+    BST_P::PerfCounters counters;
+
+    if (!counters.GetUnavailableReason().empty()) {
+        log << (counters.IsAnyAvailable() ? "Some hardware counters are unavailable" : "Hardware counters are unavailable") << " (" << counters.GetUnavailableReason() << "), so they won't be reported.\n";
+    }
+
+    for (std::size_t size : sizes) {
+        for (BST_P::KeyPattern pattern : {BST_P::KeyPattern::Random, BST_P::KeyPattern::Sorted, BST_P::KeyPattern::Reverse, BST_P::KeyPattern::Zipfian}) {
+            CaseRecorder avlTreeRecorder{"AvlTree", size, pattern, counters, results, log};
+            BenchmarkContainer<AvlTreeSet>(avlTreeRecorder, size, pattern);
+
+            CaseRecorder setRecorder{"std::set", size, pattern, counters, results, log};
+            BenchmarkContainer<StdSet>(setRecorder, size, pattern);
+
+            CaseRecorder mapRecorder{"std::map", size, pattern, counters, results, log};
+            BenchmarkContainer<StdMap>(mapRecorder, size, pattern);
+        }
+    }
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include "BenchmarkHarness.h"
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+/*
+ * Times AvlTree against std::set and std::map at each size, for every key pattern. The operations are:
+ *   - insert: fills an empty container with every key in the range.
+ *   - find: looks keys up in a full container.
+ *   - remove: empties a full container.
+ *   - iterate: walks a full container from begin to end, the pattern being the order it was filled in, since that decides where its nodes ended up.
+ *   - mixed: 50% finds, 25% inserts and 25% removes, on a container holding every other key of a range twice its size.
+ * Small cases are repeated until they've done at least MIN_OPERATIONS_PER_CASE operations, so every case takes long enough to time.
+ * Each result is printed to log as soon as it's measured, and added to results.
+ */
+void BenchmarkAvlTree(std::vector<std::size_t> const & sizes, std::vector<BST_P::BenchmarkResult> & results, std::ostream & log);
+
+constexpr std::size_t MIN_OPERATIONS_PER_CASE = std::size_t{1U} << 20U;
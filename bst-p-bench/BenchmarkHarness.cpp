@@ -0,0 +1,264 @@
+#include "BenchmarkHarness.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+namespace BST_P {
+
+namespace {
+    // Gray et al.'s generator, the one YCSB uses. Ranks come out in [0, count), rank 0 being the most likely.
+    class ZipfianGenerator final {
+    public:
+        ZipfianGenerator(std::size_t count, double skew)
+            : _count{static_cast<double>(count)}
+            , _skew{skew}
+            , _zetaN{FindZeta(count, skew)}
+            , _alpha{1.0 / (1.0 - skew)}
+            , _eta{(1.0 - std::pow(2.0 / static_cast<double>(count), 1.0 - skew)) / (1.0 - (FindZeta(2U, skew) / _zetaN))} {}
+
+        template<class Random> std::size_t operator()(Random & random) {
+            double u = std::uniform_real_distribution<double>{0.0, 1.0}(random);
+            double uz = u * _zetaN;
+
+            if (uz < 1.0) {
+                return 0U;
+            }
+
+            if (uz < 1.0 + std::pow(0.5, _skew)) {
+                return 1U;
+            }
+
+            return std::min(static_cast<std::size_t>(_count * std::pow((_eta * u) - _eta + 1.0, _alpha)), static_cast<std::size_t>(_count) - 1U);
+        }
+
+    private:
+        static double FindZeta(std::size_t count, double skew) {
+            double zeta = 0.0;
+
+            for (std::size_t i = 1U; i <= count; ++i) {
+                zeta += 1.0 / std::pow(static_cast<double>(i), skew);
+            }
+
+            return zeta;
+        }
+
+        double _count;
+        double _skew;
+        double _zetaN;
+        double _alpha;
+        double _eta;
+    };
+
+    constexpr double ZIPFIAN_SKEW = 0.99;
+    // Multiplying by a prime larger than any key range is a bijection on the range, so hot ranks are spread over it without colliding.
+    constexpr std::uint64_t SCRAMBLE_PRIME = 2654435761ULL;
+
+    void WriteJsonString(std::ostream & stream, std::string const & text) {
+        stream << '"';
+
+        for (char character : text) {
+            if ((character == '"') || (character == '\\')) {
+                stream << '\\' << character;
+            } else if (static_cast<unsigned char>(character) < 0x20U) {
+                stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(character) << std::dec << std::setfill(' ');
+            } else {
+                stream << character;
+            }
+        }
+
+        stream << '"';
+    }
+
+#ifdef __linux__
+    // Reads one of /proc/self/status's sizes, which are given in kB.
+    std::size_t FindStatusBytes(char const * field) {
+        std::ifstream status{"/proc/self/status"};
+        std::string const prefix = std::string{field} + ":";
+        std::string line;
+
+        while (std::getline(status, line)) {
+            if (line.rfind(prefix, 0U) == 0U) {
+                return static_cast<std::size_t>(std::stoull(line.substr(prefix.size()))) * 1024U;
+            }
+        }
+
+        return 0U;
+    }
+#endif
+}
+
+char const * GetKeyPatternName(KeyPattern pattern) {
+    switch (pattern) {
+    case KeyPattern::Random:
+        return "random";
+    case KeyPattern::Sorted:
+        return "sorted";
+    case KeyPattern::Reverse:
+        return "reverse";
+    case KeyPattern::Zipfian:
+        return "zipfian";
+    }
+
+    return "unknown";
+}
+
+std::vector<int> GenerateKeys(KeyPattern pattern, std::size_t count, std::size_t keyRange, std::uint32_t seed) {
+    std::vector<int> keys;
+    keys.reserve(count);
+
+    std::mt19937 random{seed};
+
+    if (pattern == KeyPattern::Zipfian) {
+        ZipfianGenerator zipfian{keyRange, ZIPFIAN_SKEW};
+
+        for (std::size_t i = 0U; i < count; ++i) {
+            keys.push_back(static_cast<int>((zipfian(random) * SCRAMBLE_PRIME) % keyRange));
+        }
+
+        return keys;
+    }
+
+    std::vector<int> pass(keyRange);
+
+    for (std::size_t i = 0U; i < keyRange; ++i) {
+        pass[i] = static_cast<int>((pattern == KeyPattern::Reverse) ? (keyRange - 1U - i) : i);
+    }
+
+    if (pattern == KeyPattern::Random) {
+        std::shuffle(pass.begin(), pass.end(), random);
+    }
+
+    for (std::size_t i = 0U; i < count; ++i) {
+        keys.push_back(pass[i % keyRange]);
+    }
+
+    return keys;
+}
+
+#ifdef _WIN32
+
+std::size_t FindPeakRssBytes() {
+    PROCESS_MEMORY_COUNTERS counters;
+    return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? static_cast<std::size_t>(counters.PeakWorkingSetSize) : 0U;
+}
+
+void ResetPeakRss() {}
+
+std::size_t FindCurrentRssBytes() {
+    PROCESS_MEMORY_COUNTERS counters;
+    return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? static_cast<std::size_t>(counters.WorkingSetSize) : 0U;
+}
+
+#elif defined(__linux__)
+
+std::size_t FindPeakRssBytes() {
+    // VmHWM, unlike getrusage's peak, is what clear_refs resets.
+    return FindStatusBytes("VmHWM");
+}
+
+void ResetPeakRss() {
+    std::ofstream clearRefs{"/proc/self/clear_refs"};
+    clearRefs << "5";
+}
+
+std::size_t FindCurrentRssBytes() {
+    return FindStatusBytes("VmRSS");
+}
+
+#else
+
+std::size_t FindPeakRssBytes() {
+    return 0U;
+}
+
+void ResetPeakRss() {}
+
+std::size_t FindCurrentRssBytes() {
+    return 0U;
+}
+
+#endif
+
+void PrintResult(std::ostream & stream, BenchmarkResult const & result) {
+    std::ios_base::fmtflags flags = stream.flags();
+
+    stream << std::left << std::setw(11) << result.container << std::setw(9) << result.operation << std::setw(9) << result.pattern
+        << std::right << std::setw(10) << result.size
+        << std::fixed << std::setprecision(1) << std::setw(10) << result.GetNanosecondsPerOperation() << " ns/op"
+        << std::setprecision(2) << std::setw(10) << (result.GetOperationsPerSecond() / 1e6) << " Mops/s"
+        << std::setprecision(1) << std::setw(10) << (static_cast<double>(result.peakRssBytes) / (1024.0 * 1024.0)) << " MiB peak";
+
+    if (result.threadCount > 1U) {
+        stream << "  on " << result.threadCount << " threads";
+    }
+
+    for (std::size_t i = 0U; i < PERF_EVENT_COUNT; ++i) {
+        std::optional<double> perOperation = result.GetPerOperation(static_cast<PerfEvent>(i));
+
+        if (perOperation) {
+            stream << "  " << GetPerfEventName(static_cast<PerfEvent>(i)) << "/op " << std::setprecision(2) << *perOperation;
+        }
+    }
+
+    stream << "\n";
+
+    stream.flags(flags);
+}
+
+void WriteResultsAsJson(std::ostream & stream, std::vector<BenchmarkResult> const & results) {
+    std::ios_base::fmtflags flags = stream.flags();
+    std::streamsize precision = stream.precision();
+    stream << std::setprecision(9);
+
+    stream << "{\n  \"benchmark\": \"bst-p-bench\",\n  \"results\": [";
+
+    for (std::size_t i = 0U; i < results.size(); ++i) {
+        BenchmarkResult const & result = results[i];
+
+        stream << ((i == 0U) ? "\n" : ",\n") << "    {\"container\": ";
+        WriteJsonString(stream, result.container);
+        stream << ", \"operation\": ";
+        WriteJsonString(stream, result.operation);
+        stream << ", \"pattern\": ";
+        WriteJsonString(stream, result.pattern);
+        stream << ", \"size\": " << result.size
+            << ", \"operations\": " << result.operationCount
+            << ", \"seconds\": " << result.seconds
+            << ", \"nsPerOp\": " << result.GetNanosecondsPerOperation()
+            << ", \"opsPerSecond\": " << result.GetOperationsPerSecond()
+            << ", \"peakRssBytes\": " << result.peakRssBytes
+            << ", \"threads\": " << result.threadCount
+            << ", \"perOperation\": {";
+
+        // Events that couldn't be counted are null.
+        for (std::size_t j = 0U; j < PERF_EVENT_COUNT; ++j) {
+            std::optional<double> perOperation = result.GetPerOperation(static_cast<PerfEvent>(j));
+            stream << ((j == 0U) ? "" : ", ") << '"' << GetPerfEventName(static_cast<PerfEvent>(j)) << "\": ";
+
+            if (perOperation) {
+                stream << *perOperation;
+            } else {
+                stream << "null";
+            }
+        }
+
+        stream << "}}";
+    }
+
+    stream << "\n  ]\n}\n";
+
+    stream.flags(flags);
+    stream.precision(precision);
+}
+
+}
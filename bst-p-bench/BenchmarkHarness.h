@@ -0,0 +1,77 @@
+#pragma once
+#include "PerfCounters.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace BST_P {
+    // One measured benchmark case.
+    struct BenchmarkResult {
+        std::string container;
+        std::string operation;
+        std::string pattern;
+        std::size_t size;
+        std::uint64_t operationCount;
+        double seconds;
+        // The most the process had resident at once while the case ran, including setup. 0 where it can't be read.
+        std::size_t peakRssBytes;
+        // Over the same timed stretches as seconds.
+        PerfCounts counts;
+        // How many threads shared operationCount between them.
+        unsigned int threadCount = 1U;
+
+        [[nodiscard]] inline double GetNanosecondsPerOperation() const { return (seconds * 1e9) / static_cast<double>(operationCount); }
+        [[nodiscard]] inline double GetOperationsPerSecond() const { return static_cast<double>(operationCount) / seconds; }
+        [[nodiscard]] inline std::optional<double> GetPerOperation(PerfEvent event) const {
+            std::optional<std::uint64_t> const & count = counts[static_cast<std::size_t>(event)];
+            return count ? std::optional<double>{static_cast<double>(*count) / static_cast<double>(operationCount)} : std::nullopt;
+        }
+    };
+
+    /*
+     * The order a benchmark touches its keys in. Every pattern but Zipfian makes passes over the whole key range:
+     * Random shuffles it once and repeats that order, Sorted goes up and Reverse comes down.
+     * Zipfian draws keys independently with skew 0.99, like YCSB, so a handful of keys take most of the draws. Which keys are hot is scrambled across the range.
+     */
+    enum class KeyPattern {
+        Random,
+        Sorted,
+        Reverse,
+        Zipfian,
+    };
+
+    [[nodiscard]] char const * GetKeyPatternName(KeyPattern pattern);
+    // count keys out of [0, keyRange), in pattern's order.
+    [[nodiscard]] std::vector<int> GenerateKeys(KeyPattern pattern, std::size_t count, std::size_t keyRange, std::uint32_t seed);
+
+    class Stopwatch final {
+    public:
+        inline Stopwatch() : _start{std::chrono::steady_clock::now()} {}
+        Stopwatch(Stopwatch const &) = delete;
+        Stopwatch(Stopwatch &&) noexcept = delete;
+        Stopwatch & operator=(Stopwatch const &) = delete;
+        Stopwatch & operator=(Stopwatch &&) noexcept = delete;
+        inline ~Stopwatch() = default;
+
+        inline void Restart() { _start = std::chrono::steady_clock::now(); }
+        [[nodiscard]] inline double GetElapsedSeconds() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count(); }
+
+    private:
+        std::chrono::steady_clock::time_point _start;
+    };
+
+    // The process's peak resident set size. Only Linux can reset it, by way of /proc/self/clear_refs; elsewhere the reset does nothing, so the peak only grows.
+    [[nodiscard]] std::size_t FindPeakRssBytes();
+    void ResetPeakRss();
+    // What the process has resident right now. 0 where it can't be read.
+    [[nodiscard]] std::size_t FindCurrentRssBytes();
+
+    // One line per result, for people.
+    void PrintResult(std::ostream & stream, BenchmarkResult const & result);
+    // Everything in one JSON document, for tracking results over time.
+    void WriteResultsAsJson(std::ostream & stream, std::vector<BenchmarkResult> const & results);
+}
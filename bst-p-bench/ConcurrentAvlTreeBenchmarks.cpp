@@ -0,0 +1,96 @@
+#include "ConcurrentAvlTreeBenchmarks.h"
+#include "AVLTree.h"
+#include "ConcurrentAvlTree.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+
+namespace {
+    // The baseline: one AvlTree behind one reader-writer lock.
+    class SharedMutexAvlTree final {
+    public:
+        bool Contains(int data) const {
+            std::shared_lock<std::shared_mutex> lock{_mutex};
+            return _tree.cFind(data) != _tree.cend();
+        }
+
+        bool Insert(int data) {
+            std::unique_lock<std::shared_mutex> lock{_mutex};
+            return _tree.Insert(data).first;
+        }
+
+        bool Remove(int data) {
+            std::unique_lock<std::shared_mutex> lock{_mutex};
+            return _tree.Remove(data);
+        }
+
+    private:
+        mutable std::shared_mutex _mutex;
+        BST_P::AvlTree<int> _tree;
+    };
+
+    template<class Tree> void MeasureThroughput(char const * container, unsigned int threadCount, unsigned int findPercent, std::vector<BST_P::BenchmarkResult> & results, std::ostream & log) {
+        BST_P::ResetPeakRss();
+        Tree tree;
+
+        for (int i = 0; i < CONCURRENT_KEY_RANGE; i += 2) {
+            tree.Insert(i);
+        }
+
+        std::vector<std::thread> threads;
+        std::atomic<unsigned int> readyThreads{0U};
+        std::atomic<bool> isStarted{false};
+
+        for (unsigned int t = 0U; t < threadCount; ++t) {
+            threads.emplace_back([&tree, &readyThreads, &isStarted, findPercent, t]() {
+                std::mt19937 rng{t};
+                std::uniform_int_distribution<int> keys{0, CONCURRENT_KEY_RANGE - 1};
+                std::uniform_int_distribution<unsigned int> operations{0U, 99U};
+
+                ++readyThreads;
+                while (!isStarted.load()) {}
+
+                for (int i = 0; i < CONCURRENT_OPERATIONS_PER_THREAD; ++i) {
+                    int key = keys(rng);
+                    unsigned int operation = operations(rng);
+
+                    if (operation < findPercent) {
+                        (void)tree.Contains(key);
+                    } else if ((operation - findPercent) % 2U == 0U) {
+                        tree.Insert(key);
+                    } else {
+                        tree.Remove(key);
+                    }
+                }
+            });
+        }
+
+        while (readyThreads.load() < threadCount) {}
+
+        BST_P::Stopwatch stopwatch;
+        isStarted.store(true);
+
+        for (auto & thread : threads) {
+            thread.join();
+        }
+
+        double seconds = stopwatch.GetElapsedSeconds();
+        std::uint64_t operationCount = static_cast<std::uint64_t>(threadCount) * CONCURRENT_OPERATIONS_PER_THREAD;
+
+        results.push_back(BST_P::BenchmarkResult{container, "find" + std::to_string(findPercent), "uniform", CONCURRENT_KEY_RANGE / 2, operationCount, seconds, BST_P::FindPeakRssBytes(), BST_P::PerfCounts{}, threadCount});
+        BST_P::PrintResult(log, results.back());
+    }
+}
+
+void BenchmarkConcurrentAvlTree(std::vector<BST_P::BenchmarkResult> & results, std::ostream & log) {
+    for (unsigned int findPercent : {90U, 50U, 0U}) {
+        for (unsigned int threadCount = 1U; threadCount <= MAX_CONCURRENT_THREADS; threadCount *= 2U) {
+            MeasureThroughput<SharedMutexAvlTree>("Locked", threadCount, findPercent, results, log);
+            MeasureThroughput<BST_P::ConcurrentAvlTree<int>>("Concurrent", threadCount, findPercent, results, log);
+        }
+    }
+}
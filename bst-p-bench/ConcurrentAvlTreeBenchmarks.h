@@ -0,0 +1,17 @@
+#pragma once
+#include "BenchmarkHarness.h"
+#include <ostream>
+#include <vector>
+
+/*
+ * Times ConcurrentAvlTree against an AvlTree behind a std::shared_mutex at 1 to MAX_CONCURRENT_THREADS threads, for a few operation mixes.
+ * Each case fills every other key of a range of CONCURRENT_KEY_RANGE, then has every thread run CONCURRENT_OPERATIONS_PER_THREAD operations on uniformly random keys.
+ * The operation is named for its share of finds; the rest are split evenly between inserts and removes, so the tree stays about half full.
+ * Performance counters only ever see the thread that opened them, so these results don't have any.
+ * Each result is printed to log as soon as it's measured, and added to results.
+ */
+void BenchmarkConcurrentAvlTree(std::vector<BST_P::BenchmarkResult> & results, std::ostream & log);
+
+constexpr unsigned int MAX_CONCURRENT_THREADS = 64U;
+constexpr int CONCURRENT_KEY_RANGE = 1 << 16;
+constexpr int CONCURRENT_OPERATIONS_PER_THREAD = 200000;
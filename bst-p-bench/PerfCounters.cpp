@@ -0,0 +1,148 @@
+#include "PerfCounters.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <utility>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace BST_P {
+
+char const * GetPerfEventName(PerfEvent event) {
+    switch (event) {
+    case PerfEvent::Cycles:
+        return "cycles";
+    case PerfEvent::Instructions:
+        return "instructions";
+    case PerfEvent::L1dMisses:
+        return "l1dMisses";
+    case PerfEvent::LlcMisses:
+        return "llcMisses";
+    case PerfEvent::BranchMisses:
+        return "branchMisses";
+    case PerfEvent::DtlbMisses:
+        return "dtlbMisses";
+    }
+
+    return "unknown";
+}
+
+#ifdef __linux__
+
+namespace {
+    constexpr std::uint64_t CacheEvent(std::uint64_t cache) {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8U) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16U);
+    }
+
+    // Indexed by PerfEvent. LLC misses use the generic cache-miss event, which the kernel maps to the last level and more CPUs support than the LL cache event.
+    constexpr std::array<std::pair<std::uint32_t, std::uint64_t>, PERF_EVENT_COUNT> EVENT_CONFIGS = {{
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, CacheEvent(PERF_COUNT_HW_CACHE_L1D)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_HW_CACHE, CacheEvent(PERF_COUNT_HW_CACHE_DTLB)},
+    }};
+
+    struct ScaledReading {
+        std::uint64_t value;
+        std::uint64_t timeEnabled;
+        std::uint64_t timeRunning;
+    };
+}
+
+PerfCounters::PerfCounters() : _descriptors{}, _availableCount{0U}, _unavailableReason{} {
+    for (std::size_t i = 0U; i < PERF_EVENT_COUNT; ++i) {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = EVENT_CONFIGS[i].first;
+        attributes.config = EVENT_CONFIGS[i].second;
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        _descriptors[i] = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+
+        if (_descriptors[i] >= 0) {
+            ++_availableCount;
+        } else if (_unavailableReason.empty()) {
+            _unavailableReason = std::string{GetPerfEventName(static_cast<PerfEvent>(i))} + ": " + std::strerror(errno);
+        }
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int descriptor : _descriptors) {
+        if (descriptor >= 0) {
+            close(descriptor);
+        }
+    }
+}
+
+void PerfCounters::Reset() {
+    for (int descriptor : _descriptors) {
+        if (descriptor >= 0) {
+            ioctl(descriptor, PERF_EVENT_IOC_RESET, 0);
+        }
+    }
+}
+
+void PerfCounters::Start() {
+    for (int descriptor : _descriptors) {
+        if (descriptor >= 0) {
+            ioctl(descriptor, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+void PerfCounters::Stop() {
+    for (int descriptor : _descriptors) {
+        if (descriptor >= 0) {
+            ioctl(descriptor, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+}
+
+PerfCounts PerfCounters::Read() const {
+    PerfCounts counts;
+
+    for (std::size_t i = 0U; i < PERF_EVENT_COUNT; ++i) {
+        ScaledReading reading;
+
+        // An event that never got onto the hardware has nothing to scale up from.
+        if ((_descriptors[i] < 0) || (read(_descriptors[i], &reading, sizeof(reading)) != static_cast<ssize_t>(sizeof(reading))) || (reading.timeRunning == 0U)) {
+            continue;
+        }
+
+        double scale = static_cast<double>(reading.timeEnabled) / static_cast<double>(reading.timeRunning);
+        counts[i] = static_cast<std::uint64_t>(static_cast<double>(reading.value) * scale);
+    }
+
+    return counts;
+}
+
+#else
+
+PerfCounters::PerfCounters() : _descriptors{}, _availableCount{0U}, _unavailableReason{"hardware counters are only read on Linux"} {}
+
+PerfCounters::~PerfCounters() = default;
+
+void PerfCounters::Reset() {}
+
+void PerfCounters::Start() {}
+
+void PerfCounters::Stop() {}
+
+PerfCounts PerfCounters::Read() const {
+    return PerfCounts{};
+}
+
+#endif
+
+}
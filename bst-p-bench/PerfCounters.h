@@ -0,0 +1,56 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace BST_P {
+    enum class PerfEvent {
+        Cycles,
+        Instructions,
+        L1dMisses,
+        LlcMisses,
+        BranchMisses,
+        DtlbMisses,
+    };
+
+    constexpr std::size_t PERF_EVENT_COUNT = 6U;
+
+    // The identifier each event goes by in output.
+    [[nodiscard]] char const * GetPerfEventName(PerfEvent event);
+
+    // One value per event, indexed by PerfEvent. Events that couldn't be counted are empty.
+    typedef std::array<std::optional<std::uint64_t>, PERF_EVENT_COUNT> PerfCounts;
+
+    /*
+     * Hardware performance counters for the calling thread, in user space only, through Linux's perf_event_open.
+     * Each event is opened on its own, so a CPU or VM that lacks one still counts the rest. When there are more events than hardware counters,
+     * the kernel takes turns between them and the counts are scaled up by how long each one actually ran.
+     * Where perf_event_open isn't there or isn't allowed (perf_event_paranoid, containers, other systems), every count is simply empty.
+     */
+    class PerfCounters final {
+    public:
+        PerfCounters();
+        PerfCounters(PerfCounters const &) = delete;
+        PerfCounters(PerfCounters &&) noexcept = delete;
+        PerfCounters & operator=(PerfCounters const &) = delete;
+        PerfCounters & operator=(PerfCounters &&) noexcept = delete;
+        ~PerfCounters();
+
+        [[nodiscard]] inline bool IsAnyAvailable() const { return _availableCount > 0U; }
+        // Why some events couldn't be opened, or empty if they all were.
+        [[nodiscard]] inline std::string const & GetUnavailableReason() const { return _unavailableReason; }
+
+        // Counts accumulate over every Start/Stop pair until the next Reset.
+        void Reset();
+        void Start();
+        void Stop();
+        [[nodiscard]] PerfCounts Read() const;
+
+    private:
+        std::array<int, PERF_EVENT_COUNT> _descriptors;
+        std::size_t _availableCount;
+        std::string _unavailableReason;
+    };
+}
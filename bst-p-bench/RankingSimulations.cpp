@@ -0,0 +1,175 @@
+#include "RankingSimulations.h"
+#include "BenchmarkHarness.h"
+#include "ComparisonCache.h"
+#include "InterleavedRankingEngine.h"
+#include "MergeInsertionEngine.h"
+#include "Pokedex.h"
+#include "RankingEngine.h"
+#include "RankingOracles.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+    // Ranks every item with Engine, constructed with engineArgs after the item count and seed, then counts the neighbours in the ranking that scores says
+    // are the wrong way round. Returns that count.
+    template<class Engine, class... EngineArgs> std::size_t RunSimulation(char const * dataset, char const * engineName, char const * oracleName, std::vector<std::uint32_t> const & scores, BST_P::RankingOracle const & oracle, std::uint32_t seed, std::ostream & log, EngineArgs... engineArgs) {
+        std::ios_base::fmtflags flags = log.flags();
+        Engine engine{scores.size(), seed, engineArgs...};
+        BST_P::Stopwatch stopwatch;
+
+        while (!engine.IsDone()) {
+            engine.PlaceNext(oracle);
+        }
+
+        double seconds = stopwatch.GetElapsedSeconds();
+        BST_P::RankingOracle groundTruth = BST_P::MakeGroundTruthOracle(scores);
+        std::size_t misorderedCount = 0U;
+        auto previous = engine.GetRanking().cbegin();
+
+        for (auto itr = previous; itr != engine.GetRanking().cend(); previous = itr++) {
+            if ((itr != previous) && (groundTruth(*itr, *previous) == BST_P::RankingAnswer::Lower)) {
+                ++misorderedCount;
+            }
+        }
+
+        log << std::left << std::setw(10) << dataset << std::setw(17) << engineName << std::setw(14) << oracleName << std::right
+            << std::setw(9) << scores.size() << " items"
+            << std::setw(12) << engine.GetQuestionCount() << " questions"
+            << std::fixed << std::setprecision(2) << std::setw(8) << (static_cast<double>(engine.GetQuestionCount()) / static_cast<double>(scores.size())) << " per item"
+            << std::setprecision(3) << std::setw(10) << seconds << " s"
+            << std::setw(9) << misorderedCount << " misordered\n";
+        log.flags(flags);
+
+        return misorderedCount;
+    }
+
+    // Ranks every item with Engine through a ComparisonCache with an oracle that sometimes skips, then takes every third item back out and ranks it again.
+    // Returns whether the oracle was never asked the same question twice and the ranking came out in order.
+    template<class Engine, class... EngineArgs> bool SimulateReranking(char const * dataset, char const * engineName, std::vector<std::uint32_t> const & scores, std::uint32_t seed, std::ostream & log, EngineArgs... engineArgs) {
+        BST_P::RankingOracle groundTruth = BST_P::MakeGroundTruthOracle(scores);
+        std::set<std::pair<BST_P::RankingItem, BST_P::RankingItem>> askedPairs;
+        std::uint64_t repeatCount = 0U;
+        std::mt19937 random{seed};
+        BST_P::ComparisonCache cache{scores.size()};
+        BST_P::RankingOracle oracle = BST_P::MakeCachedOracle(cache, [&](BST_P::RankingItem item, BST_P::RankingItem rankedItem) {
+            if (std::bernoulli_distribution{SKIP_RATE}(random)) {
+                return BST_P::RankingAnswer::Skip;
+            }
+
+            if (!askedPairs.emplace(std::min(item, rankedItem), std::max(item, rankedItem)).second) {
+                ++repeatCount;
+            }
+
+            return groundTruth(item, rankedItem);
+        });
+        Engine engine{scores.size(), seed, engineArgs...};
+
+        while (!engine.IsDone()) {
+            engine.PlaceNext(oracle);
+        }
+
+        std::size_t firstAskedCount = askedPairs.size();
+
+        for (BST_P::RankingItem item = 0U; item < scores.size(); item += 3U) {
+            engine.Unrank(item);
+        }
+
+        while (!engine.IsDone()) {
+            engine.PlaceNext(oracle);
+        }
+
+        bool isInOrder = std::is_sorted(engine.GetRanking().cbegin(), engine.GetRanking().cend(), [&groundTruth](BST_P::RankingItem a, BST_P::RankingItem b) {
+            return groundTruth(b, a) == BST_P::RankingAnswer::Higher;
+        });
+
+        log << std::left << std::setw(10) << dataset << std::setw(17) << engineName << std::setw(14) << "re-ranked" << std::right
+            << std::setw(9) << scores.size() << " items"
+            << std::setw(12) << firstAskedCount << " questions, then"
+            << std::setw(6) << (askedPairs.size() - firstAskedCount) << " more and"
+            << std::setw(6) << repeatCount << " repeated\n";
+
+        if (repeatCount > 0U) {
+            log << "FAILED: the " << dataset << " ranking asked the same question twice.\n";
+        }
+
+        if (!isInOrder) {
+            log << "FAILED: the re-ranked " << dataset << " ranking came out of order with every answer right.\n";
+        }
+
+        return (repeatCount == 0U) && isInOrder;
+    }
+
+    // Runs the ground truth and noisy oracles over scores. Returns whether the ground truth's ranking came out in order.
+    bool SimulateDataset(char const * dataset, std::vector<std::uint32_t> const & scores, std::uint32_t seed, std::ostream & log) {
+        bool isInOrder = RunSimulation<BST_P::RankingEngine>(dataset, "tree", "ground-truth", scores, BST_P::MakeGroundTruthOracle(scores), seed, log) == 0U;
+        RunSimulation<BST_P::RankingEngine>(dataset, "tree", "noisy", scores, BST_P::MakeNoisyOracle(scores, NOISY_ERROR_RATE, seed), seed, log);
+
+        if (scores.size() <= MAX_BATCHED_SIZE) {
+            isInOrder = (RunSimulation<BST_P::RankingEngine>(dataset, "batched tree", "ground-truth", scores, BST_P::MakeGroundTruthOracle(scores), seed, log, SIMULATED_BATCH_SIZE) == 0U) && isInOrder;
+            RunSimulation<BST_P::RankingEngine>(dataset, "batched tree", "noisy", scores, BST_P::MakeNoisyOracle(scores, NOISY_ERROR_RATE, seed), seed, log, SIMULATED_BATCH_SIZE);
+        }
+
+        isInOrder = (RunSimulation<BST_P::InterleavedRankingEngine>(dataset, "interleaved", "ground-truth", scores, BST_P::MakeGroundTruthOracle(scores), seed, log, SIMULATED_IN_FLIGHT_COUNT) == 0U) && isInOrder;
+        RunSimulation<BST_P::InterleavedRankingEngine>(dataset, "interleaved", "noisy", scores, BST_P::MakeNoisyOracle(scores, NOISY_ERROR_RATE, seed), seed, log, SIMULATED_IN_FLIGHT_COUNT);
+
+        if (scores.size() <= MAX_MERGE_INSERTION_SIZE) {
+            isInOrder = (RunSimulation<BST_P::MergeInsertionEngine>(dataset, "merge-insertion", "ground-truth", scores, BST_P::MakeGroundTruthOracle(scores), seed, log) == 0U) && isInOrder;
+            RunSimulation<BST_P::MergeInsertionEngine>(dataset, "merge-insertion", "noisy", scores, BST_P::MakeNoisyOracle(scores, NOISY_ERROR_RATE, seed), seed, log);
+        }
+
+        if (!isInOrder) {
+            log << "FAILED: the " << dataset << " ranking came out of order with every answer right.\n";
+        }
+
+        return isInOrder;
+    }
+}
+
+bool SimulateRanking(char const * pokedexPath, char const * answersPath, std::vector<std::size_t> const & syntheticSizes, std::uint32_t seed, std::ostream & log) {
+    bool isEveryRankingInOrder = true;
+    BST_P::Pokedex pokedex{pokedexPath};
+
+    if (pokedex.GetNumberOfPokemon() == 0U) {
+        log << "Couldn't read any Pokemon from " << pokedexPath << ", so it won't be simulated.\n";
+    } else {
+        std::vector<std::uint32_t> scores(pokedex.GetNumberOfPokemon());
+
+        for (std::size_t i = 0U; i < scores.size(); ++i) {
+            scores[i] = pokedex.FindPokemon(static_cast<BST_P::PokemonId>(i + 1U)).GetBaseStatTotal();
+        }
+
+        isEveryRankingInOrder = SimulateDataset("pokedex", scores, seed, log) && isEveryRankingInOrder;
+        isEveryRankingInOrder = SimulateReranking<BST_P::RankingEngine>("pokedex", "tree", scores, seed, log) && isEveryRankingInOrder;
+        isEveryRankingInOrder = SimulateReranking<BST_P::RankingEngine>("pokedex", "batched tree", scores, seed, log, SIMULATED_BATCH_SIZE) && isEveryRankingInOrder;
+        isEveryRankingInOrder = SimulateReranking<BST_P::InterleavedRankingEngine>("pokedex", "interleaved", scores, seed, log, SIMULATED_IN_FLIGHT_COUNT) && isEveryRankingInOrder;
+        isEveryRankingInOrder = SimulateReranking<BST_P::MergeInsertionEngine>("pokedex", "merge-insertion", scores, seed, log) && isEveryRankingInOrder;
+
+        if (answersPath != nullptr) {
+            std::ifstream answers{answersPath};
+
+            // Recorded answers only have to cover the questions this seed asks, so a replay can fall short without anything being wrong.
+            try {
+                if (!answers) {
+                    throw std::runtime_error{std::string{"Couldn't open "} + answersPath + "."};
+                }
+
+                RunSimulation<BST_P::RankingEngine>("pokedex", "tree", "replayed", scores, BST_P::MakeReplayOracle(answers), seed, log);
+            } catch (std::runtime_error const & e) {
+                log << "Couldn't replay the recorded answers: " << e.what() << "\n";
+            }
+        }
+    }
+
+    for (std::size_t size : syntheticSizes) {
+        std::vector<int> order = BST_P::GenerateKeys(BST_P::KeyPattern::Random, size, size, seed);
+        isEveryRankingInOrder = SimulateDataset("synthetic", std::vector<std::uint32_t>{order.cbegin(), order.cend()}, seed, log) && isEveryRankingInOrder;
+    }
+
+    return isEveryRankingInOrder;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/*
+ * Runs the ranking engines headless, with oracles standing in for the person answering, and reports the questions each asked, in total and per item, and how long it took.
+ * The datasets are:
+ *   - the Pokedex at pokedexPath, whose ground truth goes by base stat total. Its recorded answers at answersPath are replayed too, unless it's null.
+ *   - synthetic datasets of each size in syntheticSizes, whose ground truth is a random order.
+ * Each dataset is ranked by RankingEngine, by RankingEngine in batches of SIMULATED_BATCH_SIZE up to MAX_BATCHED_SIZE items, by InterleavedRankingEngine
+ * with SIMULATED_IN_FLIGHT_COUNT items in flight, and by MergeInsertionEngine up to MAX_MERGE_INSERTION_SIZE items,
+ * each with its ground truth and with a noisy oracle that's wrong NOISY_ERROR_RATE of the time.
+ * Rankings that come out of order are reported by how many neighbours the ground truth would swap.
+ * The Pokedex is also ranked through a ComparisonCache while skipping SKIP_RATE of the questions, and then a third of it is taken back out and ranked again,
+ * which mustn't ask anything twice.
+ * Returns false if a ground-truth ranking came out of order or a question was asked twice, since then an engine or the cache is broken.
+ */
+[[nodiscard]] bool SimulateRanking(char const * pokedexPath, char const * answersPath, std::vector<std::size_t> const & syntheticSizes, std::uint32_t seed, std::ostream & log);
+
+constexpr double NOISY_ERROR_RATE = 0.05;
+constexpr double SKIP_RATE = 0.1;
+// Merge-insertion keeps its chain in a vector, so inserting into it is linear, and it's only simulated up to this many items.
+constexpr std::size_t MAX_MERGE_INSERTION_SIZE = 100000U;
+constexpr std::size_t SIMULATED_BATCH_SIZE = 8U;
+// Each batch steps through the ranking from the start, so batches take time quadratic in the items, and they're only simulated up to this many.
+constexpr std::size_t MAX_BATCHED_SIZE = 10000U;
+constexpr std::size_t SIMULATED_IN_FLIGHT_COUNT = 8U;
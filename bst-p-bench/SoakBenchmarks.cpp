@@ -0,0 +1,107 @@
+#include "SoakBenchmarks.h"
+#include "AVLTree.h"
+#include "BenchmarkHarness.h"
+#include <algorithm>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+namespace {
+    typedef BST_P::AvlTree<int, BST_P::CheckedAccess, BST_P::CountingStats> CountingTree;
+
+    constexpr std::uint32_t FILL_SEED = 4U;
+    constexpr std::uint32_t CHURN_SEED = 5U;
+    constexpr std::uint64_t SAMPLE_COUNT = 20U;
+    // Keys come from a range this many times the tree's size, so most inserts are of keys the tree hasn't seen in a while.
+    constexpr std::size_t KEY_RANGE_FACTOR = 4U;
+
+    bool SoakTree(char const * mode, bool isRelaxed, std::size_t steadySize, std::uint64_t cycleCount, std::ostream & log) {
+        std::ios_base::fmtflags flags = log.flags();
+        CountingTree tree;
+        tree.SetRelaxedBalancing(isRelaxed);
+
+        // The first steadySize keys of a shuffled range are all different.
+        std::vector<int> keys = BST_P::GenerateKeys(BST_P::KeyPattern::Random, steadySize, KEY_RANGE_FACTOR * steadySize, FILL_SEED);
+
+        for (int key : keys) {
+            tree.Insert(key);
+        }
+
+        std::mt19937 random{CHURN_SEED};
+        std::uniform_int_distribution<std::size_t> positions{0U, steadySize - 1U};
+        std::uniform_int_distribution<int> newKeys{0, static_cast<int>(KEY_RANGE_FACTOR * steadySize) - 1};
+        std::uint64_t const sampleInterval = std::max<std::uint64_t>(cycleCount / SAMPLE_COUNT, 1U);
+        std::uint64_t const maxLiveNodes = 2U * static_cast<std::uint64_t>(steadySize);
+        std::size_t baselineRssBytes = 0U;
+        std::size_t maxLateRssBytes = 0U;
+        std::uint64_t lateSampleCount = 0U;
+        bool hasPurged = false;
+        std::uint64_t maxSampledLiveNodes = 0U;
+        BST_P::Stopwatch stopwatch;
+
+        for (std::uint64_t cycle = 1U; cycle <= cycleCount; ++cycle) {
+            std::size_t tombstoneCount = tree.GetTombstoneCount();
+            std::size_t position = positions(random);
+            tree.Remove(keys[position]);
+
+            int key = newKeys(random);
+            while (!tree.Insert(key).first) {
+                key = newKeys(random);
+            }
+
+            keys[position] = key;
+            // A cycle leaves at most one more tombstone and reuses at most one, so any bigger drop is a purge.
+            hasPurged = hasPurged || (tree.GetTombstoneCount() + 1U < tombstoneCount);
+
+            if ((cycle % sampleInterval == 0U) || (cycle == cycleCount)) {
+                BST_P::AvlTreeStats stats = tree.GetStats();
+                std::uint64_t liveNodes = stats.nodesAllocated - stats.nodesFreed;
+                std::size_t rssBytes = BST_P::FindCurrentRssBytes();
+
+                // A relaxed tree only reaches its steady state once its tombstones have built up to the cap and been purged for the first time.
+                if ((cycle <= cycleCount / 2U) || (isRelaxed && !hasPurged)) {
+                    baselineRssBytes = std::max(baselineRssBytes, rssBytes);
+                } else {
+                    maxLateRssBytes = std::max(maxLateRssBytes, rssBytes);
+                    ++lateSampleCount;
+                }
+                maxSampledLiveNodes = std::max(maxSampledLiveNodes, liveNodes);
+
+                log << std::left << std::setw(10) << "AvlTree" << std::setw(9) << mode << std::right
+                    << std::setw(12) << cycle << " cycles"
+                    << std::setw(10) << liveNodes << " live nodes"
+                    << std::setw(10) << tree.GetTombstoneCount() << " tombstones"
+                    << std::fixed << std::setprecision(1) << std::setw(10) << (static_cast<double>(rssBytes) / (1024.0 * 1024.0)) << " MiB RSS\n";
+                log.flags(flags);
+            }
+        }
+
+        double seconds = stopwatch.GetElapsedSeconds();
+        std::size_t const rssLimit = static_cast<std::size_t>(static_cast<double>(baselineRssBytes) * (1.0 + SOAK_RSS_GROWTH_ALLOWANCE)) + SOAK_RSS_SLACK_BYTES;
+        bool isNodeCountFlat = (maxSampledLiveNodes <= maxLiveNodes) && (tree.GetSize() == steadySize);
+        // Where RSS can't be read, every sample is 0 and only the node count is checked.
+        bool isRssFlat = maxLateRssBytes <= rssLimit;
+
+        log << "AvlTree " << mode << " soak: " << cycleCount << " cycles in " << std::fixed << std::setprecision(2) << seconds << " s. ";
+
+        if (!isNodeCountFlat) {
+            log << "FAILED: " << maxSampledLiveNodes << " nodes were alive at once, more than " << maxLiveNodes << ".\n";
+        } else if (!isRssFlat) {
+            log << "FAILED: RSS grew to " << maxLateRssBytes << " bytes after warming up, past " << rssLimit << ".\n";
+        } else if (lateSampleCount == 0U) {
+            log << "The node count stayed flat, but the tombstones were never purged, so there was no steady state to check RSS against. Run more cycles.\n";
+        } else {
+            log << "Memory stayed flat.\n";
+        }
+
+        log.flags(flags);
+        return isNodeCountFlat && isRssFlat;
+    }
+}
+
+bool SoakAvlTree(std::size_t steadySize, std::uint64_t cycleCount, std::ostream & log) {
+    // Both run, even if the first fails, so one report shows everything that grew.
+    bool isStrictFlat = SoakTree("strict", false, steadySize, cycleCount, log);
+    bool isRelaxedFlat = SoakTree("relaxed", true, steadySize, cycleCount, log);
+    return isStrictFlat && isRelaxedFlat;
+}
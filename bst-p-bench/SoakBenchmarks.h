@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+/*
+ * Churns an AvlTree of steadySize elements through cycleCount cycles, each removing a random element and inserting a new random one,
+ * once with the tree strict and once relaxed. Along the way it samples the process's RSS and how many nodes the tree has alive, tombstones included, and logs them.
+ * Returns false if either run's memory kept growing: more than twice steadySize nodes alive at any point (the most tombstones a relaxed tree keeps),
+ * or an RSS after warming up more than SOAK_RSS_GROWTH_ALLOWANCE above the most it reached while warming up, give or take SOAK_RSS_SLACK_BYTES.
+ * Warming up takes the first half of the run, and for the relaxed tree, lasts until its tombstones are first purged too, since it grows until then.
+ */
+[[nodiscard]] bool SoakAvlTree(std::size_t steadySize, std::uint64_t cycleCount, std::ostream & log);
+
+// Allocators hold on to some freed memory and fragment a little, so RSS can creep up a bit before it settles.
+constexpr double SOAK_RSS_GROWTH_ALLOWANCE = 0.1;
+constexpr std::size_t SOAK_RSS_SLACK_BYTES = std::size_t{1U} << 20U;
@@ -0,0 +1,107 @@
+#include <iostream>
+#include "AvlTreeBenchmarks.h"
+#include "BenchmarkHarness.h"
+#include "ConcurrentAvlTreeBenchmarks.h"
+#include "RankingSimulations.h"
+#include "SoakBenchmarks.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+constexpr std::size_t MIN_SIZE = 1000U;
+constexpr std::size_t DEFAULT_MAX_SIZE = 10000000U;
+constexpr std::size_t SOAK_SIZE = 100000U;
+constexpr std::size_t MIN_SIMULATION_SIZE = 10000U;
+constexpr std::size_t MAX_SIMULATION_SIZE = 1000000U;
+constexpr char const * DEFAULT_POKEDEX_PATH = "../bst-p/pokedata.txt";
+constexpr std::uint32_t DEFAULT_SEED = 1U;
+
+void PrintUsage() {
+    std::cout << "Usage: bst-p-bench [--max-size N] [--json PATH]\n"
+        << "       bst-p-bench --concurrent [--json PATH]\n"
+        << "       bst-p-bench --soak CYCLES\n"
+        << "       bst-p-bench --simulate [--max-size N] [--pokedex PATH] [--answers PATH] [--seed N]\n"
+        << "  --max-size N  Run sizes from " << MIN_SIZE << " up to N, by powers of 10. Defaults to " << DEFAULT_MAX_SIZE << ".\n"
+        << "  --json PATH   Also write every result to PATH as JSON.\n"
+        << "  --concurrent  Instead of the single-threaded cases, time ConcurrentAvlTree against a locked AvlTree on 1 up to " << MAX_CONCURRENT_THREADS << " threads.\n"
+        << "  --soak CYCLES Instead of timing anything, churn a tree of " << SOAK_SIZE << " elements through CYCLES removes and inserts, and fail if its memory keeps growing.\n"
+        << "  --simulate    Instead of timing anything, rank the Pokedex and synthetic datasets of " << MIN_SIMULATION_SIZE << " up to N items, at most " << MAX_SIMULATION_SIZE << ", with simulated answers.\n"
+        << "  --pokedex PATH Simulate the Pokedex at PATH. Defaults to " << DEFAULT_POKEDEX_PATH << ".\n"
+        << "  --answers PATH Also replay the answers the game recorded at PATH over the Pokedex.\n"
+        << "  --seed N      Seed the simulations with N. Defaults to " << DEFAULT_SEED << ".\n";
+}
+
+int main(int argc, char ** argv) {
+    std::size_t maxSize = DEFAULT_MAX_SIZE;
+    char const * jsonPath = nullptr;
+    std::uint64_t soakCycleCount = 0U;
+    bool isSimulating = false;
+    bool isConcurrent = false;
+    char const * pokedexPath = DEFAULT_POKEDEX_PATH;
+    char const * answersPath = nullptr;
+    std::uint32_t seed = DEFAULT_SEED;
+
+    for (int i = 1; i < argc; ++i) {
+        if ((std::strcmp(argv[i], "--max-size") == 0) && (i + 1 < argc)) {
+            maxSize = static_cast<std::size_t>(std::strtoull(argv[++i], nullptr, 10));
+        } else if ((std::strcmp(argv[i], "--json") == 0) && (i + 1 < argc)) {
+            jsonPath = argv[++i];
+        } else if ((std::strcmp(argv[i], "--soak") == 0) && (i + 1 < argc)) {
+            soakCycleCount = static_cast<std::uint64_t>(std::strtoull(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--concurrent") == 0) {
+            isConcurrent = true;
+        } else if (std::strcmp(argv[i], "--simulate") == 0) {
+            isSimulating = true;
+        } else if ((std::strcmp(argv[i], "--pokedex") == 0) && (i + 1 < argc)) {
+            pokedexPath = argv[++i];
+        } else if ((std::strcmp(argv[i], "--answers") == 0) && (i + 1 < argc)) {
+            answersPath = argv[++i];
+        } else if ((std::strcmp(argv[i], "--seed") == 0) && (i + 1 < argc)) {
+            seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            PrintUsage();
+            return (std::strcmp(argv[i], "--help") == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (soakCycleCount > 0U) {
+        return SoakAvlTree(SOAK_SIZE, soakCycleCount, std::cout) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (isSimulating) {
+        std::vector<std::size_t> simulationSizes;
+        for (std::size_t size = MIN_SIMULATION_SIZE; (size <= maxSize) && (size <= MAX_SIMULATION_SIZE); size *= 10U) {
+            simulationSizes.push_back(size);
+        }
+
+        return SimulateRanking(pokedexPath, answersPath, simulationSizes, seed, std::cout) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    std::vector<std::size_t> sizes;
+    for (std::size_t size = MIN_SIZE; size <= maxSize; size *= 10U) {
+        sizes.push_back(size);
+    }
+
+    std::vector<BST_P::BenchmarkResult> results;
+
+    if (isConcurrent) {
+        BenchmarkConcurrentAvlTree(results, std::cout);
+    } else {
+        BenchmarkAvlTree(sizes, results, std::cout);
+    }
+
+    if (jsonPath != nullptr) {
+        std::ofstream json{jsonPath, std::ios::trunc};
+        BST_P::WriteResultsAsJson(json, results);
+
+        if (!json) {
+            std::cerr << "Couldn't write results to " << jsonPath << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
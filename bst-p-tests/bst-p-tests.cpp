@@ -0,0 +1,7 @@
+#include "AvlTreeTests.h"
+#include <cstdlib>
+
+// Exits with failure if any test failed, so builds and scripts can tell.
+int main() {
+    return (RunAvlTreeTests() == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
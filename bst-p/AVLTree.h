@@ -1,17 +1,83 @@
 #pragma once
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <functional>
 #include <memory>
-#include <unordered_map>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "AsyncComparison.h"
+#include "AvlTreeSerialization.h"
+#include "WorkStealingPool.h"
 
 namespace BST_P {
     template<class T>
     struct subtract {
-        int operator()(T const & a, T const & b) const { return a - b; }
+        constexpr int operator()(T const & a, T const & b) const { return a - b; }
     };
 
-    template<class T>
+    /*
+     * Checking policies, which decide what dereferencing an AvlTree's iterators and node traversers costs.
+     * CheckedAccess, the default, throws std::logic_error for an invalidated iterator and std::out_of_range for end().
+     * UncheckedAccess leaves both undefined, so a dereference is a single load and nothing can throw. It's meant for hot loops and -fno-exceptions builds.
+     */
+    struct CheckedAccess {
+        static constexpr bool IS_CHECKED = true;
+    };
+
+    struct UncheckedAccess {
+        static constexpr bool IS_CHECKED = false;
+    };
+
+    // What a counting AvlTree reports through GetStats.
+    struct AvlTreeStats {
+        // Counted since the tree was made or its stats were last reset. Nodes are counted once each, though each one also allocates its element separately.
+        std::uint64_t comparisons = 0U;
+        std::uint64_t singleRotations = 0U;
+        std::uint64_t doubleRotations = 0U;
+        std::uint64_t nodesAllocated = 0U;
+        std::uint64_t nodesFreed = 0U;
+        std::uint64_t retraces = 0U;
+        std::uint64_t retraceSteps = 0U;
+        std::uint64_t longestRetrace = 0U;
+
+        // Measured when the stats are read. The ideal height is that of a perfectly balanced tree of the same size, ceil(log2(n + 1)).
+        // The footprint covers the tree, its nodes and their elements, but not allocator overhead or anything the elements allocate themselves.
+        std::uint64_t height = 0U;
+        std::uint64_t idealHeight = 0U;
+        std::size_t memoryFootprint = 0U;
+    };
+
+    /*
+     * Stats policies, which decide whether an AvlTree keeps count of the work it does.
+     * NoStats, the default, has nothing to count into and only empty hooks, so it compiles out entirely.
+     * CountingStats counts comparator calls, rotations, node allocations and frees, and how far each Emplace and Remove retraces, for GetStats to report.
+     * Counting happens even in const member functions, so a counting tree can't be read from several threads at once.
+     */
+    struct NoStats {
+        static constexpr bool IS_COUNTING = false;
+
+        inline void CountComparisons(std::uint64_t) {}
+        inline void CountRotation(bool) {}
+        inline void CountAllocations(std::uint64_t) {}
+        inline void CountFrees(std::uint64_t) {}
+        inline void CountRetrace(std::uint64_t) {}
+    };
+
+    struct CountingStats {
+        static constexpr bool IS_COUNTING = true;
+
+        inline void CountComparisons(std::uint64_t count) { stats.comparisons += count; }
+        inline void CountRotation(bool isDouble) { ++(isDouble ? stats.doubleRotations : stats.singleRotations); }
+        inline void CountAllocations(std::uint64_t count) { stats.nodesAllocated += count; }
+        inline void CountFrees(std::uint64_t count) { stats.nodesFreed += count; }
+        inline void CountRetrace(std::uint64_t length) { ++stats.retraces; stats.retraceSteps += length; stats.longestRetrace = std::max(stats.longestRetrace, length); }
+
+        AvlTreeStats stats;
+    };
+
+    template<class T, class CheckingPolicy = CheckedAccess, class StatsPolicy = NoStats>
     class AvlTree final {
     public:
         class MutableIterator;
@@ -22,7 +88,6 @@ namespace BST_P {
         friend class __IteratorImpl;
 
         typedef std::uint64_t Height;
-        typedef std::unordered_map<std::uint64_t, Height> SubtreeHeightMap;
         typedef std::int8_t BalanceFactor;
         static const BalanceFactor LEFT_IMBALANCE = -2;
         static const BalanceFactor LEFT_MAX = -1;
@@ -30,70 +95,55 @@ namespace BST_P {
         static const BalanceFactor RIGHT_IMBALANCE = 2;
 
     private:
+        /*
+         * Each node owns its children through unique_ptr and refers to its parent with a plain pointer, so there are no ownership cycles.
+         * Missing children are null. The tree's header node owns the root as its left child; it holds no data and doubles as the end() position.
+         */
         class Node final {
         public:
             friend AvlTree;
-            friend class BST_P::AvlTree<T>::__IteratorImpl;
+            friend class BST_P::AvlTree<T, CheckingPolicy, StatsPolicy>::__IteratorImpl;
 
-            Node() = delete;
             Node(Node const &) = delete;
             Node(Node &&) noexcept = delete;
             Node & operator=(Node const &) = delete;
             Node & operator=(Node &&) noexcept = delete;
-            inline ~Node() { ReleaseChildren(false); }
+            inline ~Node() = default;
 
-            template<class... Args> inline explicit Node(AvlTree const & tree, std::weak_ptr<Node> parent, Args&&... args)
-                : _tree{&tree}
-                , _data{std::make_unique<T>(std::forward<Args>(args)...)}
-                , _parent{std::move(parent.lock())}
-                , _isRequestingFullTreeRebalance{false}
-                , _balanceFactor{0} {}
-            template<class... Args> inline explicit Node(AvlTree const & tree, std::shared_ptr<Node> const * parent, Args&&... args)
-                : Node{tree, (parent == nullptr) ? std::weak_ptr<Node>{} : *parent, std::forward<Args>(args)...} {}
-            inline explicit Node(AvlTree const & tree, std::weak_ptr<Node> parent)
-                : _tree{&tree}
-                , _data{nullptr}
-                , _parent{std::move(parent.lock())}
+            template<class... Args> inline explicit Node(Node * parent, Args&&... args)
+                : _data{std::make_unique<T>(std::forward<Args>(args)...)}
+                , _parent{parent}
                 , _isRequestingFullTreeRebalance{false}
+                , _isTombstone{false}
                 , _balanceFactor{0} {}
-            inline explicit Node(AvlTree const & tree, std::shared_ptr<Node> const * parent) : Node{tree, (parent == nullptr) ? std::weak_ptr<Node>{} : *parent} {}
-            inline explicit Node(AvlTree const & tree) : Node{tree, std::weak_ptr<Node>{}} {}
+            inline Node() : _data{nullptr}, _parent{nullptr}, _isRequestingFullTreeRebalance{false}, _isTombstone{false}, _balanceFactor{0} {}
 
-            [[nodiscard]] inline bool IsNodeOfTree(AvlTree const * const tree) const { return _tree == tree; }
             [[nodiscard]] inline T const * const GetData() const { return _data.get(); }
             inline T * const GetData() { return _data.get(); }
             [[nodiscard]] inline bool IsEmpty() const { return _data.get() == nullptr; }
             [[nodiscard]] inline BalanceFactor GetBalanceFactor() const { return _balanceFactor; }
             [[nodiscard]] inline bool IsImbalanced() const { return (_balanceFactor >= RIGHT_IMBALANCE) || (_balanceFactor <= LEFT_IMBALANCE); }
-            [[nodiscard]] inline bool IsRightParent() const { return !!_rightChild && !(_rightChild->IsEmpty()); }
-            [[nodiscard]] inline bool IsLeftParent() const { return !!_leftChild && !(_leftChild->IsEmpty()); }
-            [[nodiscard]] inline bool IsRightChild() const { return !!_parent && (_parent->_rightChild.get() == this); }
-            [[nodiscard]] inline bool IsLeftChild() const { return !!_parent && (_parent->_leftChild.get() == this); }
-            [[nodiscard]] inline std::weak_ptr<Node> GetParent() const { return _parent; }
-            [[nodiscard]] inline std::weak_ptr<Node> GetRightChild() const { return _rightChild; }
-            [[nodiscard]] inline std::weak_ptr<Node> GetLeftChild() const { return _leftChild; }
+            [[nodiscard]] inline bool IsRightParent() const { return !!_rightChild; }
+            [[nodiscard]] inline bool IsLeftParent() const { return !!_leftChild; }
+            [[nodiscard]] inline bool IsRightChild() const { return (_parent != nullptr) && (_parent->_rightChild.get() == this); }
+            [[nodiscard]] inline bool IsLeftChild() const { return (_parent != nullptr) && (_parent->_leftChild.get() == this); }
+            [[nodiscard]] inline Node const * GetParent() const { return _parent; }
+            [[nodiscard]] inline Node const * GetRightChild() const { return _rightChild.get(); }
+            [[nodiscard]] inline Node const * GetLeftChild() const { return _leftChild.get(); }
             [[nodiscard]] inline bool IsRequestingFullTreeRebalance() const { return _isRequestingFullTreeRebalance; }
+            [[nodiscard]] inline bool IsTombstone() const { return _isTombstone; }
 
             [[nodiscard]] Height FindHeight() const;
 
         private:
-            [[nodiscard]] Height FindHeight(SubtreeHeightMap & subtreeHeightMap) const;
-            void RemoveFromSubtreeHeightMap(SubtreeHeightMap & subtreeHeightMap, bool isAlsoRemovingAncestors = false) const;
-
-            std::uint64_t ReleaseChildren(bool isCreatingEmptyNode);
-            std::uint64_t ReleaseRightChildren(bool isCreatingEmptyNode);
-            std::uint64_t ReleaseLeftChildren(bool isCreatingEmptyNode);
-
-            void BeginUpdatingTreePointer(AvlTree const & tree);
-            void ContinueUpdatingTreePointer(AvlTree const & tree);
-            void ClearSelfAndChildrenIsRequestingFullTreeRebelance();
-
-            AvlTree const * _tree;
             std::unique_ptr<T> _data;
-            std::shared_ptr<Node> _parent;
-            std::shared_ptr<Node> _rightChild;
-            std::shared_ptr<Node> _leftChild;
+            Node * _parent;
+            std::unique_ptr<Node> _rightChild;
+            std::unique_ptr<Node> _leftChild;
+            // Only set while the tree is relaxed. Means the balance factors in this subtree are stale; every ancestor of a marked node is marked too.
             bool _isRequestingFullTreeRebalance;
+            // A removed element left in place while the tree is relaxed. It still guides searches, but isn't found or iterated over.
+            bool _isTombstone;
             BalanceFactor _balanceFactor;
         };
 
@@ -117,24 +167,31 @@ namespace BST_P {
 
             inline bool TraverseRight() { return Traverse(false); }
             inline bool TraverseLeft() { return Traverse(true); }
-            [[nodiscard]] inline bool IsEqualTo(__IteratorImpl const & other) const {
-                bool isExpired = _node.expired();
-                bool isTreePtrEqual = (_tree == other._tree);
-                bool isExpiredEqual = (isExpired == other._node.expired());
-                bool isSharedPtrEqual = (isExpired || (_node.lock() == other._node.lock()));
-                return isTreePtrEqual && isExpiredEqual && isSharedPtrEqual;
-            }
+            [[nodiscard]] inline bool IsEqualTo(__IteratorImpl const & other) const { return _node == other._node; }
 
         private:
-            inline explicit __IteratorImpl(AvlTree const & tree, std::weak_ptr<Node> node) : _tree{&tree}, _node{node} {}
+            inline explicit __IteratorImpl(Node * node) : _node{node} {}
 
+            // Moves to the next element, skipping tombstones.
             bool Traverse(bool isTraversingLeft);
+            // Moves to the next node, tombstone or not.
+            bool Step(bool isTraversingLeft);
 
-            AvlTree const * _tree;
-            std::weak_ptr<Node> _node;
+            Node * _node;
         };
 
     public:
+        /*
+         * Iterators and node traversers hold plain pointers to the tree's nodes, so stepping and dereferencing them never touches a reference count.
+         * In exchange, their validity follows these rules:
+         *   - Emplace/EmplaceAsync/Insert never invalidates any iterator, including end().
+         *   - Remove invalidates only iterators to the removed element.
+         *   - Clear invalidates every iterator except end().
+         *   - Rebalance never invalidates any iterator.
+         *   - Destroying a tree invalidates all of its iterators. Moving a tree doesn't invalidate iterators to elements, which follow the nodes into the tree
+         *     that was moved to, but end() stays with the tree it came from, since each tree keeps its own header.
+         * Using an invalidated iterator for anything other than assignment or destruction is undefined behavior.
+         */
         class MutableIterator final {
             friend AvlTree;
             friend ConstIterator;
@@ -148,7 +205,7 @@ namespace BST_P {
             typedef value_type const * const_pointer;
             typedef value_type const & const_reference;
 
-            inline explicit MutableIterator(AvlTree const & tree, std::weak_ptr<Node> node) : _impl{tree, node} {}
+            inline explicit MutableIterator(Node * node) : _impl{node} {}
             inline MutableIterator(MutableIterator const &) = default;
             inline MutableIterator(MutableIterator &&) noexcept  = default;
             inline MutableIterator & operator=(MutableIterator const &) = default;
@@ -162,7 +219,7 @@ namespace BST_P {
             [[nodiscard]] inline bool operator!=(MutableIterator const & other) const { return !operator==(other); }
             [[nodiscard]] inline bool operator==(ConstIterator const & other) const { return _impl.IsEqualTo(other._impl); }
             [[nodiscard]] inline bool operator!=(ConstIterator const & other) const { return !operator==(other); }
-            inline pointer const operator->() const { return _impl._node.expired() ? nullptr : _impl._node.lock()->GetData(); }
+            inline pointer const operator->() const { return (_impl._node == nullptr) ? nullptr : _impl._node->GetData(); }
             inline MutableIterator& operator++() { _impl.TraverseRight(); return *this; }
             [[nodiscard]] inline MutableIterator operator++(int) { MutableIterator copy{*this}; operator++(); return copy; }
             inline MutableIterator& operator--() { _impl.TraverseLeft(); return *this; }
@@ -187,7 +244,7 @@ namespace BST_P {
             typedef value_type * const_pointer;
             typedef value_type & const_reference;
 
-            inline explicit ConstIterator(AvlTree const & tree, std::weak_ptr<Node> node) : _impl{tree, node} {}
+            inline explicit ConstIterator(Node * node) : _impl{node} {}
             inline ConstIterator(ConstIterator const &) = default;
             inline ConstIterator(ConstIterator &&) noexcept = default;
             inline ConstIterator & operator=(ConstIterator const &) = default;
@@ -201,7 +258,7 @@ namespace BST_P {
             [[nodiscard]] inline bool operator!=(ConstIterator const & other) const { return !operator==(other); }
             [[nodiscard]] inline bool operator==(MutableIterator const & other) const { return _impl.IsEqualTo(other._impl); }
             [[nodiscard]] inline bool operator!=(MutableIterator const & other) const { return !operator==(other); }
-            inline pointer const operator->() const { return _impl._node.expired() ? nullptr : _impl._node.lock()->GetData(); }
+            inline pointer const operator->() const { return (_impl._node == nullptr) ? nullptr : _impl._node->GetData(); }
             inline ConstIterator& operator++() { _impl.TraverseRight(); return *this; }
             [[nodiscard]] inline ConstIterator operator++(int) { ConstIterator copy{*this}; operator++(); return copy; }
             inline ConstIterator& operator--() { _impl.TraverseLeft(); return *this; }
@@ -223,24 +280,22 @@ namespace BST_P {
             NodeTraverser & operator=(NodeTraverser &&) noexcept = default;
             inline ~NodeTraverser() = default;
 
-            [[nodiscard]] inline bool operator==(NodeTraverser const & other) const {
-                bool isExpired = _node.expired();
-                bool isTreePtrEqual = (_tree == other._tree);
-                bool isExpiredEqual = (isExpired == other._node.expired());
-                bool isSharedPtrEqual = (isExpired || (_node.lock() == other._node.lock()));
-                return isTreePtrEqual && isExpiredEqual && isSharedPtrEqual;
-            }
+            [[nodiscard]] inline bool operator==(NodeTraverser const & other) const { return _node == other._node; }
             [[nodiscard]] inline bool operator!=(NodeTraverser const & other) const { return !operator==(other); }
-            inline T const * operator->() const { return _node.expired() ? nullptr : _node.lock()->GetData(); }
+            inline T const * operator->() const { return (_node == nullptr) ? nullptr : _node->GetData(); }
 
             [[nodiscard]] T const & operator*() const;
 
-            [[nodiscard]] inline bool IsNotEmpty() const { return !(_node.expired()) && !(_node.lock()->IsEmpty()); }
+            [[nodiscard]] inline bool IsNotEmpty() const { return (_node != nullptr) && !(_node->IsEmpty()); }
+            // Traversers walk the tree's actual shape, so while the tree is relaxed they can land on removed elements.
+            [[nodiscard]] inline bool IsTombstone() const { return (_node != nullptr) && _node->_isTombstone; }
+            // Right subtree height minus left subtree height, as the tree has it recorded.
+            [[nodiscard]] inline BalanceFactor GetBalanceFactor() const { return (_node == nullptr) ? 0 : _node->GetBalanceFactor(); }
             [[nodiscard]] inline bool operator!() const { return !IsNotEmpty(); }
             [[nodiscard]] inline explicit operator bool() const { return !operator!(); }
 
             bool GoToParent();
-            [[nodiscard]] inline bool IsAbleToGoToParent() const { std::shared_ptr<Node> _; return IsAbleToGoToParent(_); }
+            [[nodiscard]] bool IsAbleToGoToParent() const;
 
             inline bool GoToRightChild() { return GoToChild(false); }
             inline bool GoToLeftChild() { return GoToChild(true); }
@@ -248,15 +303,12 @@ namespace BST_P {
             [[nodiscard]] inline bool IsAbleToGoToLeftChild() { return IsAbleToGoToChild(true); }
 
         private:
-            inline explicit NodeTraverser(AvlTree const & tree, std::weak_ptr<Node> node) : _tree{&tree}, _node{node} {}
+            inline explicit NodeTraverser(Node * node) : _node{node} {}
 
             [[nodiscard]] bool GoToChild(bool isTraversingLeft);
-            [[nodiscard]] bool IsAbleToGoToParent(std::shared_ptr<Node> & outputNode) const;
-            [[nodiscard]] bool IsAbleToGoToChild(bool isLookingLeft, std::shared_ptr<Node> & outputNode) const;
-            [[nodiscard]] inline bool IsAbleToGoToChild(bool isLookingLeft) const { std::shared_ptr<Node> _; return IsAbleToGoToChild(isLookingLeft, _); }
+            [[nodiscard]] bool IsAbleToGoToChild(bool isLookingLeft) const;
 
-            AvlTree const * _tree;
-            std::weak_ptr<Node> _node;
+            Node * _node;
         };
 
         typedef T value_type;
@@ -267,39 +319,65 @@ namespace BST_P {
         typedef value_type const & const_reference;
         typedef ConstIterator const_iterator;
         typedef std::function<int(const_reference, const_reference)> CompareFunctor;
+        typedef std::function<AsyncComparison(const_reference, const_reference)> AsyncCompareFunctor;
+        typedef AsyncEmplacement<std::pair<bool, iterator>> Emplacement;
 
         explicit AvlTree(CompareFunctor defaultCompare = subtract<value_type>{});
         AvlTree(AvlTree const &) = delete;
         AvlTree(AvlTree &&) noexcept;
         AvlTree & operator=(AvlTree const &) = delete;
         AvlTree & operator=(AvlTree &&) noexcept;
-        inline ~AvlTree() { if (!!_root) { _root->ReleaseChildren(false); } }
+        inline ~AvlTree() { Clear(); }
+
+        // Copies the tree's shape node for node in O(n). No comparisons or rotations are performed, so the copy is identical to this tree.
+        [[nodiscard]] AvlTree Clone() const;
 
         [[nodiscard]] inline iterator begin() { return iterator{cbegin()}; }
-        [[nodiscard]] inline const_iterator cbegin() const { return const_iterator{*this, _leftmost}; }
+        [[nodiscard]] inline const_iterator cbegin() const { return const_iterator{SkipTombstones(_leftmost)}; }
         [[nodiscard]] inline const_iterator begin() const { return cbegin(); }
         [[nodiscard]] inline iterator end() { return iterator{cend()}; }
-        [[nodiscard]] inline const_iterator cend() const { return const_iterator{*this, (_height == 0U) ? _root : _rightmost->GetRightChild()}; }
+        [[nodiscard]] inline const_iterator cend() const { return const_iterator{&_header}; }
         [[nodiscard]] inline const_iterator end() const { return cend(); }
         [[nodiscard]] inline iterator Find(const_reference dataToFind) { return iterator{cFind(dataToFind)}; }
-        [[nodiscard]] inline const_iterator cFind(const_reference dataToFind) const { return const_iterator{*this, FindNodeWithData(dataToFind, _DefaultCompare)}; }
+        [[nodiscard]] inline const_iterator cFind(const_reference dataToFind) const { return const_iterator{FindNodeWithData(dataToFind, _DefaultCompare)}; }
         [[nodiscard]] inline const_iterator Find(const_reference dataToFind) const { return cFind(dataToFind); }
         [[nodiscard]] inline iterator Find(const_reference dataToFind, CompareFunctor specializedCompareFunctor) { return iterator{cFind(dataToFind, specializedCompareFunctor)}; }
         [[nodiscard]] inline const_iterator cFind(const_reference dataToFind, CompareFunctor specializedCompareFunctor) const {
-            return const_iterator{*this, FindNodeWithData(dataToFind, specializedCompareFunctor)};
+            return const_iterator{FindNodeWithData(dataToFind, specializedCompareFunctor)};
         }
         [[nodiscard]] inline const_iterator Find(const_reference dataToFind, CompareFunctor specializedCompareFunctor) const { return cFind(dataToFind, specializedCompareFunctor); }
 
-        [[nodiscard]] inline NodeTraverser CreateNodeTraverser() const { return NodeTraverser{*this, _root}; }
-        [[nodiscard]] inline NodeTraverser CreateNodeTraverser(iterator const & itr) const { return NodeTraverser{*(itr._impl._tree), itr._impl._node}; }
-        [[nodiscard]] inline NodeTraverser CreateNodeTraverser(const_iterator const & itr) const { return NodeTraverser{*(itr._impl._tree), itr._impl._node}; }
+        [[nodiscard]] inline NodeTraverser CreateNodeTraverser() const { return NodeTraverser{_header._leftChild.get()}; }
+        [[nodiscard]] inline NodeTraverser CreateNodeTraverser(iterator const & itr) const { return NodeTraverser{itr._impl._node}; }
+        [[nodiscard]] inline NodeTraverser CreateNodeTraverser(const_iterator const & itr) const { return NodeTraverser{itr._impl._node}; }
 
+        // Exact, except while the tree is relaxed, when it's only an upper bound.
         [[nodiscard]] inline Height GetHeight() const { return _height; }
+        [[nodiscard]] inline std::size_t GetSize() const { return _size; }
+        [[nodiscard]] inline bool IsEmpty() const { return _size == 0U; }
+        // Changes whenever nodes are linked, unlinked or moved around, so a path taken down the tree only still holds while this stays the same.
+        [[nodiscard]] inline std::uint64_t GetStructureVersion() const { return _structureVersion; }
 
         CompareFunctor const & GetDefaultCompare() const { return _DefaultCompare; }
 
+        // Only there for trees with CountingStats.
+        [[nodiscard]] AvlTreeStats GetStats() const requires StatsPolicy::IS_COUNTING;
+        inline void ResetStats() requires StatsPolicy::IS_COUNTING { _stats = StatsPolicy{}; }
+
         template<class... Args> std::pair<bool, iterator> Emplace(CompareFunctor emplaceCompareFunctor, Args&&...);
         template<class... Args> inline std::pair<bool, iterator> DefaultEmplace(Args&&... args) { return Emplace(_DefaultCompare, std::forward<Args>(args)...); }
+        // Links the new element in just before position, which can be end(), without comparing anything. For callers that already know where it goes.
+        // Nothing checks that it belongs there. While relaxed, tombstones right before position are purged first. Returns end() if position isn't from this tree.
+        template<class... Args> iterator EmplaceBefore(const_iterator position, Args&&... args);
+        /*
+         * Like Emplace, but compares through awaitables, so the insertion can wait on each answer while others carry on. Several can be in flight at once,
+         * and they can be answered, and so commit, in any order. An insertion that finds the tree restructured after a comparison, by another one committing or by
+         * anything else, starts its descent over from the root, since what it passed on the way down may have moved. Compare functors that remember their
+         * answers make a restart cheap. The new element is constructed before the first comparison, but compare's arguments are only valid until it returns,
+         * so it should copy anything it needs from them. Destroying the Emplacement before it's done abandons the insertion without touching the tree.
+         * The tree has to outlive its insertions and stay where it is while they're in flight.
+         */
+        template<class... Args> Emplacement EmplaceAsync(AsyncCompareFunctor compare, Args&&... args);
         inline std::pair<bool, iterator> Insert(const_reference dataToCopyAndInsert, CompareFunctor specializedInsertionCompareFunctor) {
             return Emplace(specializedInsertionCompareFunctor, dataToCopyAndInsert);
         }
@@ -310,24 +388,131 @@ namespace BST_P {
         inline std::pair<bool, iterator> Insert(value_type && dataToMoveAndInsert) { return Emplace(_DefaultCompare, std::move(dataToMoveAndInsert)); }
 
         bool Remove(iterator && nodeToRemove, std::unique_ptr<value_type> & outputRemovedData);
-        inline bool Remove(iterator && nodeToRemove) { std::unique_ptr<value_type> _; return Remove(std::move(nodeToRemove), _); }
+        // While the tree is relaxed, this leaves a tombstone behind. The overloads that hand back the removed data always unlink the node.
+        bool Remove(iterator && nodeToRemove);
         inline bool Remove(const_reference dataToRemove, std::unique_ptr<value_type> & outputRemovedData, CompareFunctor specializedCompareFunctor) {
             return Remove(Find(dataToRemove, specializedCompareFunctor), outputRemovedData);
         }
-        inline bool Remove(const_reference dataToRemove, CompareFunctor specializedCompareFunctor) { std::unique_ptr<value_type> _; return Remove(dataToRemove, _, specializedCompareFunctor); }
+        inline bool Remove(const_reference dataToRemove, CompareFunctor specializedCompareFunctor) { return Remove(Find(dataToRemove, specializedCompareFunctor)); }
         inline bool Remove(const_reference dataToRemove, std::unique_ptr<value_type> & outputRemovedData) { return Remove(dataToRemove, outputRemovedData, _DefaultCompare); }
-        inline bool Remove(const_reference dataToRemove) { std::unique_ptr<value_type> _; return Remove(dataToRemove, _, _DefaultCompare); }
-
-    private:
-        std::weak_ptr<Node> FindNodeWithData(const_reference dataToFind, CompareFunctor Compare) const;
-        bool Rotate(std::weak_ptr<Node> grandparent, SubtreeHeightMap & subtreeHeightMap);
+        inline bool Remove(const_reference dataToRemove) { return Remove(Find(dataToRemove)); }
+
+        void Clear();
+
+        /*
+         * Moves the elements from position on into a new tree with the same default compare functor, and returns it. Append puts the elements of other,
+         * which must all order after this tree's, on the end of this one. Both take the nodes apart in order and relink them perfectly balanced,
+         * in O(n) without comparing any elements. The nodes move as they are, so iterators to the elements follow them.
+         */
+        [[nodiscard]] AvlTree SplitOff(const_iterator position);
+        void Append(AvlTree && other);
+
+        /*
+         * Makes newDefault the default compare functor and re-sorts the tree under it, reusing the nodes instead of removing and reinserting every element.
+         * The elements are sorted on the pool once there are at least PARALLEL_SORT_THRESHOLD of them, and relinked into a perfectly balanced tree in O(n).
+         * Elements that newDefault finds equal to an earlier element (earlier under the old order) are handed back through outputDuplicates.
+         * Only iterators to those elements are invalidated; the others keep pointing at the same elements, in their new order.
+         * Every comparison is made before the tree is touched, so if newDefault throws, or sorting runs out of memory, the tree is left as it was.
+         */
+        void Reorder(CompareFunctor newDefault, std::vector<std::unique_ptr<value_type>> & outputDuplicates, WorkStealingPool & pool = WorkStealingPool::GetDefault());
+        inline void Reorder(CompareFunctor newDefault, WorkStealingPool & pool = WorkStealingPool::GetDefault()) {
+            std::vector<std::unique_ptr<value_type>> _;
+            Reorder(std::move(newDefault), _, pool);
+        }
 
-        inline bool Rotate(std::weak_ptr<Node> grandparent) { SubtreeHeightMap _; return Rotate(grandparent, _); }
+        static constexpr std::size_t PARALLEL_SORT_THRESHOLD = 1U << 14U;
+
+        // Writes the elements in order, one at a time, in the format described in AvlTreeSerialization.h. Tombstones aren't saved.
+        template<class Codec = TrivialElementCodec<T>> void Save(std::ostream & stream, Codec const & codec = Codec{}) const;
+        /*
+         * Replaces the tree's elements with saved ones, linked perfectly balanced in O(n). Nothing is compared, so the saved order has to agree with this tree's
+         * default compare functor. Throws if the stream isn't a saved tree of this version or is truncated or corrupt, in which case the tree is left as it was.
+         */
+        template<class Codec = TrivialElementCodec<T>> void Load(std::istream & stream, Codec const & codec = Codec{});
+
+        /*
+         * For bursts of changes. While the tree is relaxed, Emplace links new nodes without retracing or rotating, Remove leaves tombstones
+         * (see above) or unlinks without retracing, and both just mark the path they touched. Rebalance resolves the marks in one pass
+         * that only visits marked nodes: it purges tombstones and rebuilds, perfectly balanced, the smallest subtrees that aren't AVL balanced anymore.
+         *
+         * Lookups and iteration stay correct throughout. To keep them close to logarithmic, an Emplace that lands deeper than
+         * RELAXED_HEIGHT_FACTOR times the height of a perfectly balanced tree of the same size rebalances on the spot,
+         * and so does a Remove that leaves more tombstones than elements, so a relaxed tree under steady churn doesn't keep growing.
+         * Turning relaxed balancing off rebalances too, so a tree that isn't relaxed is always a plain AVL tree.
+         */
+        void SetRelaxedBalancing(bool isRelaxed);
+        [[nodiscard]] inline bool IsRelaxedBalancing() const { return _isRelaxed; }
+        void Rebalance();
+        [[nodiscard]] inline std::size_t GetTombstoneCount() const { return _tombstoneCount; }
+
+        static constexpr Height RELAXED_HEIGHT_FACTOR = 2U;
+
+        /*
+         * Splits the tree into runs of consecutive elements, about CHUNKS_PER_THREAD of them per pool thread, and calls visitor(chunkIndex, first, last)
+         * for each run [first, last) on the pool. Chunk indices follow the elements' order, so writing results into one slot per chunk keeps them in order.
+         * Returns the number of chunks. The tree must not be modified until this returns.
+         */
+        template<class ChunkVisitor> std::size_t ParallelForEachChunk(ChunkVisitor && visitor, WorkStealingPool & pool = WorkStealingPool::GetDefault()) const;
+        // Calls visitor on every element, from several threads at once and in no particular order.
+        template<class Visitor> void ParallelForEach(Visitor && visitor, WorkStealingPool & pool = WorkStealingPool::GetDefault()) const;
+        // Folds map(element) over the elements in order using combine, which only needs to be associative with identity as its identity element.
+        template<class Result, class Map, class Combine> Result ParallelReduce(Result identity, Map && map, Combine && combine, WorkStealingPool & pool = WorkStealingPool::GetDefault()) const;
+
+        static constexpr std::size_t CHUNKS_PER_THREAD = 8U;
 
-        std::shared_ptr<Node> _root;
-        std::shared_ptr<Node> _rightmost;
-        std::shared_ptr<Node> _leftmost;
+    private:
+        static void CheckDereference(Node const * node);
+        Node * FindNodeWithData(const_reference dataToFind, CompareFunctor Compare) const;
+        inline int CountedCompare(CompareFunctor const & Compare, const_reference a, const_reference b) const { _stats.CountComparisons(1U); return Compare(a, b); }
+        [[nodiscard]] bool IsNodeOfTree(Node const * node) const;
+        // After the root was handed over from a tree whose header was previousHeader, points the root and any extremes still at that header at this tree's.
+        void AdoptRoot(Node const * previousHeader);
+        inline std::unique_ptr<Node> & GetOwningPointer(Node * node) { return node->IsLeftChild() ? node->_parent->_leftChild : node->_parent->_rightChild; }
+
+        // The ends of Emplace, once it's found an equal node or the empty slot the new node goes in. depth is the slot's.
+        std::pair<bool, iterator> SettleOnEqual(std::unique_ptr<Node> && emplaced, Node * equal);
+        iterator LinkEmplaced(std::unique_ptr<Node> && emplaced, Node * parent, bool isLeftChild, Height depth);
+        Node * LinkNewNode(std::unique_ptr<Node> && nodeToLink, Node * parent, bool isLeftChild);
+        void RetraceAfterInsertion(Node * inserted);
+        void RetraceAfterRemoval(Node * current, bool isShrunkenSideLeft);
+        Node * RotateOnce(Node * top, bool isRotatingLeft);
+        Node * Rotate(Node * grandparent);
+
+        void MarkForRebalance(Node * node);
+        // Returns the subtree's height once it's AVL balanced again. Recursion only follows marked nodes, so it's bounded by the relaxed height limit.
+        Height ResolveSubtree(std::unique_ptr<Node> & subtree);
+        // Purges the subtree's tombstones and relinks the rest of its nodes perfectly balanced. Returns the new height.
+        Height RebuildSubtree(std::unique_ptr<Node> & subtree);
+        // Takes the subtree apart without recursing, freeing its tombstones. Appends the remaining nodes to nodes in order, childless but with stale parents.
+        // Only growing nodes can throw, so with room reserved for them first, it doesn't.
+        void UnlinkInOrder(std::unique_ptr<Node> & subtree, std::vector<std::unique_ptr<Node>> & nodes);
+        void FindExtremes();
+        // Links nodes[first, last), which must be in order and unlinked, into a perfectly balanced subtree under parent.
+        static std::unique_ptr<Node> LinkBalanced(std::vector<std::unique_ptr<Node>> & nodes, std::size_t first, std::size_t last, Node * parent);
+        // Follows the taller side down, so it's only right where the balance factors are up to date.
+        [[nodiscard]] static Height FindBalancedHeight(Node const * node);
+        [[nodiscard]] static inline Height FindPerfectHeight(std::size_t nodeCount) { Height height = 0U; for (; nodeCount > 0U; nodeCount >>= 1U) { ++height; } return height; }
+        // The first element at or after node, which may be the header.
+        [[nodiscard]] static Node * SkipTombstones(Node * node);
+
+        // The first node of each chunk, in order. The chunks are the subtrees at the shallowest depth with at least targetChunkCount slots.
+        [[nodiscard]] std::vector<Node *> FindChunkStarts(std::size_t targetChunkCount) const;
+        // A stable sort: runs are sorted on the pool's threads and then merged pairwise, each round of merges also on the pool.
+        template<class IsBefore> static void SortInParallel(std::vector<Node *> & nodes, IsBefore const & isBefore, WorkStealingPool & pool);
+        template<class ChunkVisitor> void RunChunks(std::vector<Node *> const & chunkStarts, ChunkVisitor & visitor, WorkStealingPool & pool) const;
+
+        // Held by value, so that moving a tree never allocates. Mutable since the end() iterators that const members hand out point at it.
+        mutable Node _header;
+        Node * _rightmost;
+        Node * _leftmost;
         Height _height;
+        // Tombstones aren't counted as elements.
+        std::size_t _size;
+        std::size_t _tombstoneCount;
+        std::uint64_t _structureVersion;
+        bool _isRelaxed;
+        // Empty unless the tree is counting. It goes last so that even where it isn't given zero size, it only fills padding.
+        [[no_unique_address]] mutable StatsPolicy _stats;
 
         CompareFunctor _DefaultCompare;
     };
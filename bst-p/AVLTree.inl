@@ -1,9 +1,11 @@
 #pragma once
 #include "AVLTree.h"
-#include <exception>
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
 
 namespace BST_P {
-    template<class T> typename AvlTree<T>::Height AvlTree<T>::Node::FindHeight() const {
+    template<class T, class CheckingPolicy, class StatsPolicy> typename AvlTree<T, CheckingPolicy, StatsPolicy>::Height AvlTree<T, CheckingPolicy, StatsPolicy>::Node::FindHeight() const {
         if (IsEmpty()) {
             return 0U;
         }
@@ -13,725 +15,1211 @@ namespace BST_P {
         return 1U + std::max(rightChildHeight, leftChildHeight);
     }
 
-    template<class T> typename AvlTree<T>::Height AvlTree<T>::Node::FindHeight(SubtreeHeightMap & subtreeHeightMap) const {
-        if (IsEmpty()) {
-            return 0U;
+    template<class T, class CheckingPolicy, class StatsPolicy> bool AvlTree<T, CheckingPolicy, StatsPolicy>::__IteratorImpl::Traverse(bool isTraversingLeft) {
+        Node * start = _node;
+
+        if (!Step(isTraversingLeft)) {
+            return false;
         }
 
-        std::uint64_t key = reinterpret_cast<std::uint64_t>(this);
-        auto foundThis = subtreeHeightMap.find(key);
+        while (_node->_isTombstone) {
+            if (!Step(isTraversingLeft)) {
+                // Only tombstones lie in this direction, so there's no element to move to.
+                _node = start;
+                return false;
+            }
+        }
 
-        if (foundThis != subtreeHeightMap.end()) {
-            return foundThis->second;
+        return true;
+    }
+
+    template<class T, class CheckingPolicy, class StatsPolicy> bool AvlTree<T, CheckingPolicy, StatsPolicy>::__IteratorImpl::Step(bool isTraversingLeft) {
+        if (_node == nullptr) {
+            return false;
+        }
+
+        Node * current = _node;
+
+        if (isTraversingLeft ? current->IsLeftParent() : current->IsRightParent()) {
+            current = isTraversingLeft ? current->_leftChild.get() : current->_rightChild.get();
+
+            while (isTraversingLeft ? current->IsRightParent() : current->IsLeftParent()) {
+                current = isTraversingLeft ? current->_rightChild.get() : current->_leftChild.get();
+            }
+
+            _node = current;
+            return true;
         }
 
-        Height rightChildHeight = IsRightParent() ? _rightChild->FindHeight(subtreeHeightMap) : 0U;
-        Height leftChildHeight = IsLeftParent() ? _leftChild->FindHeight(subtreeHeightMap) : 0U;
-        Height thisHeight = 1U + std::max(rightChildHeight, leftChildHeight);
+        // Climb until we arrive from the opposite side. The root is the header's left child, so forward iteration ends on the header, which is end().
+        while (current->_parent != nullptr) {
+            if (isTraversingLeft ? current->IsRightChild() : current->IsLeftChild()) {
+                _node = current->_parent;
+                return true;
+            }
 
-        subtreeHeightMap.insert(std::make_pair(key, thisHeight));
+            current = current->_parent;
+        }
 
-        return thisHeight;
+        return false;
     }
 
-    template<class T> void AvlTree<T>::Node::RemoveFromSubtreeHeightMap(SubtreeHeightMap & subtreeHeightMap, bool isAlsoRemovingAncestors) const {
-        std::uint64_t key = reinterpret_cast<std::uint64_t>(this);
-        subtreeHeightMap.erase(key);
+    template<class T, class CheckingPolicy, class StatsPolicy> void AvlTree<T, CheckingPolicy, StatsPolicy>::CheckDereference(Node const * node) {
+        if (node == nullptr) {
+            throw std::logic_error{"Cannot dereference null node!"};
+        }
 
-        if (isAlsoRemovingAncestors && _parent) {
-            _parent->RemoveFromSubtreeHeightMap(subtreeHeightMap, true);
+        if (node->IsEmpty()) {
+            throw std::out_of_range{"Cannot dereference null data at node!"};
         }
     }
 
-    template<class T> std::uint64_t AvlTree<T>::Node::ReleaseChildren(bool isCreatingEmptyNode) {
-        std::uint64_t releasedHeight = std::max(ReleaseRightChildren(isCreatingEmptyNode), ReleaseLeftChildren(isCreatingEmptyNode));
-        _isRequestingFullTreeRebalance = false;
-        _balanceFactor = 0;
-        return releasedHeight;
+    template<class T, class CheckingPolicy, class StatsPolicy> T & AvlTree<T, CheckingPolicy, StatsPolicy>::MutableIterator::operator*() const {
+        if constexpr (CheckingPolicy::IS_CHECKED) {
+            CheckDereference(_impl._node);
+        }
+
+        return *(_impl._node->GetData());
     }
 
-    template<class T> std::uint64_t AvlTree<T>::Node::ReleaseRightChildren(bool isCreatingEmptyNode) {
-        std::uint64_t releasedHeight = IsRightParent() ? (1U + _rightChild->ReleaseChildren(false)) : 0U;
+    template<class T, class CheckingPolicy, class StatsPolicy> T const & AvlTree<T, CheckingPolicy, StatsPolicy>::ConstIterator::operator*() const {
+        if constexpr (CheckingPolicy::IS_CHECKED) {
+            CheckDereference(_impl._node);
+        }
 
-        if (isCreatingEmptyNode) {
-            _rightChild = std::make_shared<Node, AvlTree const &, std::weak_ptr<Node>>(*_tree, _rightChild->_parent);
-        } else {
-            _rightChild.reset();
+        return *(_impl._node->GetData());
+    }
+
+    template<class T, class CheckingPolicy, class StatsPolicy> T const & AvlTree<T, CheckingPolicy, StatsPolicy>::NodeTraverser::operator*() const {
+        if constexpr (CheckingPolicy::IS_CHECKED) {
+            CheckDereference(_node);
         }
 
-        if ((releasedHeight > static_cast<std::uint64_t>(RIGHT_MAX - LEFT_MAX)) || (_balanceFactor > RIGHT_MAX) || (_balanceFactor <= LEFT_MAX)) {
-            _isRequestingFullTreeRebalance = true;
-        } else {
-            BalanceFactor newBalanceFactor = _balanceFactor - static_cast<BalanceFactor>(releasedHeight);
-            _isRequestingFullTreeRebalance = newBalanceFactor < LEFT_MAX;
+        return *(_node->GetData());
+    }
 
-            // only update the balance factor if it's being set to a value we can actually work with.
-            _balanceFactor = _isRequestingFullTreeRebalance ? _balanceFactor : newBalanceFactor;
+    template<class T, class CheckingPolicy, class StatsPolicy> bool AvlTree<T, CheckingPolicy, StatsPolicy>::NodeTraverser::GoToParent() {
+        if (!IsAbleToGoToParent()) {
+            return false;
         }
 
-        return releasedHeight;
+        _node = _node->_parent;
+        return true;
     }
 
-    template<class T> std::uint64_t AvlTree<T>::Node::ReleaseLeftChildren(bool isCreatingEmptyNode) {
-        std::uint64_t releasedHeight = IsLeftParent() ? (1U + _leftChild->ReleaseChildren(false)) : 0U;
+    template<class T, class CheckingPolicy, class StatsPolicy> bool AvlTree<T, CheckingPolicy, StatsPolicy>::NodeTraverser::IsAbleToGoToParent() const {
+        // The root's parent is the header, which isn't an element of the tree.
+        return (_node != nullptr) && (_node->_parent != nullptr) && !(_node->_parent->IsEmpty());
+    }
 
-        if (isCreatingEmptyNode) {
-            _leftChild = std::make_shared<Node, AvlTree<T> const &, std::weak_ptr<Node>>(*_tree, _leftChild->_parent);
-        } else {
-            _leftChild.reset();
+    template<class T, class CheckingPolicy, class StatsPolicy> bool AvlTree<T, CheckingPolicy, StatsPolicy>::NodeTraverser::GoToChild(bool isTraversingLeft) {
+        if (!IsAbleToGoToChild(isTraversingLeft)) {
+            return false;
         }
 
-        if ((releasedHeight > static_cast<std::uint64_t>(RIGHT_MAX - LEFT_MAX)) || (_balanceFactor >= RIGHT_MAX) || (_balanceFactor < LEFT_MAX)) {
-            _isRequestingFullTreeRebalance = true;
-        } else {
-            BalanceFactor newBalanceFactor = _balanceFactor + static_cast<BalanceFactor>(releasedHeight);
-            _isRequestingFullTreeRebalance = newBalanceFactor > RIGHT_MAX;
+        _node = isTraversingLeft ? _node->_leftChild.get() : _node->_rightChild.get();
+        return true;
+    }
 
-            // only update the balance factor if it's being set to a value we can actually work with.
-            _balanceFactor = _isRequestingFullTreeRebalance ? _balanceFactor : newBalanceFactor;
+    template<class T, class CheckingPolicy, class StatsPolicy> bool AvlTree<T, CheckingPolicy, StatsPolicy>::NodeTraverser::IsAbleToGoToChild(bool isLookingLeft) const {
+        if (_node == nullptr) {
+            return false;
         }
 
-        return releasedHeight;
+        return !(_node->IsEmpty()) && ((isLookingLeft && !!(_node->_leftChild)) || (!isLookingLeft && !!(_node->_rightChild)));
     }
 
-    template<class T> void AvlTree<T>::Node::BeginUpdatingTreePointer(AvlTree const & tree) {
-        if (!!_parent) {
-            _parent->BeginUpdatingTreePointer(tree);
-            return;
+    template<class T, class CheckingPolicy, class StatsPolicy> AvlTree<T, CheckingPolicy, StatsPolicy>::AvlTree(CompareFunctor defaultCompare)
+        : _header{}
+        , _rightmost{&_header}
+        , _leftmost{&_header}
+        , _height{0U}
+        , _size{0U}
+        , _tombstoneCount{0U}
+        , _structureVersion{0U}
+        , _isRelaxed{false}
+        , _stats{}
+        , _DefaultCompare{defaultCompare} {}
+
+    // Nodes don't know which tree owns them, so moving a tree only has to hand over the root and the extremes, and point the root at its new header.
+    // The tree moved from keeps its own header and a copy of the comparator, so it's left empty but as usable as a new one. The header needs no allocation;
+    // the copy only does for a comparator too big for std::function to hold inline, and since the move is noexcept, running out of memory there terminates.
+    template<class T, class CheckingPolicy, class StatsPolicy> AvlTree<T, CheckingPolicy, StatsPolicy>::AvlTree(AvlTree && other) noexcept
+        : _header{}
+        , _rightmost{other._rightmost}
+        , _leftmost{other._leftmost}
+        , _height{other._height}
+        , _size{other._size}
+        , _tombstoneCount{other._tombstoneCount}
+        , _structureVersion{other._structureVersion}
+        , _isRelaxed{other._isRelaxed}
+        , _stats{other._stats}
+        , _DefaultCompare{other._DefaultCompare}
+    {
+        _header._leftChild = std::move(other._header._leftChild);
+        AdoptRoot(&other._header);
+        other._rightmost = &other._header;
+        other._leftmost = &other._header;
+        other._height = 0U;
+        other._size = 0U;
+        other._tombstoneCount = 0U;
+        // Its nodes are gone, so anything that was descending it has to start over.
+        ++other._structureVersion;
+    }
+
+    template<class T, class CheckingPolicy, class StatsPolicy> AvlTree<T, CheckingPolicy, StatsPolicy> & AvlTree<T, CheckingPolicy, StatsPolicy>::operator=(AvlTree && other) noexcept {
+        // Swapping hands our old nodes to `other`, whose destructor releases them.
+        if (this != &other) {
+            _header._leftChild.swap(other._header._leftChild);
+            std::swap(_rightmost, other._rightmost);
+            std::swap(_leftmost, other._leftmost);
+            AdoptRoot(&other._header);
+            other.AdoptRoot(&_header);
+            std::swap(_height, other._height);
+            std::swap(_size, other._size);
+            std::swap(_tombstoneCount, other._tombstoneCount);
+            // Both trees' nodes changed hands, so anything descending either one has to start over. Past both old versions, so neither can come round again.
+            std::uint64_t structureVersion = std::max(_structureVersion, other._structureVersion) + 1U;
+            _structureVersion = structureVersion;
+            other._structureVersion = structureVersion;
+            std::swap(_isRelaxed, other._isRelaxed);
+            std::swap(_stats, other._stats);
+            _DefaultCompare.swap(other._DefaultCompare);
         }
 
-        _tree = &tree;
+        return *this;
+    }
 
-        if (!!_rightChild) {
-            _rightChild->ContinueUpdatingTreePointer(tree);
+    template<class T, class CheckingPolicy, class StatsPolicy> void AvlTree<T, CheckingPolicy, StatsPolicy>::AdoptRoot(Node const * previousHeader) {
+        if (_header.IsLeftParent()) {
+            _header._leftChild->_parent = &_header;
         }
 
-        if (!!_leftChild) {
-            _leftChild->ContinueUpdatingTreePointer(tree);
+        if (_rightmost == previousHeader) {
+            _rightmost = &_header;
+        }
+
+        if (_leftmost == previousHeader) {
+            _leftmost = &_header;
         }
     }
 
-    template<class T> void AvlTree<T>::Node::ContinueUpdatingTreePointer(AvlTree const & tree) {
-        if (!!_parent) {
-            if (_parent->_tree != &tree) {
-                _parent->BeginUpdatingTreePointer(tree);
-                return;
-            }
-        } else {
-            BeginUpdatingTreePointer(tree);
-            return;
+    template<class T, class CheckingPolicy, class StatsPolicy> AvlTree<T, CheckingPolicy, StatsPolicy> AvlTree<T, CheckingPolicy, StatsPolicy>::Clone() const {
+        AvlTree clone{_DefaultCompare};
+        clone._isRelaxed = _isRelaxed;
+
+        if (_header._leftChild == nullptr) {
+            return clone;
         }
 
-        _tree = &tree;
+        // Copy top-down with an explicit stack of (original, copy) pairs, so cloning never recurses.
+        std::vector<std::pair<Node const *, Node *>> pendingNodes;
+        pendingNodes.reserve(static_cast<std::size_t>(_height) + 1U);
+
+        Node const * root = _header._leftChild.get();
+        clone._header._leftChild = std::make_unique<Node>(&clone._header, *(root->GetData()));
+        pendingNodes.emplace_back(root, clone._header._leftChild.get());
+
+        while (!pendingNodes.empty()) {
+            Node const * original = pendingNodes.back().first;
+            Node * copy = pendingNodes.back().second;
+            pendingNodes.pop_back();
+
+            copy->_balanceFactor = original->_balanceFactor;
+            copy->_isRequestingFullTreeRebalance = original->_isRequestingFullTreeRebalance;
+            copy->_isTombstone = original->_isTombstone;
+
+            if (original == _leftmost) {
+                clone._leftmost = copy;
+            }
+            if (original == _rightmost) {
+                clone._rightmost = copy;
+            }
 
-        if (!!_rightChild) {
-            _rightChild->ContinueUpdatingTreePointer(tree);
+            if (original->IsRightParent()) {
+                copy->_rightChild = std::make_unique<Node>(copy, *(original->_rightChild->GetData()));
+                pendingNodes.emplace_back(original->_rightChild.get(), copy->_rightChild.get());
+            }
+            if (original->IsLeftParent()) {
+                copy->_leftChild = std::make_unique<Node>(copy, *(original->_leftChild->GetData()));
+                pendingNodes.emplace_back(original->_leftChild.get(), copy->_leftChild.get());
+            }
         }
 
-        if (!!_leftChild) {
-            _leftChild->ContinueUpdatingTreePointer(tree);
+        clone._height = _height;
+        clone._size = _size;
+        clone._tombstoneCount = _tombstoneCount;
+        clone._stats.CountAllocations(_size + _tombstoneCount);
+        return clone;
+    }
+
+    template<class T, class CheckingPolicy, class StatsPolicy> void AvlTree<T, CheckingPolicy, StatsPolicy>::Clear() {
+        // Rotate left children up onto the right spine, freeing each node once it has no left child. Every node is visited a constant number of times and nothing recurses.
+        // Nodes are being thrown away, so neither parent pointers nor balance factors are maintained along the way.
+        _stats.CountFrees(_size + _tombstoneCount);
+        std::unique_ptr<Node> current = std::move(_header._leftChild);
+
+        while (!!current) {
+            if (current->IsLeftParent()) {
+                std::unique_ptr<Node> leftChild = std::move(current->_leftChild);
+                current->_leftChild = std::move(leftChild->_rightChild);
+                leftChild->_rightChild = std::move(current);
+                current = std::move(leftChild);
+            } else {
+                current = std::move(current->_rightChild);
+            }
         }
+
+        _rightmost = &_header;
+        _leftmost = &_header;
+        _height = 0U;
+        _size = 0U;
+        _tombstoneCount = 0U;
+        ++_structureVersion;
     }
 
-    template<class T> void AvlTree<T>::Node::ClearSelfAndChildrenIsRequestingFullTreeRebelance() {
-        _isRequestingFullTreeRebalance = false;
+    template<class T, class CheckingPolicy, class StatsPolicy> AvlTree<T, CheckingPolicy, StatsPolicy> AvlTree<T, CheckingPolicy, StatsPolicy>::SplitOff(const_iterator position) {
+        // Everything that can throw comes first, so a failure leaves this tree as it was.
+        AvlTree upper{_DefaultCompare};
+        upper._isRelaxed = _isRelaxed;
+        std::vector<std::unique_ptr<Node>> nodes;
+        nodes.reserve(_size);
+
+        Node const * first = position._impl._node;
+        UnlinkInOrder(_header._leftChild, nodes);
+        std::size_t keptCount = static_cast<std::size_t>(std::find_if(nodes.cbegin(), nodes.cend(), [first](std::unique_ptr<Node> const & node) { return node.get() == first; }) - nodes.cbegin());
+
+        upper._header._leftChild = LinkBalanced(nodes, keptCount, nodes.size(), &upper._header);
+        upper._height = FindPerfectHeight(nodes.size() - keptCount);
+        upper._size = nodes.size() - keptCount;
+        upper.FindExtremes();
+
+        _header._leftChild = LinkBalanced(nodes, 0U, keptCount, &_header);
+        _height = FindPerfectHeight(keptCount);
+        _size = keptCount;
+        ++_structureVersion;
+        FindExtremes();
+        return upper;
+    }
 
-        if (!!_rightChild) {
-            _rightChild->ClearSelfAndChildrenIsRequestingFullTreeRebelance();
-        }
+    template<class T, class CheckingPolicy, class StatsPolicy> void AvlTree<T, CheckingPolicy, StatsPolicy>::Append(AvlTree && other) {
+        assert(IsEmpty() || other.IsEmpty() || (_DefaultCompare(*(--cend()), *(other.cbegin())) < 0));
 
-        if (!!_leftChild) {
-            _leftChild->ClearSelfAndChildrenIsRequestingFullTreeRebelance();
+        std::vector<std::unique_ptr<Node>> nodes;
+        nodes.reserve(_size + other._size);
+        UnlinkInOrder(_header._leftChild, nodes);
+        UnlinkInOrder(other._header._leftChild, nodes);
+
+        other._rightmost = &other._header;
+        other._leftmost = &other._header;
+        other._height = 0U;
+        other._size = 0U;
+        ++other._structureVersion;
+
+        _header._leftChild = LinkBalanced(nodes, 0U, nodes.size(), &_header);
+        _height = FindPerfectHeight(nodes.size());
+        _size = nodes.size();
+        ++_structureVersion;
+        FindExtremes();
+    }
+
+    template<class T, class CheckingPolicy, class StatsPolicy> typename AvlTree<T, CheckingPolicy, StatsPolicy>::Node * AvlTree<T, CheckingPolicy, StatsPolicy>::FindNodeWithData(const_reference dataToFind, CompareFunctor Compare) const {
+        Node * node = _header._leftChild.get();
+
+        while (node != nullptr) {
+            int comparison = CountedCompare(Compare, dataToFind, *(node->GetData()));
+
+            if (comparison == 0) {
+                return node->_isTombstone ? &_header : node;
+            }
+
+            if (comparison > 0) {
+                node = node->_rightChild.get();
+            } else {
+                node = node->_leftChild.get();
+            }
         }
+
+        // equivalent to end()
+        return &_header;
     }
 
-    template<class T> bool AvlTree<T>::__IteratorImpl::Traverse(bool isTraversingLeft) {
-        if (_node.expired()) {
+    template<class T, class CheckingPolicy, class StatsPolicy> bool AvlTree<T, CheckingPolicy, StatsPolicy>::IsNodeOfTree(Node const * node) const {
+        if (node == nullptr) {
             return false;
         }
 
-        std::shared_ptr<Node> node = _node.lock();
-        std::shared_ptr<Node> current = node;
+        while (node->_parent != nullptr) {
+            node = node->_parent;
+        }
 
-        if (isTraversingLeft ? current->IsLeftParent() : current->IsRightParent()) {
-            current = isTraversingLeft ? current->_leftChild : current->_rightChild;
+        return node == &_header;
+    }
 
-            while (isTraversingLeft ? current->IsRightParent() : current->IsLeftParent()) {
-                current = isTraversingLeft ? current->_rightChild : current->_leftChild;
+    template<class T, class CheckingPolicy, class StatsPolicy> template<class... Args> std::pair<bool, typename AvlTree<T, CheckingPolicy, StatsPolicy>::iterator> AvlTree<T, CheckingPolicy, StatsPolicy>::Emplace(CompareFunctor Compare, Args&&... args) {
+        std::unique_ptr<Node> emplaced = std::make_unique<Node>(nullptr, std::forward<Args>(args)...);
+        _stats.CountAllocations(1U);
+
+        assert(!(emplaced->IsEmpty()));
+        if (emplaced->IsEmpty()) {
+            return std::make_pair(false, end());
+        }
+
+        Node * parent = &_header;
+        bool isLeftChild = true;
+        Height depth = 1U;
+
+        for (Node * current = _header._leftChild.get(); current != nullptr; ++depth) {
+            int comparison = CountedCompare(Compare, *(emplaced->GetData()), *(current->GetData()));
+
+            if (comparison == 0) {
+                return SettleOnEqual(std::move(emplaced), current);
             }
 
-            _node = current;
-            return true;
+            parent = current;
+            isLeftChild = comparison < 0;
+            current = isLeftChild ? current->_leftChild.get() : current->_rightChild.get();
         }
 
-        if (isTraversingLeft ? current->IsRightChild() : current->IsLeftChild()) {
-            _node = current->_parent;
-            return true;
+        return std::make_pair(true, LinkEmplaced(std::move(emplaced), parent, isLeftChild, depth));
+    }
+
+    template<class T, class CheckingPolicy, class StatsPolicy> template<class... Args> typename AvlTree<T, CheckingPolicy, StatsPolicy>::Emplacement AvlTree<T, CheckingPolicy, StatsPolicy>::EmplaceAsync(AsyncCompareFunctor Compare, Args&&... args) {
+        // Its allocation is only counted once the insertion's done, so abandoning it doesn't leave a node counted but never freed.
+        std::unique_ptr<Node> emplaced = std::make_unique<Node>(nullptr, std::forward<Args>(args)...);
+
+        assert(!(emplaced->IsEmpty()));
+        if (emplaced->IsEmpty()) {
+            co_return std::make_pair(false, end());
         }
 
-        if (isTraversingLeft ? current->IsLeftChild() : current->IsRightChild()) {
-            current = current->_parent;
+        // Each pass descends from the root. It's only trusted to the end if nothing restructured the tree while it waited on its comparisons.
+        for (;;) {
+            std::uint64_t structureVersion = _structureVersion;
+            Node * parent = &_header;
+            bool isLeftChild = true;
+            Height depth = 1U;
+            Node * current = _header._leftChild.get();
+
+            for (; current != nullptr; ++depth) {
+                int comparison = co_await Compare(*(emplaced->GetData()), *(current->GetData()));
+                _stats.CountComparisons(1U);
 
-            while (!!(current->_parent)) {
-                if (isTraversingLeft ? current->IsRightChild() : current->IsLeftChild()) {
-                    _node = current->_parent;
-                    return true;
+                if (_structureVersion != structureVersion) {
+                    break;
+                }
+
+                if (comparison == 0) {
+                    _stats.CountAllocations(1U);
+                    co_return SettleOnEqual(std::move(emplaced), current);
                 }
 
-                current = current->_parent;
+                parent = current;
+                isLeftChild = comparison < 0;
+                current = isLeftChild ? current->_leftChild.get() : current->_rightChild.get();
+            }
+
+            if (current == nullptr) {
+                _stats.CountAllocations(1U);
+                co_return std::make_pair(true, LinkEmplaced(std::move(emplaced), parent, isLeftChild, depth));
             }
         }
+    }
 
-        // TraverseRight only - forward iteration is allowed to go "just outside" the chain.
-        if (!isTraversingLeft && !(node->IsEmpty()) && !!(node->_rightChild)) {
-            _node = node->_rightChild;
-            return true;
+    template<class T, class CheckingPolicy, class StatsPolicy> std::pair<bool, typename AvlTree<T, CheckingPolicy, StatsPolicy>::iterator> AvlTree<T, CheckingPolicy, StatsPolicy>::SettleOnEqual(std::unique_ptr<Node> && emplaced, Node * equal) {
+        // Either way, the new node goes unused.
+        _stats.CountFrees(1U);
+
+        if (equal->_isTombstone) {
+            // The node is already where the new element belongs, so it just takes the new data.
+            equal->_data = std::move(emplaced->_data);
+            equal->_isTombstone = false;
+            --_tombstoneCount;
+            ++_size;
+            return std::make_pair(true, iterator{equal});
         }
 
-        return false;
+        return std::make_pair(false, iterator{equal});
     }
 
-    template<class T> T & AvlTree<T>::MutableIterator::operator*() const {
-        if (_impl._node.expired()) {
-            throw std::exception{"Cannot dereference null node!"};
-        }
+    template<class T, class CheckingPolicy, class StatsPolicy> typename AvlTree<T, CheckingPolicy, StatsPolicy>::iterator AvlTree<T, CheckingPolicy, StatsPolicy>::LinkEmplaced(std::unique_ptr<Node> && emplaced, Node * parent, bool isLeftChild, Height depth) {
+        Node * linked = LinkNewNode(std::move(emplaced), parent, isLeftChild);
+        ++_size;
 
-        std::shared_ptr<Node> node = _impl._node.lock();
+        if (_isRelaxed) {
+            _height = std::max(_height, depth);
 
-        if (node->IsEmpty()) {
-            throw std::exception{"Cannot dereference null data at node!"};
+            if (depth > RELAXED_HEIGHT_FACTOR * FindPerfectHeight(_size + _tombstoneCount)) {
+                Rebalance();
+            }
         }
 
-        return *(node->GetData());
+        return iterator{linked};
     }
 
-    template<class T> T const & AvlTree<T>::ConstIterator::operator*() const {
-        if (_impl._node.expired()) {
-            throw std::exception{"Cannot dereference null node!"};
+    template<class T, class CheckingPolicy, class StatsPolicy> template<class... Args> typename AvlTree<T, CheckingPolicy, StatsPolicy>::iterator AvlTree<T, CheckingPolicy, StatsPolicy>::EmplaceBefore(const_iterator position, Args&&... args) {
+        Node * successor = position._impl._node;
+
+        if (!IsNodeOfTree(successor)) {
+            return end();
         }
 
-        std::shared_ptr<Node> node = _impl._node.lock();
+        if (_isRelaxed && (_tombstoneCount > 0U)) {
+            // A tombstone just before position could belong on either side of the new element, and there's nothing to tell which, so they're purged first.
+            __IteratorImpl predecessor{successor};
 
-        if (node->IsEmpty()) {
-            throw std::exception{"Cannot dereference null data at node!"};
+            if (predecessor.Step(true) && predecessor._node->_isTombstone) {
+                Rebalance();
+            }
         }
 
-        return *(node->GetData());
-    }
+        std::unique_ptr<Node> emplaced = std::make_unique<Node>(nullptr, std::forward<Args>(args)...);
+        _stats.CountAllocations(1U);
 
-    template<class T> T const & AvlTree<T>::NodeTraverser::operator*() const {
-        if (_node.expired()) {
-            throw std::exception{ "Cannot dereference null node!" };
-        }
+        Node * parent;
+        bool isLeftChild;
 
-        std::shared_ptr<Node> node = _node.lock();
+        if (successor == &_header) {
+            // Going after everything, it hangs off the rightmost node, unless it's the first.
+            isLeftChild = !(_header.IsLeftParent());
+            parent = isLeftChild ? &_header : _rightmost;
+        } else if (!(successor->IsLeftParent())) {
+            parent = successor;
+            isLeftChild = true;
+        } else {
+            // Otherwise the spot just before it is right of its predecessor, which is rightmost in its left subtree.
+            parent = successor->_leftChild.get();
+            isLeftChild = false;
 
-        if (node->IsEmpty()) {
-            throw std::exception{ "Cannot dereference null data at node!" };
+            while (parent->IsRightParent()) {
+                parent = parent->_rightChild.get();
+            }
         }
 
-        return *(node->GetData());
-    }
+        Node * linked = LinkNewNode(std::move(emplaced), parent, isLeftChild);
+        ++_size;
 
-    template<class T> bool AvlTree<T>::NodeTraverser::GoToParent() {
-        std::shared_ptr<Node> node;
+        if (_isRelaxed) {
+            Height depth = 0U;
+            for (Node const * ancestor = linked; ancestor != &_header; ancestor = ancestor->_parent) {
+                ++depth;
+            }
 
-        if (!IsAbleToGoToParent(node)) {
-            return false;
+            _height = std::max(_height, depth);
+
+            if (depth > RELAXED_HEIGHT_FACTOR * FindPerfectHeight(_size + _tombstoneCount)) {
+                Rebalance();
+            }
         }
 
-        _node = node->_parent;
-        return true;
+        return iterator{linked};
     }
 
-    template<class T> bool AvlTree<T>::NodeTraverser::IsAbleToGoToParent(std::shared_ptr<Node> & node) const {
-        if (_node.expired()) {
-            return false;
+    template<class T, class CheckingPolicy, class StatsPolicy> typename AvlTree<T, CheckingPolicy, StatsPolicy>::Node * AvlTree<T, CheckingPolicy, StatsPolicy>::LinkNewNode(std::unique_ptr<Node> && nodeToLink, Node * parent, bool isLeftChild) {
+        assert(!!nodeToLink && !(nodeToLink->IsLeftParent()) && !(nodeToLink->IsRightParent()));
+        assert(isLeftChild ? !(parent->IsLeftParent()) : !(parent->IsRightParent()));
+
+        Node * linked = nodeToLink.get();
+        linked->_parent = parent;
+        linked->_balanceFactor = 0;
+        (isLeftChild ? parent->_leftChild : parent->_rightChild) = std::move(nodeToLink);
+        ++_structureVersion;
+
+        if (parent == &_header) {
+            // This is the first element in the tree.
+            _rightmost = linked;
+            _leftmost = linked;
+        } else if (isLeftChild && (parent == _leftmost)) {
+            _leftmost = linked;
+        } else if (!isLeftChild && (parent == _rightmost)) {
+            _rightmost = linked;
         }
 
-        node = _node.lock();
-        return !!(node->_parent);
+        if (_isRelaxed) {
+            MarkForRebalance(parent);
+        } else {
+            RetraceAfterInsertion(linked);
+        }
+
+        return linked;
     }
 
-    template<class T> bool AvlTree<T>::NodeTraverser::GoToChild(bool isTraversingLeft) {
-        std::shared_ptr<Node> node;
+    template<class T, class CheckingPolicy, class StatsPolicy> void AvlTree<T, CheckingPolicy, StatsPolicy>::RetraceAfterInsertion(Node * inserted) {
+        Node * child = inserted;
+        Height length = 0U;
 
-        if (!IsAbleToGoToChild(isTraversingLeft, node)) {
-            return false;
+        for (Node * current = child->_parent; current != &_header; child = current, current = current->_parent) {
+            current->_balanceFactor += child->IsLeftChild() ? -1 : 1;
+            ++length;
+
+            if (current->_balanceFactor == 0) {
+                // The shorter side caught up, so this subtree's height didn't change.
+                _stats.CountRetrace(length);
+                return;
+            }
+
+            if (current->IsImbalanced()) {
+                // After an insertion, a rotation always restores the subtree's previous height.
+                Rotate(current);
+                _stats.CountRetrace(length);
+                return;
+            }
         }
 
-        _node = isTraversingLeft ? node->_leftChild : node->_rightChild;
-        return true;
+        // The growth made it all the way past the root.
+        ++_height;
+        _stats.CountRetrace(length);
     }
 
-    template<class T> bool AvlTree<T>::NodeTraverser::IsAbleToGoToChild(bool isLookingLeft, std::shared_ptr<Node> & node) const {
-        if (_node.expired()) {
-            return false;
+    template<class T, class CheckingPolicy, class StatsPolicy> typename AvlTree<T, CheckingPolicy, StatsPolicy>::Node * AvlTree<T, CheckingPolicy, StatsPolicy>::RotateOnce(Node * top, bool isRotatingLeft) {
+        // `pivot` is the child on the opposite side of the rotation's direction. It becomes the new top of the subtree, and `top` becomes its child.
+        std::unique_ptr<Node> & topSlot = GetOwningPointer(top);
+        std::unique_ptr<Node> & pivotSlot = isRotatingLeft ? top->_rightChild : top->_leftChild;
+        Node * const pivot = pivotSlot.get();
+        assert(pivot != nullptr);
+        std::unique_ptr<Node> & pivotInnerSlot = isRotatingLeft ? pivot->_leftChild : pivot->_rightChild;
+
+        std::unique_ptr<Node> ownedTop = std::move(topSlot);
+        std::unique_ptr<Node> ownedPivot = std::move(pivotSlot);
+
+        // The pivot's inner subtree moves across to `top`.
+        pivotSlot = std::move(pivotInnerSlot);
+        if (!!pivotSlot) {
+            pivotSlot->_parent = top;
         }
 
-        node = _node.lock();
-        return !(node->IsEmpty()) && ((isLookingLeft && !!(node->_leftChild)) || (!isLookingLeft && !!(node->_rightChild)));
-    }
+        pivot->_parent = top->_parent;
+        top->_parent = pivot;
+        pivotInnerSlot = std::move(ownedTop);
+        topSlot = std::move(ownedPivot);
 
-    template<class T> AvlTree<T>::AvlTree(CompareFunctor defaultCompare) : _root{std::make_shared<Node, AvlTree const &>(*this)}, _rightmost{_root}, _leftmost{_root}, _height{0U}, _DefaultCompare{defaultCompare} {
-        _root->_rightChild = std::make_shared<Node, AvlTree const &, std::weak_ptr<Node>>(*this, _root);
-        _root->_leftChild = std::make_shared<Node, AvlTree const &, std::weak_ptr<Node>>(*this, _root);
+        // _rightmost and _leftmost are lucky enough to be unaffected by rotations.
+        return pivot;
     }
 
-    template<class T> AvlTree<T>::AvlTree(AvlTree && other) noexcept
-        : _root{std::move(other._root)}
-        , _rightmost{std::move(other._rightmost)}
-        , _leftmost{std::move(other._leftmost)}
-        , _height{other._height}
-        , _DefaultCompare{std::move(other._DefaultCompare)}
-    {
-        if (!!_root) {
-            _root->BeginUpdatingTreePointer(*this);
-        }
+    template<class T, class CheckingPolicy, class StatsPolicy> typename AvlTree<T, CheckingPolicy, StatsPolicy>::Node * AvlTree<T, CheckingPolicy, StatsPolicy>::Rotate(Node * grandparent) {
+        assert(grandparent->IsImbalanced());
 
-        other._root.reset();
-        other._rightmost.reset();
-        other._leftmost.reset();
-        other._height = 0U;
-    }
+        bool isRightHeavy = grandparent->_balanceFactor > 0;
+        Node * parent = isRightHeavy ? grandparent->_rightChild.get() : grandparent->_leftChild.get();
+        assert(parent != nullptr);
 
-    template<class T> AvlTree<T> & AvlTree<T>::operator=(AvlTree && other) noexcept {
-        if (this != &other) {
-            _root = std::move(other._root);
-            _rightmost = std::move(other._rightmost);
-            _leftmost = std::move(other._leftmost);
-            _height = other._height;
-            _DefaultCompare = std::move(other._DefaultCompare);
+        if (isRightHeavy ? (parent->_balanceFactor < 0) : (parent->_balanceFactor > 0)) {
+            // It's a complex rotation (either LeftRight or RightLeft). The inner grandchild ends up on top, with the parent and grandparent as its children.
+            Node * child = isRightHeavy ? parent->_leftChild.get() : parent->_rightChild.get();
+            BalanceFactor childBalanceFactor = child->_balanceFactor;
+
+            RotateOnce(parent, !isRightHeavy);
+            RotateOnce(grandparent, isRightHeavy);
+            _stats.CountRotation(true);
 
-            if (!!_root) {
-                _root->BeginUpdatingTreePointer(*this);
+            if (isRightHeavy) {
+                grandparent->_balanceFactor = (childBalanceFactor > 0) ? -1 : 0;
+                parent->_balanceFactor = (childBalanceFactor < 0) ? 1 : 0;
+            } else {
+                grandparent->_balanceFactor = (childBalanceFactor < 0) ? 1 : 0;
+                parent->_balanceFactor = (childBalanceFactor > 0) ? -1 : 0;
             }
+
+            child->_balanceFactor = 0;
+            return child;
         }
 
-        other._root.reset();
-        other._rightmost.reset();
-        other._leftmost.reset();
-        other._height = 0U;
+        RotateOnce(grandparent, isRightHeavy);
+        _stats.CountRotation(false);
 
-        return *this;
+        // It might seem like we should never have a parent balance factor of 0, but this can happen if we're removing a node. In that case the subtree keeps its height.
+        if (parent->_balanceFactor == 0) {
+            grandparent->_balanceFactor = isRightHeavy ? 1 : -1;
+            parent->_balanceFactor = isRightHeavy ? -1 : 1;
+        } else {
+            grandparent->_balanceFactor = 0;
+            parent->_balanceFactor = 0;
+        }
+
+        return parent;
     }
 
-    template<class T> std::weak_ptr<typename AvlTree<T>::Node> AvlTree<T>::FindNodeWithData(const_reference dataToFind, CompareFunctor Compare) const {
-        std::shared_ptr<Node> node = _root;
+    template<class T, class CheckingPolicy, class StatsPolicy> bool AvlTree<T, CheckingPolicy, StatsPolicy>::Remove(iterator && nodeToRemoveItr, std::unique_ptr<value_type> & outputRemovedData) {
+        Node * nodeToRemove = nodeToRemoveItr._impl._node;
 
-        while (!(node->IsEmpty())) {
-            int comparison = Compare(dataToFind, *(node->GetData()));
+        if (!IsNodeOfTree(nodeToRemove) || nodeToRemove->IsEmpty() || nodeToRemove->_isTombstone) {
+            return false;
+        }
 
-            if (comparison == 0) {
-                return node;
-            }
+        // It's time to invalidate the passed-in iterator.
+        nodeToRemoveItr._impl._node = nullptr;
 
-            if (comparison > 0) {
-                node = node->_rightChild;
-            } else {
-                node = node->_leftChild;
+        // Let's update our _rightmost and _leftmost nodes first. An extreme node has at most one child, on the inner side.
+        // They're the extremes of the tree's shape, so tombstones count.
+        if (_rightmost == nodeToRemove) {
+            __IteratorImpl predecessor{nodeToRemove};
+            predecessor.Step(true);
+            _rightmost = predecessor._node;
+
+            // The only node has no predecessor, so the tree is about to become empty.
+            if (_rightmost == nodeToRemove) {
+                _rightmost = &_header;
             }
         }
+        if (_leftmost == nodeToRemove) {
+            __IteratorImpl successor{nodeToRemove};
+            successor.Step(false);
+            _leftmost = successor._node;
+        }
 
-        // equivalent to end()
-        return _rightmost->GetRightChild();
-    }
+        std::unique_ptr<Node> & removedSlot = GetOwningPointer(nodeToRemove);
+        std::unique_ptr<Node> ownedNodeToRemove;
+        Node * retraceFrom;
+        bool isShrunkenSideLeft;
 
-    template<class T> template<class... Args> std::pair<bool, typename AvlTree<T>::iterator> AvlTree<T>::Emplace(CompareFunctor Compare, Args&&... args) {
-        std::shared_ptr<Node> emplaced = std::make_shared<Node, AvlTree const&, std::shared_ptr<Node> const*, Args...>(*this, nullptr, std::forward<Args>(args)...);
+        if (nodeToRemove->IsRightParent() && nodeToRemove->IsLeftParent()) {
+            // With two children, the in-order neighbour on the taller side has 1 or 0 children. It's unlinked from where it is and takes over the removed node's place.
+            bool isUsingSuccessor = nodeToRemove->_balanceFactor > 0;
+            Node * replacement = isUsingSuccessor ? nodeToRemove->_rightChild.get() : nodeToRemove->_leftChild.get();
 
-        assert(!(emplaced->IsEmpty()));
-        if (emplaced->IsEmpty()) {
-            return std::make_pair(false, end());
+            while (isUsingSuccessor ? replacement->IsLeftParent() : replacement->IsRightParent()) {
+                replacement = isUsingSuccessor ? replacement->_leftChild.get() : replacement->_rightChild.get();
+            }
+
+            Node * replacementParent = replacement->_parent;
+            isShrunkenSideLeft = replacement->IsLeftChild();
+
+            std::unique_ptr<Node> & replacementSlot = GetOwningPointer(replacement);
+            std::unique_ptr<Node> ownedReplacement = std::move(replacementSlot);
+            replacementSlot = std::move(isUsingSuccessor ? replacement->_rightChild : replacement->_leftChild);
+            if (!!replacementSlot) {
+                replacementSlot->_parent = replacementParent;
+            }
+
+            replacement->_leftChild = std::move(nodeToRemove->_leftChild);
+            replacement->_rightChild = std::move(nodeToRemove->_rightChild);
+            if (!!(replacement->_leftChild)) {
+                replacement->_leftChild->_parent = replacement;
+            }
+            if (!!(replacement->_rightChild)) {
+                replacement->_rightChild->_parent = replacement;
+            }
+
+            replacement->_parent = nodeToRemove->_parent;
+            replacement->_balanceFactor = nodeToRemove->_balanceFactor;
+            replacement->_isRequestingFullTreeRebalance = nodeToRemove->_isRequestingFullTreeRebalance;
+            ownedNodeToRemove = std::move(removedSlot);
+            removedSlot = std::move(ownedReplacement);
+
+            // If the replacement was the removed node's own child, the shortened subtree now hangs directly off the replacement.
+            retraceFrom = (replacementParent == nodeToRemove) ? replacement : replacementParent;
+        } else {
+            // With 1 or 0 children, the only child (if any) simply moves up into the removed node's place.
+            retraceFrom = nodeToRemove->_parent;
+            isShrunkenSideLeft = nodeToRemove->IsLeftChild();
+
+            ownedNodeToRemove = std::move(removedSlot);
+            removedSlot = std::move(nodeToRemove->IsLeftParent() ? nodeToRemove->_leftChild : nodeToRemove->_rightChild);
+            if (!!removedSlot) {
+                removedSlot->_parent = retraceFrom;
+            }
         }
 
-        emplaced->_rightChild = std::make_shared<Node, AvlTree const&, std::weak_ptr<Node>>(*this, emplaced);
-        emplaced->_leftChild = std::make_shared<Node, AvlTree const&, std::weak_ptr<Node>>(*this, emplaced);
+        outputRemovedData = std::move(ownedNodeToRemove->_data);
+        ownedNodeToRemove.reset();
+        ++_structureVersion;
+        _stats.CountFrees(1U);
+        --_size;
 
-        if (_height == 0) {
-            assert(_root->GetData() == nullptr);
-            assert(_rightmost->GetData() == nullptr);
-            assert(_leftmost->GetData() == nullptr);
+        if (_isRelaxed) {
+            MarkForRebalance(retraceFrom);
+        } else {
+            RetraceAfterRemoval(retraceFrom, isShrunkenSideLeft);
+        }
 
-            _root->ReleaseChildren(false);
-            _root = emplaced;
-            _rightmost = _root;
-            _leftmost = _root;
-            _height = 1U;
+        return true;
+    }
 
-            return std::make_pair(true, iterator{*this, _root});
+    template<class T, class CheckingPolicy, class StatsPolicy> bool AvlTree<T, CheckingPolicy, StatsPolicy>::Remove(iterator && nodeToRemoveItr) {
+        if (!_isRelaxed) {
+            std::unique_ptr<value_type> _;
+            return Remove(std::move(nodeToRemoveItr), _);
         }
 
-        std::shared_ptr<Node> current = _root;
-        assert(!(current->IsEmpty()));
-        assert(!(current->_parent));
+        Node * nodeToRemove = nodeToRemoveItr._impl._node;
 
-        Height heightEmplacedAt = 1U;
+        if (!IsNodeOfTree(nodeToRemove) || nodeToRemove->IsEmpty() || nodeToRemove->_isTombstone) {
+            return false;
+        }
 
-        while (!(current->IsEmpty())) {
-            int comparison = Compare(*(emplaced->GetData()), *(current->GetData()));
+        nodeToRemoveItr._impl._node = nullptr;
 
-            if (comparison == 0) {
-                return std::make_pair(false, iterator{*this, current});
-            }
+        // The node stays put to keep guiding searches until Rebalance purges it.
+        nodeToRemove->_isTombstone = true;
+        MarkForRebalance(nodeToRemove);
+        --_size;
+        ++_tombstoneCount;
 
-            current = (comparison > 0) ? current->_rightChild : current->_leftChild;
-            ++heightEmplacedAt;
+        // Removes of keys that never come back would otherwise pile tombstones up without end. Purging once they outnumber the elements
+        // keeps the tree at most twice its size, and spreads each purge over the removes that made it necessary.
+        if (_tombstoneCount > _size) {
+            Rebalance();
         }
 
-        assert(!!(current->_parent));
-        bool isLeftChild = current->IsLeftChild();
-        current = current->_parent;
+        return true;
+    }
 
-        if (isLeftChild) {
-            current->_leftChild = emplaced;
+    template<class T, class CheckingPolicy, class StatsPolicy> void AvlTree<T, CheckingPolicy, StatsPolicy>::RetraceAfterRemoval(Node * current, bool isShrunkenSideLeft) {
+        Height length = 0U;
 
-            if (_leftmost == current) {
-                _leftmost = emplaced;
-            }
-        } else {
-            current->_rightChild = emplaced;
+        while (current != &_header) {
+            current->_balanceFactor += isShrunkenSideLeft ? 1 : -1;
+            ++length;
 
-            if (_rightmost == current) {
-                _rightmost = emplaced;
+            if ((current->_balanceFactor == LEFT_MAX) || (current->_balanceFactor == RIGHT_MAX)) {
+                // The node was balanced before, so it still has its other child and its height is unaffected.
+                _stats.CountRetrace(length);
+                return;
             }
-        }
 
-        emplaced->_parent = current;
-        bool previousIsLeftChild = isLeftChild;
-
-        bool isNotRotated = true;
-        do {
-            BalanceFactor currentBalanceFactor = current->_balanceFactor + (previousIsLeftChild ? -1 : 1);
-            current->_balanceFactor = currentBalanceFactor;
             if (current->IsImbalanced()) {
-                if (Rotate(current)) {
-                    isNotRotated = false;
-
-                    assert(heightEmplacedAt > 0U);
-                    --heightEmplacedAt;
+                current = Rotate(current);
 
-                    break;
-                } else {
-                    throw std::exception{"Bad rotation in Emplace!"};
+                // Unlike with Emplace, a rotation after a removal usually shortens the subtree, so we may have to keep going. If the new top isn't balanced, the height held and we're done.
+                if (current->_balanceFactor != 0) {
+                    _stats.CountRetrace(length);
+                    return;
                 }
-            } else if (currentBalanceFactor == 0) {
-                // If our parent's balance factor got set to 0 as a result of this insertion, we don't need to update any more balance factors because the parent is now balanced.
-                break;
             }
 
-            previousIsLeftChild = current->IsLeftChild();
+            // This subtree lost a row of height, which its parent has to account for.
+            isShrunkenSideLeft = current->IsLeftChild();
             current = current->_parent;
-        } while (!!current);
+        }
 
-        _height = std::max(_height, heightEmplacedAt);
-        return std::make_pair(true, iterator{*this, emplaced});
+        // The shrinkage made it all the way past the root.
+        assert(_height > 0U);
+        --_height;
+        _stats.CountRetrace(length);
     }
 
-    template<class T> bool AvlTree<T>::Rotate(std::weak_ptr<Node> grandparentWeakptr, SubtreeHeightMap & subtreeHeightMap) {
-        if (grandparentWeakptr.expired()) {
-            return false;
+    template<class T, class CheckingPolicy, class StatsPolicy> typename AvlTree<T, CheckingPolicy, StatsPolicy>::Node * AvlTree<T, CheckingPolicy, StatsPolicy>::SkipTombstones(Node * node) {
+        __IteratorImpl impl{node};
+
+        if ((node != nullptr) && node->_isTombstone) {
+            impl.TraverseRight();
         }
 
-        std::shared_ptr<Node> grandparent = grandparentWeakptr.lock();
+        return impl._node;
+    }
 
-        if (!(grandparent->IsImbalanced())) {
-            return false;
+    template<class T, class CheckingPolicy, class StatsPolicy> AvlTreeStats AvlTree<T, CheckingPolicy, StatsPolicy>::GetStats() const requires StatsPolicy::IS_COUNTING {
+        AvlTreeStats stats = _stats.stats;
+        std::size_t nodeCount = _size + _tombstoneCount;
+
+        stats.height = _height;
+        stats.idealHeight = FindPerfectHeight(_size);
+        stats.memoryFootprint = sizeof(AvlTree) + (nodeCount * sizeof(Node)) + (nodeCount * sizeof(T));
+        return stats;
+    }
+
+    template<class T, class CheckingPolicy, class StatsPolicy> void AvlTree<T, CheckingPolicy, StatsPolicy>::SetRelaxedBalancing(bool isRelaxed) {
+        if (_isRelaxed && !isRelaxed) {
+            Rebalance();
         }
 
-        bool isUpperRotationLeft = grandparent->_balanceFactor < 0;
+        _isRelaxed = isRelaxed;
+    }
 
-        assert(isUpperRotationLeft ? grandparent->IsLeftParent() : grandparent->IsRightParent());
-        if (isUpperRotationLeft ? !(grandparent->IsLeftParent()) : !(grandparent->IsRightParent())) {
-            return false;
+    template<class T, class CheckingPolicy, class StatsPolicy> void AvlTree<T, CheckingPolicy, StatsPolicy>::MarkForRebalance(Node * node) {
+        // Once we reach a marked node, everything above it is already marked.
+        for (; (node != &_header) && !(node->_isRequestingFullTreeRebalance); node = node->_parent) {
+            node->_isRequestingFullTreeRebalance = true;
         }
+    }
 
-        std::shared_ptr<Node> parent = isUpperRotationLeft ? grandparent->_leftChild : grandparent->_rightChild;
+    template<class T, class CheckingPolicy, class StatsPolicy> void AvlTree<T, CheckingPolicy, StatsPolicy>::Rebalance() {
+        _height = ResolveSubtree(_header._leftChild);
+        ++_structureVersion;
+        assert(_tombstoneCount == 0U);
 
-        // It might seem like we should never have a parent balance factor of 0, but this can happen if we're removing a node.
-        bool isLowerRotationLeft = (parent->_balanceFactor == 0) ? isUpperRotationLeft : (parent->_balanceFactor < 0);
+        // Purged tombstones may have been the extremes.
+        FindExtremes();
+    }
 
-        assert(isLowerRotationLeft ? parent->IsLeftParent() : parent->IsRightParent());
-        if (isLowerRotationLeft ? !(parent->IsLeftParent()) : !(parent->IsRightParent())) {
-            return false;
+    template<class T, class CheckingPolicy, class StatsPolicy> void AvlTree<T, CheckingPolicy, StatsPolicy>::FindExtremes() {
+        _leftmost = &_header;
+        while (_leftmost->IsLeftParent()) {
+            _leftmost = _leftmost->_leftChild.get();
+        }
+
+        _rightmost = _header._leftChild ? _header._leftChild.get() : &_header;
+        while (_rightmost->IsRightParent()) {
+            _rightmost = _rightmost->_rightChild.get();
         }
+    }
 
-        std::shared_ptr<Node> child = isLowerRotationLeft ? parent->_leftChild : parent->_rightChild;
+    template<class T, class CheckingPolicy, class StatsPolicy> typename AvlTree<T, CheckingPolicy, StatsPolicy>::Height AvlTree<T, CheckingPolicy, StatsPolicy>::ResolveSubtree(std::unique_ptr<Node> & subtree) {
+        Node * node = subtree.get();
 
-        if (isUpperRotationLeft != isLowerRotationLeft) {
-            // It's a complex rotation (either LeftRight or RightLeft). Our approach will be to resolve the complexity now and finish with the simple rotation algorithm later.
+        if (node == nullptr) {
+            return 0U;
+        }
 
-            // Sanity check, neither `parent` nor `child` should be the root node. It should be impossible for that to happen since we have a grandparent.
-            assert(_root != parent);
-            assert(_root != child);
-            if ((_root == parent) || (_root == child)) {
-                return false;
+        if (!(node->_isRequestingFullTreeRebalance)) {
+            return FindBalancedHeight(node);
+        }
+
+        Height leftHeight = ResolveSubtree(node->_leftChild);
+        Height rightHeight = ResolveSubtree(node->_rightChild);
+
+        if (node->_isTombstone && !(node->IsLeftParent() && node->IsRightParent())) {
+            // With 1 or 0 children, the only child (if any) simply moves up into the tombstone's place.
+            std::unique_ptr<Node> ownedTombstone = std::move(subtree);
+            subtree = std::move(ownedTombstone->IsLeftParent() ? ownedTombstone->_leftChild : ownedTombstone->_rightChild);
+            if (!!subtree) {
+                subtree->_parent = ownedTombstone->_parent;
             }
 
-            // Invalidate the subtree heights of every node which will be affected by the following moves.
-            child->RemoveFromSubtreeHeightMap(subtreeHeightMap, true);
+            --_tombstoneCount;
+            _stats.CountFrees(1U);
+            return std::max(leftHeight, rightHeight);
+        }
 
-            // In each case, the child must become the parent, and the parent must become the child.
-            if (isLowerRotationLeft) {
+        if (node->_isTombstone || (leftHeight > rightHeight + 1U) || (rightHeight > leftHeight + 1U)) {
+            return RebuildSubtree(subtree);
+        }
 
-                parent->_leftChild = child->_rightChild;
-                parent->_leftChild->_parent = parent;
+        node->_balanceFactor = (rightHeight > leftHeight) ? RIGHT_MAX : ((leftHeight > rightHeight) ? LEFT_MAX : 0);
+        node->_isRequestingFullTreeRebalance = false;
+        return 1U + std::max(leftHeight, rightHeight);
+    }
 
-                if (parent->IsRightChild()) {
-                    parent->_parent->_rightChild = child;
-                } else { // parent->IsLeftChild() is true, because we're not the root node.
-                    assert(parent->IsLeftChild());
-                    parent->_parent->_leftChild = child;
-                }
+    template<class T, class CheckingPolicy, class StatsPolicy> typename AvlTree<T, CheckingPolicy, StatsPolicy>::Height AvlTree<T, CheckingPolicy, StatsPolicy>::RebuildSubtree(std::unique_ptr<Node> & subtree) {
+        Node * parent = subtree->_parent;
+        std::vector<std::unique_ptr<Node>> nodes;
+        UnlinkInOrder(subtree, nodes);
+
+        subtree = LinkBalanced(nodes, 0U, nodes.size(), parent);
+        return FindPerfectHeight(nodes.size());
+    }
 
-                child->_parent = parent->_parent;
-                child->_rightChild = parent;
-                child->_rightChild->_parent = child;
+    template<class T, class CheckingPolicy, class StatsPolicy> void AvlTree<T, CheckingPolicy, StatsPolicy>::UnlinkInOrder(std::unique_ptr<Node> & subtree, std::vector<std::unique_ptr<Node>> & nodes) {
+        // The same way Clear does it, by rotating left children up until there are none.
+        std::unique_ptr<Node> current = std::move(subtree);
+
+        while (!!current) {
+            if (current->IsLeftParent()) {
+                std::unique_ptr<Node> leftChild = std::move(current->_leftChild);
+                current->_leftChild = std::move(leftChild->_rightChild);
+                leftChild->_rightChild = std::move(current);
+                current = std::move(leftChild);
             } else {
-                parent->_rightChild = child->_leftChild;
-                parent->_rightChild->_parent = parent;
-
-                if (parent->IsRightChild()) {
-                    parent->_parent->_rightChild = child;
-                } else { // parent->IsLeftChild() is true, because we're not the root node.
-                    assert(parent->IsLeftChild());
-                    parent->_parent->_leftChild = child;
+                std::unique_ptr<Node> next = std::move(current->_rightChild);
+
+                if (current->_isTombstone) {
+                    --_tombstoneCount;
+                    _stats.CountFrees(1U);
+                } else {
+                    nodes.push_back(std::move(current));
                 }
 
-                child->_parent = parent->_parent;
-                child->_leftChild = parent;
-                child->_leftChild->_parent = child;
+                current = std::move(next);
             }
+        }
+    }
 
-            child = parent;
-            parent = child->_parent;
+    template<class T, class CheckingPolicy, class StatsPolicy> std::unique_ptr<typename AvlTree<T, CheckingPolicy, StatsPolicy>::Node> AvlTree<T, CheckingPolicy, StatsPolicy>::LinkBalanced(std::vector<std::unique_ptr<Node>> & nodes, std::size_t first, std::size_t last, Node * parent) {
+        if (first == last) {
+            return nullptr;
+        }
 
-            // This is the only time we need to change the balance factor of the new child.
-            Height childRightChildHeight = child->_rightChild->FindHeight(subtreeHeightMap);
-            Height childLeftChildHeight = child->_leftChild->FindHeight(subtreeHeightMap);
-            if (childRightChildHeight == childLeftChildHeight) {
-                child->_balanceFactor = 0;
-            } else {
-                child->_balanceFactor = (childRightChildHeight > childLeftChildHeight) ? 1 : -1;
-            }
+        // The left half gets the extra node, if there is one, so no balance factor is ever positive.
+        std::size_t middle = first + ((last - first) / 2U);
+        std::unique_ptr<Node> node = std::move(nodes[middle]);
+
+        node->_parent = parent;
+        node->_leftChild = LinkBalanced(nodes, first, middle, node.get());
+        node->_rightChild = LinkBalanced(nodes, middle + 1U, last, node.get());
+        node->_balanceFactor = (FindPerfectHeight(middle - first) > FindPerfectHeight(last - middle - 1U)) ? LEFT_MAX : 0;
+        node->_isRequestingFullTreeRebalance = false;
+        return node;
+    }
 
-            // The new parent's balance factor will be accounted for in the next section.
+    template<class T, class CheckingPolicy, class StatsPolicy> typename AvlTree<T, CheckingPolicy, StatsPolicy>::Height AvlTree<T, CheckingPolicy, StatsPolicy>::FindBalancedHeight(Node const * node) {
+        Height height = 0U;
+
+        for (; node != nullptr; ++height) {
+            node = (node->_balanceFactor > 0) ? node->_rightChild.get() : node->_leftChild.get();
         }
 
-        // Invalidate the subtree heights of every node which will be affected by the following moves.
-        parent->RemoveFromSubtreeHeightMap(subtreeHeightMap, true);
+        return height;
+    }
 
-        // The parent must now become the parent of the grandparent.
-        if (isUpperRotationLeft) {
-            grandparent->_leftChild = parent->_rightChild;
-            grandparent->_leftChild->_parent = grandparent;
+    template<class T, class CheckingPolicy, class StatsPolicy> void AvlTree<T, CheckingPolicy, StatsPolicy>::Reorder(CompareFunctor newDefault, std::vector<std::unique_ptr<value_type>> & outputDuplicates, WorkStealingPool & pool) {
+        // Every comparison is made on pointers to the nodes, before the tree is touched, so if one throws or the sort runs out of memory, the tree is as it was.
+        std::vector<Node *> sorted;
+        sorted.reserve(_size);
 
-            if (grandparent->IsRightChild()) {
-                grandparent->_parent->_rightChild = parent;
-            } else if (grandparent->IsLeftChild()) {
-                grandparent->_parent->_leftChild = parent;
+        for (iterator itr = begin(); itr != end(); ++itr) {
+            sorted.push_back(itr._impl._node);
+        }
+
+        // The sort may run on several threads, so its comparisons are tallied on their own and only counted once it's done.
+        std::atomic<std::uint64_t> sortComparisons{0U};
+        auto isBefore = [&newDefault, &sortComparisons](Node const * a, Node const * b) {
+            if constexpr (StatsPolicy::IS_COUNTING) {
+                sortComparisons.fetch_add(1U, std::memory_order_relaxed);
             }
 
-            parent->_parent = grandparent->_parent;
-            parent->_rightChild = grandparent;
-            parent->_rightChild->_parent = parent;
+            return newDefault(*(a->GetData()), *(b->GetData())) < 0;
+        };
+
+        if (sorted.size() >= PARALLEL_SORT_THRESHOLD) {
+            SortInParallel(sorted, isBefore, pool);
         } else {
-            grandparent->_rightChild = parent->_leftChild;
-            grandparent->_rightChild->_parent = grandparent;
+            std::stable_sort(sorted.begin(), sorted.end(), isBefore);
+        }
 
-            if (grandparent->IsRightChild()) {
-                grandparent->_parent->_rightChild = parent;
-            } else if (grandparent->IsLeftChild()) {
-                grandparent->_parent->_leftChild = parent;
-            }
+        _stats.CountComparisons(sortComparisons.load(std::memory_order_relaxed));
+
+        std::vector<Node *> duplicates;
+        std::size_t keptCount = 0U;
 
-            parent->_parent = grandparent->_parent;
-            parent->_leftChild = grandparent;
-            parent->_leftChild->_parent = parent;
+        for (std::size_t i = 0U; i < sorted.size(); ++i) {
+            if ((keptCount > 0U) && (CountedCompare(newDefault, *(sorted[keptCount - 1U]->GetData()), *(sorted[i]->GetData())) == 0)) {
+                duplicates.push_back(sorted[i]);
+            } else {
+                sorted[keptCount++] = sorted[i];
+            }
         }
 
-        // Update the root node if we need to. _rightmost and _leftmost are lucky enough to be unaffected by rotations.
-        if (_root == grandparent) {
-            _root = parent;
+        sorted.resize(keptCount);
+        outputDuplicates.reserve(outputDuplicates.size() + duplicates.size());
+        std::vector<std::unique_ptr<Node>> nodes;
+        nodes.reserve(_size);
+
+        // Nothing past here can throw. The nodes come apart in the old order, so they're let go of and taken back in the new one.
+        UnlinkInOrder(_header._leftChild, nodes);
+
+        for (std::unique_ptr<Node> & node : nodes) {
+            (void)node.release();
         }
 
-        // The parent and grandparent balance factors get accounted for in the same way.
-        Height parentRightChildHeight = parent->_rightChild->FindHeight(subtreeHeightMap);
-        Height parentLeftChildHeight = parent->_leftChild->FindHeight(subtreeHeightMap);
-        if (parentRightChildHeight == parentLeftChildHeight) {
-            parent->_balanceFactor = 0;
-        } else {
-            parent->_balanceFactor = (parentRightChildHeight > parentLeftChildHeight) ? 1 : -1;
+        for (Node * duplicate : duplicates) {
+            std::unique_ptr<Node> freed{duplicate};
+            outputDuplicates.push_back(std::move(freed->_data));
         }
 
-        Height grandparentRightChildHeight = grandparent->_rightChild->FindHeight(subtreeHeightMap);
-        Height grandparentLeftChildHeight = grandparent->_leftChild->FindHeight(subtreeHeightMap);
-        if (grandparentRightChildHeight == grandparentLeftChildHeight) {
-            grandparent->_balanceFactor = 0;
-        } else {
-            grandparent->_balanceFactor = (grandparentRightChildHeight > grandparentLeftChildHeight) ? 1 : -1;
+        _stats.CountFrees(duplicates.size());
+        nodes.resize(keptCount);
+
+        for (std::size_t i = 0U; i < keptCount; ++i) {
+            nodes[i].reset(sorted[i]);
         }
 
-        return true;
+        _header._leftChild = LinkBalanced(nodes, 0U, keptCount, &_header);
+        _DefaultCompare.swap(newDefault);
+        _height = FindPerfectHeight(keptCount);
+        _size = keptCount;
+        ++_structureVersion;
+        assert(_tombstoneCount == 0U);
+        FindExtremes();
     }
 
-    template<class T> bool AvlTree<T>::Remove(iterator && nodeToRemoveItr, std::unique_ptr<value_type> & outputRemovedData) {
-        if ((nodeToRemoveItr._impl._tree != this) || (nodeToRemoveItr._impl._node.expired())) {
-            return false;
-        }
+    template<class T, class CheckingPolicy, class StatsPolicy> template<class Codec> void AvlTree<T, CheckingPolicy, StatsPolicy>::Save(std::ostream & stream, Codec const & codec) const {
+        ChecksummingOutputBuffer buffer{*(stream.rdbuf())};
+        std::ostream checksummed{&buffer};
 
-        std::shared_ptr<Node> nodeToRemove = nodeToRemoveItr._impl._node.lock();
+        WriteLittleEndian(checksummed, SERIALIZED_TREE_MAGIC, 4U);
+        WriteLittleEndian(checksummed, SERIALIZED_TREE_VERSION, 4U);
+        WriteLittleEndian(checksummed, _size, 8U);
 
-        if (!nodeToRemove || (nodeToRemove->_tree != this) || nodeToRemove->IsEmpty()) {
-            return false;
+        for (const_reference element : *this) {
+            codec.Encode(checksummed, element);
+        }
+
+        if (!checksummed) {
+            throw std::runtime_error{"Failed to save tree!"};
         }
 
-        // We still might need a iterator, but now it's time to invalidate the passed-in iterator.
-        iterator movedNodeToRemoveItr{std::move(nodeToRemoveItr)};
+        WriteLittleEndian(stream, buffer.GetChecksum(), 8U);
+    }
 
-        // It's also time to move the data to the output variable. We'll still keep the node intact for now, but it won't have any data anymore.
-        outputRemovedData = std::move(nodeToRemove->_data);
+    template<class T, class CheckingPolicy, class StatsPolicy> template<class Codec> void AvlTree<T, CheckingPolicy, StatsPolicy>::Load(std::istream & stream, Codec const & codec) {
+        ChecksummingInputBuffer buffer{*(stream.rdbuf())};
+        std::istream checksummed{&buffer};
 
-        // Let's also update our _rightmost and _leftmost nodes while we're at it.
-        if (_rightmost == nodeToRemove) {
-            assert(!(_rightmost->IsRightParent()));
-            _rightmost = _rightmost->IsLeftParent() ? _rightmost->_leftChild : _rightmost->_parent;
+        if (ReadLittleEndian(checksummed, 4U) != SERIALIZED_TREE_MAGIC) {
+            throw std::runtime_error{"Not a saved tree!"};
         }
-        if (_leftmost == nodeToRemove) {
-            assert(!(_leftmost->IsLeftParent()));
-            _leftmost = _leftmost->IsRightParent() ? _leftmost->_rightChild : _leftmost->_parent;
+
+        if (ReadLittleEndian(checksummed, 4U) != SERIALIZED_TREE_VERSION) {
+            throw std::runtime_error{"Saved tree is from an unsupported version!"};
         }
 
-        // If we have both a right and left child, use the iterator to find a node with 1 or 0 children, then swap data with that node and delete it.
-        if (nodeToRemove->IsRightParent() && nodeToRemove->IsLeftParent()) {
-            // Since we're a node with a right and left child, traversing once in either direction is guaranteed to get us a node with 1 or 0 children.
-            if (nodeToRemove->GetBalanceFactor() > 0) {
-                ++movedNodeToRemoveItr;
-            } else {
-                --movedNodeToRemoveItr;
-            }
+        std::uint64_t count = ReadLittleEndian(checksummed, 8U);
+        std::vector<std::unique_ptr<Node>> nodes;
 
-            assert(!(movedNodeToRemoveItr._impl._node.expired()));
-            std::shared_ptr<Node> nodeToSwap = movedNodeToRemoveItr._impl._node.lock();
-            assert(!!nodeToSwap && !(nodeToSwap->IsEmpty()));
-            assert(!(nodeToSwap->IsRightParent()) || !(nodeToSwap->IsLeftParent()));
+        for (std::uint64_t i = 0U; i < count; ++i) {
+            nodes.push_back(std::make_unique<Node>(nullptr, codec.Decode(checksummed)));
 
-            // move the data into the current "node to remove" - we're actually going to remove the node we found with the iterator.
-            nodeToRemove->_data = std::move(nodeToSwap->_data);
-            nodeToRemove = nodeToSwap;
+            if (!checksummed) {
+                throw std::runtime_error{"Saved tree ended early!"};
+            }
         }
 
-        // By this point we should be looking at a node that has 1 or 0 children.
-        assert(!(nodeToRemove->IsRightParent()) || !(nodeToRemove->IsLeftParent()));
+        if (ReadLittleEndian(stream, 8U) != buffer.GetChecksum()) {
+            throw std::runtime_error{"Saved tree is corrupt!"};
+        }
 
-        // One child will stay in the tree, the other will be released.
-        std::shared_ptr<Node> child = nodeToRemove->IsLeftParent() ? nodeToRemove->_leftChild : nodeToRemove->_rightChild;
-        std::shared_ptr<Node> parent = nodeToRemove->_parent;
+        // Only now that everything has been read is it safe to let go of what we had.
+        Clear();
 
-        // Even if the child is empty, it shouldn't be null.
-        assert(!!child);
+        _header._leftChild = LinkBalanced(nodes, 0U, nodes.size(), &_header);
+        _height = FindPerfectHeight(nodes.size());
+        _size = nodes.size();
+        _stats.CountAllocations(_size);
+        FindExtremes();
+    }
 
-        if (_root == nodeToRemove) {
-            assert(!parent);
+    template<class T, class CheckingPolicy, class StatsPolicy> template<class IsBefore> void AvlTree<T, CheckingPolicy, StatsPolicy>::SortInParallel(std::vector<Node *> & nodes, IsBefore const & isBefore, WorkStealingPool & pool) {
+        std::size_t const size = nodes.size();
+        std::size_t const runLength = (size + pool.GetThreadCount() - 1U) / pool.GetThreadCount();
+        auto at = [&nodes, size](std::size_t position) { return nodes.begin() + static_cast<std::ptrdiff_t>(std::min(position, size)); };
 
-            // We just established `nodeToRemove` has 1 or 0 children. If it's the root node, that means our tree only has 1 or 2 elements in it.
-            if (child->IsEmpty()) {
-                // If the child is empty, we're the only element in the tree. Reset all pointers.
-                assert(_height == 1U);
-                _root->ReleaseChildren(true);
-                _root->_data.reset();
-                _rightmost = _root;
-                _leftmost = _root;
-                _height = 0U;
-            } else {
-                // If the child is not empty, it will now become the only element in the tree. Update all pointers.
-                assert(_height == 2U);
-                _rightmost = child;
-                _leftmost = child;
-                child->_parent = _root->_parent;
-                _root->_rightChild.reset(); // Reminder: All we're doing here is reseting the *removed node's* reference to its children. This should not, in any way, affect `child`, or the new root.
-                _root->_leftChild.reset(); // Reminder: All we're doing here is reseting the *removed node's* reference to its children. This should not, in any way, affect `child`, or the new root.
-                _root = child;
-                _height = 1U;
+        {
+            WorkStealingPool::TaskGroup group{pool};
+
+            for (std::size_t first = 0U; first < size; first += runLength) {
+                group.Run([&at, &isBefore, first, runLength]() { std::stable_sort(at(first), at(first + runLength), isBefore); });
             }
 
-            return true;
+            group.Wait();
         }
 
-        // Now we've established we're not removing the root node. Therefore, we must have a parent.
-        assert(!!parent);
+        for (std::size_t width = runLength; width < size; width *= 2U) {
+            WorkStealingPool::TaskGroup group{pool};
 
-        // The child's parent should become the removed node's parent, and the parent's child should become this child.
-        child->_parent = parent;
+            for (std::size_t first = 0U; first + width < size; first += 2U * width) {
+                group.Run([&at, &isBefore, first, width]() { std::inplace_merge(at(first), at(first + width), at(first + (2U * width)), isBefore); });
+            }
 
-        bool isRemovedNodeLeftChild = nodeToRemove->IsLeftChild();
-        if (isRemovedNodeLeftChild) {
-            parent->_leftChild = child;
-        } else {
-            parent->_rightChild = child;
-        }
-
-        // Now let's reset this node's child references (again, shouldn't affect the nodes themselves), and then finally reset this node.
-        nodeToRemove->_tree = nullptr;
-        // No need to reset _data, it was already reset with the move operation earlier.
-        nodeToRemove->_parent.reset();
-        nodeToRemove->_rightChild.reset();
-        nodeToRemove->_leftChild.reset();
-        nodeToRemove.reset();
-
-        // The last step is to deal with balance factor and height. We just deleted a row in a branch of a subtree, so we at least need to update the immediate parent's balance factor.
-        SubtreeHeightMap subtreeHeightMap;
-        bool previousIsLeftChild = isRemovedNodeLeftChild;
-        for (std::shared_ptr<Node> current = std::move(parent); !!current; current = current->_parent) {
-            if (current->_balanceFactor == static_cast<BalanceFactor>(0)) {
-                // If the current node was at 0 before making adjustments, then we're done. We know this node is not a leaf node, so this can only mean it has another child.
-                // Therefore, the tree's height is unaffected, and we can early return.
-                current->_balanceFactor = previousIsLeftChild ? 1 : -1;
-                return true;
+            group.Wait();
+        }
+    }
+
+    template<class T, class CheckingPolicy, class StatsPolicy> std::vector<typename AvlTree<T, CheckingPolicy, StatsPolicy>::Node *> AvlTree<T, CheckingPolicy, StatsPolicy>::FindChunkStarts(std::size_t targetChunkCount) const {
+        std::vector<Node *> chunkStarts;
+
+        if (IsEmpty()) {
+            return chunkStarts;
+        }
+
+        // There are at most 2^depth subtrees at a given depth. In an AVL tree they are all within a small factor of each other in size.
+        std::size_t chunkDepth = 0U;
+        while ((std::size_t{1U} << chunkDepth) < targetChunkCount) {
+            ++chunkDepth;
+        }
+
+        // The nodes above chunkDepth belong to the chunk just before them, so each chunk runs from its subtree's leftmost node up to the next chunk's.
+        // When the leftmost path is shorter than chunkDepth, no subtree starts at the leftmost node, so it's added up front.
+        chunkStarts.push_back(_leftmost);
+
+        std::vector<std::pair<Node *, std::size_t>> stack{{_header._leftChild.get(), 0U}};
+
+        while (!stack.empty()) {
+            auto [node, depth] = stack.back();
+            stack.pop_back();
+
+            if (depth == chunkDepth) {
+                Node * leftmost = node;
+
+                while (leftmost->IsLeftParent()) {
+                    leftmost = leftmost->_leftChild.get();
+                }
+
+                if (leftmost != chunkStarts.back()) {
+                    chunkStarts.push_back(leftmost);
+                }
+
+                continue;
             }
 
-            current->_balanceFactor += previousIsLeftChild ? 1 : -1;
+            // Right first, so the left subtree comes off the stack first and the starts stay in order.
+            if (node->IsRightParent()) {
+                stack.emplace_back(node->_rightChild.get(), depth + 1U);
+            }
 
-            if (current->IsImbalanced()) {
-                // Record the current height of current. If we have a different height after rotation, we need to keep going.
-                Height oldCurrentHeight = current->FindHeight(subtreeHeightMap);
-
-                if (Rotate(current, subtreeHeightMap)) {
-                    // Unlike with Emplace, we may have to keep going even after rotating once.
-                    // Remember, whenever we rotate, the "grandparent" (the node we started the rotation from) is now the child of its former child.
-                    // Let's go straight to our new parent so we don't end up with screwy balance factors.
-                    current = current->_parent;
-
-                    // We could've just rotated the root node, so make sure we're not about to dereference null. If we would, we're done, so early break.
-                    if (!current) {
-                        break;
-                    }
-
-                    // Now, we compare the current height with the height before rotation. MOST of the time the height has changed, but if it hasn't, there's no need to keep going, we're done.
-                    Height newCurrentHeight = current->FindHeight(subtreeHeightMap);
-                    if (newCurrentHeight == oldCurrentHeight) {
-                        break;
-                    }
-
-                    // If we've somehow increased height after a rotation, that's Bad News (TM).
-                    assert(newCurrentHeight < oldCurrentHeight);
-                    if (newCurrentHeight > oldCurrentHeight) {
-                        throw std::exception{"Increased height after rotation, what's going on???"};
-                    }
-                } else {
-                    throw std::exception{"Bad rotate in Remove!"};
+            if (node->IsLeftParent()) {
+                stack.emplace_back(node->_leftChild.get(), depth + 1U);
+            }
+        }
+
+        // A chunk can't start on a tombstone. Skipping ahead keeps the starts in order, but chunks made up of nothing but tombstones go away.
+        if (_tombstoneCount > 0U) {
+            std::vector<Node *> liveChunkStarts;
+
+            for (Node * chunkStart : chunkStarts) {
+                Node * liveChunkStart = SkipTombstones(chunkStart);
+
+                if ((liveChunkStart != &_header) && (liveChunkStarts.empty() || (liveChunkStarts.back() != liveChunkStart))) {
+                    liveChunkStarts.push_back(liveChunkStart);
                 }
             }
 
-            previousIsLeftChild = current->IsLeftChild();
+            chunkStarts.swap(liveChunkStarts);
         }
 
-        // If by the end of all of this, the root node's balance factor is 0, then we must've lost a row of height.
-        if (_root->_balanceFactor == 0) {
-            assert(_height > 0U);
-            --_height;
+        return chunkStarts;
+    }
+
+    template<class T, class CheckingPolicy, class StatsPolicy> template<class ChunkVisitor> void AvlTree<T, CheckingPolicy, StatsPolicy>::RunChunks(std::vector<Node *> const & chunkStarts, ChunkVisitor & visitor, WorkStealingPool & pool) const {
+        WorkStealingPool::TaskGroup group{pool};
+
+        for (std::size_t i = 0U; i < chunkStarts.size(); ++i) {
+            Node * first = chunkStarts[i];
+            Node * last = (i + 1U < chunkStarts.size()) ? chunkStarts[i + 1U] : &_header;
+
+            group.Run([&visitor, i, first, last]() { visitor(i, const_iterator{first}, const_iterator{last}); });
         }
 
-        return true;
+        group.Wait();
+    }
+
+    template<class T, class CheckingPolicy, class StatsPolicy> template<class ChunkVisitor> std::size_t AvlTree<T, CheckingPolicy, StatsPolicy>::ParallelForEachChunk(ChunkVisitor && visitor, WorkStealingPool & pool) const {
+        std::vector<Node *> chunkStarts = FindChunkStarts(pool.GetThreadCount() * CHUNKS_PER_THREAD);
+        RunChunks(chunkStarts, visitor, pool);
+        return chunkStarts.size();
+    }
+
+    template<class T, class CheckingPolicy, class StatsPolicy> template<class Visitor> void AvlTree<T, CheckingPolicy, StatsPolicy>::ParallelForEach(Visitor && visitor, WorkStealingPool & pool) const {
+        ParallelForEachChunk([&visitor](std::size_t, const_iterator first, const_iterator last) {
+            for (; first != last; ++first) {
+                visitor(*first);
+            }
+        }, pool);
+    }
+
+    template<class T, class CheckingPolicy, class StatsPolicy> template<class Result, class Map, class Combine> Result AvlTree<T, CheckingPolicy, StatsPolicy>::ParallelReduce(Result identity, Map && map, Combine && combine, WorkStealingPool & pool) const {
+        std::vector<Node *> chunkStarts = FindChunkStarts(pool.GetThreadCount() * CHUNKS_PER_THREAD);
+        // optional rather than Result itself, so that a Result of bool doesn't land us in vector<bool>, whose elements can't be written from different threads.
+        std::vector<std::optional<Result>> chunkResults(chunkStarts.size());
+
+        auto reduceChunk = [&](std::size_t chunkIndex, const_iterator first, const_iterator last) {
+            Result result = identity;
+
+            for (; first != last; ++first) {
+                result = combine(std::move(result), map(*first));
+            }
+
+            chunkResults[chunkIndex].emplace(std::move(result));
+        };
+
+        RunChunks(chunkStarts, reduceChunk, pool);
+
+        Result result = std::move(identity);
+
+        for (std::optional<Result> & chunkResult : chunkResults) {
+            result = combine(std::move(result), std::move(*chunkResult));
+        }
+
+        return result;
     }
 }
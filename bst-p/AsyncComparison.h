@@ -0,0 +1,117 @@
+#pragma once
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace BST_P {
+    /*
+     * What an AvlTree's async compare functor returns: a comparison that's either answered already, or will be once whoever schedules the questions gets to it.
+     * Awaiting one that isn't answered suspends the awaiting coroutine until Answer is called, which resumes it right there, inside Answer.
+     * Copies share one answer, so a scheduler keeps a copy of each comparison it hands out and answers that.
+     */
+    class AsyncComparison final {
+    public:
+        // Not answered yet.
+        inline AsyncComparison() : _state{std::make_shared<State>()} {}
+        // Already answered, so awaiting it never suspends.
+        inline explicit AsyncComparison(int comparison) : AsyncComparison() { _state->comparison = comparison; }
+        inline AsyncComparison(AsyncComparison const &) = default;
+        inline AsyncComparison(AsyncComparison &&) noexcept = default;
+        inline AsyncComparison & operator=(AsyncComparison const &) = default;
+        inline AsyncComparison & operator=(AsyncComparison &&) noexcept = default;
+        inline ~AsyncComparison() = default;
+
+        [[nodiscard]] inline bool IsAnswered() const { return _state->comparison.has_value(); }
+        // Whether a coroutine is suspended waiting for the answer.
+        [[nodiscard]] inline bool IsAwaited() const { return !!(_state->awaiter); }
+
+        // Resumes whatever is awaiting the comparison, which runs until it needs another answer or finishes. Throws std::logic_error if it's been answered before.
+        inline void Answer(int comparison) {
+            if (IsAnswered()) {
+                throw std::logic_error{"A comparison can only be answered once."};
+            }
+
+            _state->comparison = comparison;
+
+            if (std::coroutine_handle<> awaiter = std::exchange(_state->awaiter, nullptr)) {
+                awaiter.resume();
+            }
+        }
+
+        // For a coroutine that's being destroyed while it awaits, so that answering later resumes nothing.
+        inline void Abandon() { _state->awaiter = nullptr; }
+
+        [[nodiscard]] inline bool await_ready() const noexcept { return IsAnswered(); }
+        inline void await_suspend(std::coroutine_handle<> awaiter) { _state->awaiter = awaiter; }
+        [[nodiscard]] inline int await_resume() const { return *(_state->comparison); }
+
+    private:
+        struct State {
+            std::optional<int> comparison;
+            std::coroutine_handle<> awaiter;
+        };
+
+        std::shared_ptr<State> _state;
+    };
+
+    /*
+     * The coroutine an AvlTree's EmplaceAsync returns. It starts right away and runs until a comparison isn't answered yet, and from then on
+     * resumes whenever one is. Once it's done, GetResult returns what Emplace would have. Destroying it before then abandons the insertion.
+     */
+    template<class Result>
+    class AsyncEmplacement final {
+    public:
+        struct promise_type {
+            std::optional<Result> result;
+            std::exception_ptr exception;
+            // The comparison last awaited, so that it can be abandoned along with the coroutine.
+            std::optional<AsyncComparison> awaited;
+
+            inline AsyncEmplacement get_return_object() { return AsyncEmplacement{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+            inline std::suspend_never initial_suspend() noexcept { return {}; }
+            inline std::suspend_always final_suspend() noexcept { return {}; }
+            inline void return_value(Result value) { result.emplace(std::move(value)); }
+            inline void unhandled_exception() { exception = std::current_exception(); }
+            inline AsyncComparison & await_transform(AsyncComparison comparison) { awaited = std::move(comparison); return *awaited; }
+
+            inline ~promise_type() {
+                if (awaited) {
+                    awaited->Abandon();
+                }
+            }
+        };
+
+        AsyncEmplacement(AsyncEmplacement const &) = delete;
+        inline AsyncEmplacement(AsyncEmplacement && other) noexcept : _handle{std::exchange(other._handle, nullptr)} {}
+        AsyncEmplacement & operator=(AsyncEmplacement const &) = delete;
+        inline AsyncEmplacement & operator=(AsyncEmplacement && other) noexcept { std::swap(_handle, other._handle); return *this; }
+        inline ~AsyncEmplacement() {
+            if (_handle) {
+                _handle.destroy();
+            }
+        }
+
+        [[nodiscard]] inline bool IsDone() const { return !_handle || _handle.done(); }
+
+        // Rethrows whatever the insertion threw, and throws std::logic_error if it isn't done.
+        [[nodiscard]] Result GetResult() const {
+            if (!_handle || !_handle.done()) {
+                throw std::logic_error{"The insertion isn't done yet."};
+            }
+
+            if (_handle.promise().exception) {
+                std::rethrow_exception(_handle.promise().exception);
+            }
+
+            return *(_handle.promise().result);
+        }
+
+    private:
+        inline explicit AsyncEmplacement(std::coroutine_handle<promise_type> handle) : _handle{handle} {}
+
+        std::coroutine_handle<promise_type> _handle;
+    };
+}
@@ -0,0 +1,75 @@
+#include "AvlTreeSerialization.h"
+#include <stdexcept>
+
+namespace BST_P {
+
+std::uint64_t AccumulateChecksum(std::uint64_t checksum, char const * characters, std::streamsize count) {
+    constexpr std::uint64_t FNV_PRIME = 1099511628211ULL;
+
+    for (std::streamsize i = 0; i < count; ++i) {
+        checksum = (checksum ^ static_cast<unsigned char>(characters[i])) * FNV_PRIME;
+    }
+
+    return checksum;
+}
+
+ChecksummingOutputBuffer::int_type ChecksummingOutputBuffer::overflow(int_type character) {
+    if (traits_type::eq_int_type(character, traits_type::eof())) {
+        return traits_type::not_eof(character);
+    }
+
+    char written = traits_type::to_char_type(character);
+    return (xsputn(&written, 1) == 1) ? character : traits_type::eof();
+}
+
+std::streamsize ChecksummingOutputBuffer::xsputn(char const * characters, std::streamsize count) {
+    std::streamsize written = _destination.sputn(characters, count);
+    _checksum = AccumulateChecksum(_checksum, characters, written);
+    return written;
+}
+
+ChecksummingInputBuffer::int_type ChecksummingInputBuffer::underflow() {
+    // Peeking doesn't consume anything, so it isn't checksummed yet.
+    return _source.sgetc();
+}
+
+ChecksummingInputBuffer::int_type ChecksummingInputBuffer::uflow() {
+    int_type character = _source.sbumpc();
+
+    if (!traits_type::eq_int_type(character, traits_type::eof())) {
+        char read = traits_type::to_char_type(character);
+        _checksum = AccumulateChecksum(_checksum, &read, 1);
+    }
+
+    return character;
+}
+
+std::streamsize ChecksummingInputBuffer::xsgetn(char * characters, std::streamsize count) {
+    std::streamsize read = _source.sgetn(characters, count);
+    _checksum = AccumulateChecksum(_checksum, characters, read);
+    return read;
+}
+
+void WriteLittleEndian(std::ostream & stream, std::uint64_t value, std::size_t byteCount) {
+    for (std::size_t i = 0U; i < byteCount; ++i) {
+        stream.put(static_cast<char>((value >> (8U * i)) & 0xFFU));
+    }
+}
+
+std::uint64_t ReadLittleEndian(std::istream & stream, std::size_t byteCount) {
+    std::uint64_t value = 0U;
+
+    for (std::size_t i = 0U; i < byteCount; ++i) {
+        std::istream::int_type byte = stream.get();
+
+        if (std::istream::traits_type::eq_int_type(byte, std::istream::traits_type::eof())) {
+            throw std::runtime_error{"Saved tree ended early!"};
+        }
+
+        value |= static_cast<std::uint64_t>(static_cast<unsigned char>(std::istream::traits_type::to_char_type(byte))) << (8U * i);
+    }
+
+    return value;
+}
+
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <type_traits>
+
+namespace BST_P {
+    /*
+     * A saved tree is laid out as follows, with every header field little-endian:
+     *   - SERIALIZED_TREE_MAGIC, 4 bytes
+     *   - SERIALIZED_TREE_VERSION, 4 bytes
+     *   - the element count, 8 bytes
+     *   - the elements in order, each written by the element codec
+     *   - a 64-bit FNV-1a checksum of everything before it, 8 bytes
+     *
+     * An element codec is any type with these two members:
+     *   void Encode(std::ostream & stream, T const & element) const;
+     *   T Decode(std::istream & stream) const;
+     */
+    constexpr std::uint32_t SERIALIZED_TREE_MAGIC = 0x50545342U;
+    constexpr std::uint32_t SERIALIZED_TREE_VERSION = 1U;
+
+    // The FNV-1a offset basis, which is the checksum of nothing at all.
+    constexpr std::uint64_t EMPTY_CHECKSUM = 14695981039346656037ULL;
+    [[nodiscard]] std::uint64_t AccumulateChecksum(std::uint64_t checksum, char const * characters, std::streamsize count);
+
+    // Copies the element's bytes as they are, so saved files only load on machines with the same endianness and type layout.
+    template<class T>
+    struct TrivialElementCodec {
+        static_assert(std::is_trivially_copyable_v<T>, "TrivialElementCodec needs a trivially copyable element type. Use a codec of your own for anything else.");
+
+        void Encode(std::ostream & stream, T const & element) const { stream.write(reinterpret_cast<char const *>(&element), sizeof(T)); }
+        T Decode(std::istream & stream) const { T element{}; stream.read(reinterpret_cast<char *>(&element), sizeof(T)); return element; }
+    };
+
+    // Passes everything written through to another stream buffer, checksumming it on the way. It buffers nothing itself.
+    class ChecksummingOutputBuffer final : public std::streambuf {
+    public:
+        inline explicit ChecksummingOutputBuffer(std::streambuf & destination) : _destination{destination}, _checksum{EMPTY_CHECKSUM} {}
+        ChecksummingOutputBuffer(ChecksummingOutputBuffer const &) = delete;
+        ChecksummingOutputBuffer(ChecksummingOutputBuffer &&) noexcept = delete;
+        ChecksummingOutputBuffer & operator=(ChecksummingOutputBuffer const &) = delete;
+        ChecksummingOutputBuffer & operator=(ChecksummingOutputBuffer &&) noexcept = delete;
+        ~ChecksummingOutputBuffer() override = default;
+
+        [[nodiscard]] inline std::uint64_t GetChecksum() const { return _checksum; }
+
+    protected:
+        int_type overflow(int_type character) override;
+        std::streamsize xsputn(char const * characters, std::streamsize count) override;
+
+    private:
+        std::streambuf & _destination;
+        std::uint64_t _checksum;
+    };
+
+    // Passes everything read through from another stream buffer, checksumming it as it's consumed. It never reads ahead.
+    class ChecksummingInputBuffer final : public std::streambuf {
+    public:
+        inline explicit ChecksummingInputBuffer(std::streambuf & source) : _source{source}, _checksum{EMPTY_CHECKSUM} {}
+        ChecksummingInputBuffer(ChecksummingInputBuffer const &) = delete;
+        ChecksummingInputBuffer(ChecksummingInputBuffer &&) noexcept = delete;
+        ChecksummingInputBuffer & operator=(ChecksummingInputBuffer const &) = delete;
+        ChecksummingInputBuffer & operator=(ChecksummingInputBuffer &&) noexcept = delete;
+        ~ChecksummingInputBuffer() override = default;
+
+        [[nodiscard]] inline std::uint64_t GetChecksum() const { return _checksum; }
+
+    protected:
+        int_type underflow() override;
+        int_type uflow() override;
+        std::streamsize xsgetn(char * characters, std::streamsize count) override;
+
+    private:
+        std::streambuf & _source;
+        std::uint64_t _checksum;
+    };
+
+    void WriteLittleEndian(std::ostream & stream, std::uint64_t value, std::size_t byteCount);
+    // Throws if the stream runs out first.
+    std::uint64_t ReadLittleEndian(std::istream & stream, std::size_t byteCount);
+}
@@ -1,297 +1,1492 @@
 #include <iostream>
 #include "AVLTree.h"
+#include "AvlTreeTests.h"
+#include "ComparisonCache.h"
+#include "ConcurrentAvlTree.h"
+#include "CowAvlTree.h"
+#include "MappedAvlTree.h"
+#include "PersistentAvlTree.h"
+#include "RankingEngine.h"
+#include "RankingOracles.h"
+#include "RcuAvlTree.h"
+#include "ShardedAvlTree.h"
+#include "StaticAvlTree.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace {
+    // Which test is running, so failures can say where they came from.
+    char const * currentTest = "";
+    int currentFailureCount = 0;
+
+    template<class Value> std::string Describe(Value const & value) {
+        std::ostringstream description;
+        description << std::boolalpha << value;
+        return description.str();
+    }
+
+    // Long lists are cut short; the start is usually enough to see what went wrong.
+    template<class Element> std::string Describe(std::vector<Element> const & elements) {
+        constexpr std::size_t MAX_DESCRIBED_ELEMENTS = 32U;
+        std::ostringstream description;
+
+        for (std::size_t i = 0U; i < std::min(elements.size(), MAX_DESCRIBED_ELEMENTS); ++i) {
+            description << "[" << elements[i] << "] ";
+        }
+
+        if (elements.size() > MAX_DESCRIBED_ELEMENTS) {
+            description << "... (" << elements.size() << " elements)";
+        }
+
+        return description.str();
+    }
+
+    // Checks stay quiet when they pass and print what was expected when they don't.
+    template<class Expected, class Actual> void ExpectEqual(char const * what, Expected const & expected, Actual const & actual) {
+        if (!(expected == actual)) {
+            ++currentFailureCount;
+            std::cout << currentTest << ": Expected " << what << ": " << Describe(expected) << ", Actual " << what << ": " << Describe(actual) << "\n";
+        }
+    }
+
+    inline void ExpectTrue(char const * what, bool isTrue) {
+        ExpectEqual(what, true, isTrue);
+    }
+
+    template<class Bound, class Actual> void ExpectAtMost(char const * what, Bound const & bound, Actual const & actual) {
+        if (!(actual <= bound)) {
+            ++currentFailureCount;
+            std::cout << currentTest << ": Expected " << what << " at most: " << Describe(bound) << ", Actual " << what << ": " << Describe(actual) << "\n";
+        }
+    }
+
+    template<class Action> void ExpectThrow(char const * what, Action action) {
+        bool isThrown = false;
+
+        try {
+            action();
+        } catch (std::exception const &) {
+            isThrown = true;
+        }
+
+        ExpectEqual(what, true, isThrown);
+    }
+
+    // Walks the tree both ways, so the threading in each direction gets checked.
+    template<class Tree> void ExpectElements(Tree const & tree, std::vector<typename Tree::value_type> expected) {
+        std::vector<typename Tree::value_type> forward;
+
+        for (auto itr = tree.cbegin(); itr != tree.cend(); ++itr) {
+            forward.push_back(*itr);
+        }
+
+        ExpectEqual("elements", expected, forward);
+
+        std::vector<typename Tree::value_type> backward;
+
+        for (auto itr = tree.cend(); itr != tree.cbegin();) {
+            backward.push_back(*(--itr));
+        }
+
+        std::reverse(expected.begin(), expected.end());
+        ExpectEqual("elements in reverse", expected, backward);
+    }
+
+    // Knuth's bound on the height of an AVL tree, rounded down to the 1.44 everyone quotes. It holds for every size from 0 up.
+    inline double FindAvlHeightBound(std::size_t size) {
+        return 1.44 * std::log2(static_cast<double>(size) + 2.0);
+    }
+
+    // Returns the height of node's subtree, after checking its links and balance factor and appending its elements in order.
+    template<class Tree> typename Tree::Height ValidateSubtree(typename Tree::NodeTraverser const & node, std::vector<typename Tree::value_type> & elements, bool & isValid) {
+        typename Tree::Height leftHeight = 0U;
+        typename Tree::Height rightHeight = 0U;
+        typename Tree::NodeTraverser child = node;
+
+        isValid = isValid && !node.IsTombstone();
+
+        if (child.GoToLeftChild()) {
+            leftHeight = ValidateSubtree<Tree>(child, elements, isValid);
+            isValid = isValid && child.GoToParent() && (child == node);
+        }
+
+        elements.push_back(*node);
+
+        if (child.GoToRightChild()) {
+            rightHeight = ValidateSubtree<Tree>(child, elements, isValid);
+            isValid = isValid && child.GoToParent() && (child == node);
+        }
+
+        int balance = static_cast<int>(rightHeight) - static_cast<int>(leftHeight);
+        isValid = isValid && (node.GetBalanceFactor() == balance) && (balance >= Tree::LEFT_MAX) && (balance <= Tree::RIGHT_MAX);
+
+        return 1U + std::max(leftHeight, rightHeight);
+    }
+
+    /*
+     * Checks everything that makes the tree an AVL tree: every element sorts strictly after the one before it, every child links back to its parent,
+     * every recorded balance factor is the real one and within one, and the recorded height and size are the real ones. Iteration has to agree with the shape.
+     */
+    template<class Tree> void ExpectValidAvlTree(Tree const & tree) {
+        std::vector<typename Tree::value_type> elements;
+        typename Tree::Height height = 0U;
+        bool isValid = true;
+        typename Tree::NodeTraverser root = tree.CreateNodeTraverser();
+
+        if (root) {
+            height = ValidateSubtree<Tree>(root, elements, isValid);
+            isValid = isValid && !root.IsAbleToGoToParent();
+        }
+
+        ExpectTrue("links and balance factors to be consistent", isValid);
+
+        bool isInOrder = true;
+
+        for (std::size_t i = 1U; i < elements.size(); ++i) {
+            isInOrder = isInOrder && (tree.GetDefaultCompare()(elements[i - 1U], elements[i]) < 0);
+        }
+
+        ExpectTrue("elements to be strictly in order", isInOrder);
+        ExpectEqual("height", height, tree.GetHeight());
+        ExpectEqual("size", elements.size(), tree.GetSize());
+        ExpectAtMost("height", FindAvlHeightBound(tree.GetSize()), static_cast<double>(tree.GetHeight()));
+        ExpectElements(tree, elements);
+    }
+}
 
 void TestAvlTree() {
     BST_P::AvlTree<int> tree;
 
-    std::cout << "Expected height: 0, Actual height: " << tree.GetHeight() << "\n";
+    ExpectEqual("height", 0U, tree.GetHeight());
+    ExpectValidAvlTree(tree);
 
     tree.Insert(5);
 
-    std::cout << "Expected height: 1, Actual height: " << tree.GetHeight() << "\n";
+    ExpectEqual("height", 1U, tree.GetHeight());
+    ExpectEqual("inserted a duplicate", false, tree.Insert(5).first);
 
-    auto result = tree.Insert(5);
+    ExpectEqual("inserted", true, tree.Insert(1).first);
+    ExpectElements(tree, {1, 5});
 
-    std::cout << "Expected bool: false, Actual bool: " << (result.first ? "true" : "false") << "\n";
+    ExpectEqual("inserted", true, tree.Insert(7).first);
+    ExpectElements(tree, {1, 5, 7});
 
-    result = tree.Insert(1);
+    ExpectEqual("inserted", true, tree.Insert(3).first);
+    ExpectElements(tree, {1, 3, 5, 7});
 
-    std::cout << "Expected bool: true, Actual bool: " << (result.first ? "true" : "false") << "\n";
+    ExpectEqual("inserted", true, tree.Insert(6).first);
+    ExpectElements(tree, {1, 3, 5, 6, 7});
 
-    for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
-        std::cout << "[" << (*itr) << "] ";
-    }
+    ExpectEqual("inserted", true, tree.Insert(9).first);
+    ExpectElements(tree, {1, 3, 5, 6, 7, 9});
+    ExpectValidAvlTree(tree);
+}
 
-    std::cout << "\n";
+void TestAvlTreeAgain() {
+    BST_P::AvlTree<int> tree;
+    std::vector<int> expected;
+
+    // Ascending inserts only grow the tree a level at each power of two.
+    for (std::uint64_t height : {1U, 2U, 2U, 3U, 3U, 3U, 3U, 4U}) {
+        expected.push_back(static_cast<int>(expected.size()) + 1);
+        tree.Insert(expected.back());
 
-    result = tree.Insert(7);
+        ExpectEqual("height", height, tree.GetHeight());
+        ExpectValidAvlTree(tree);
+        ExpectElements(tree, expected);
+    }
+}
 
-    std::cout << "Expected bool: true, Actual bool: " << (result.first ? "true" : "false") << "\n";
+void TestAvlTreeFromWikipedia() {
+    BST_P::AvlTree<char> tree;
 
-    for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
-        std::cout << "[" << (*itr) << "] ";
+    for (char element : {'M', 'N', 'O', 'L', 'K', 'Q', 'P', 'H', 'I', 'A'}) {
+        tree.Insert(element);
+        ExpectValidAvlTree(tree);
     }
 
-    std::cout << "\n";
+    ExpectEqual("height", 4U, tree.GetHeight());
+    ExpectElements(tree, {'A', 'H', 'I', 'K', 'L', 'M', 'N', 'O', 'P', 'Q'});
+}
+
+void TestAvlTreeRemoveAndEmplace() {
+    BST_P::AvlTree<int> tree;
+
+    tree.Insert(1);
+    tree.Insert(2);
+
+    ExpectEqual("height", 2U, tree.GetHeight());
+    ExpectElements(tree, {1, 2});
 
-    result = tree.Insert(3);
+    ExpectEqual("removed 3", false, tree.Remove(3));
+    ExpectEqual("height after removing nothing", 2U, tree.GetHeight());
+    ExpectElements(tree, {1, 2});
 
-    std::cout << "Expected bool: true, Actual bool: " << (result.first ? "true" : "false") << "\n";
+    ExpectEqual("removed 1", true, tree.Remove(1));
+    ExpectEqual("height", 1U, tree.GetHeight());
+    ExpectElements(tree, {2});
 
-    for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
-        std::cout << "[" << (*itr) << "] ";
+    ExpectEqual("removed 2", true, tree.Remove(2));
+    ExpectEqual("height", 0U, tree.GetHeight());
+    ExpectElements(tree, {});
+    ExpectValidAvlTree(tree);
+
+    for (int element : {1, 2, 4, 8, 0, 3, 5, 7, 9, 6}) {
+        tree.Insert(element);
+        ExpectValidAvlTree(tree);
     }
 
-    std::cout << "\n";
+    ExpectEqual("height", 4U, tree.GetHeight());
+    ExpectElements(tree, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
 
-    result = tree.Insert(6);
+    for (int element : {10, 11, 12, 13, 14, 100}) {
+        tree.Insert(element);
+        ExpectValidAvlTree(tree);
+    }
 
-    std::cout << "Expected bool: true, Actual bool: " << (result.first ? "true" : "false") << "\n";
+    ExpectEqual("height", 5U, tree.GetHeight());
+    ExpectElements(tree, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 100});
 
-    for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
-        std::cout << "[" << (*itr) << "] ";
+    tree.Remove(3);
+
+    ExpectEqual("height", 5U, tree.GetHeight());
+    ExpectValidAvlTree(tree);
+    ExpectElements(tree, {0, 1, 2, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 100});
+
+    tree.Remove(12);
+
+    ExpectEqual("height", 4U, tree.GetHeight());
+    ExpectValidAvlTree(tree);
+    ExpectElements(tree, {0, 1, 2, 4, 5, 6, 7, 8, 9, 10, 11, 13, 14, 100});
+}
+
+void TestAvlTreeAgainstStdSet() {
+    BST_P::AvlTree<int> tree;
+    std::set<int> expected;
+    std::mt19937 random{44U};
+    std::uniform_int_distribution<int> keys{0, 299};
+    std::uniform_int_distribution<int> operations{0, 9};
+
+    // Half inserts, a third removes and the rest finds, over a key range small enough that all three keep hitting and missing.
+    // Stops at the first failure, since everything after it would fail too.
+    for (int i = 0; (i < 5000) && (currentFailureCount == 0); ++i) {
+        int key = keys(random);
+        int operation = operations(random);
+
+        if (operation < 5) {
+            bool isInserted = expected.insert(key).second;
+            ExpectEqual("inserted", isInserted, tree.Insert(key).first);
+        } else if (operation < 8) {
+            bool isRemoved = expected.erase(key) > 0U;
+            ExpectEqual("removed", isRemoved, tree.Remove(key));
+        } else {
+            bool isFound = expected.count(key) > 0U;
+            ExpectEqual("found", isFound, tree.cFind(key) != tree.cend());
+        }
+
+        ExpectValidAvlTree(tree);
+        ExpectElements(tree, std::vector<int>{expected.cbegin(), expected.cend()});
     }
 
-    std::cout << "\n";
+    BST_P::AvlTree<int> clone = tree.Clone();
+    ExpectValidAvlTree(clone);
+    ExpectElements(clone, std::vector<int>{expected.cbegin(), expected.cend()});
 
-    result = tree.Insert(9);
+    tree.Clear();
+    ExpectValidAvlTree(tree);
+}
+
+void TestRelaxedAvlTreeAgainstStdSet() {
+    BST_P::AvlTree<int> tree;
+    std::set<int> expected;
+    std::mt19937 random{45U};
+    std::uniform_int_distribution<int> keys{0, 299};
+    std::uniform_int_distribution<int> operations{0, 9};
+
+    tree.SetRelaxedBalancing(true);
+
+    // While relaxed the tree only has to answer correctly. Every so often it's made strict again, and then it has to be a plain AVL tree.
+    for (int i = 1; (i <= 5000) && (currentFailureCount == 0); ++i) {
+        int key = keys(random);
+        int operation = operations(random);
+
+        if (operation < 5) {
+            bool isInserted = expected.insert(key).second;
+            ExpectEqual("inserted", isInserted, tree.Insert(key).first);
+        } else if (operation < 8) {
+            bool isRemoved = expected.erase(key) > 0U;
+            ExpectEqual("removed", isRemoved, tree.Remove(key));
+        } else {
+            bool isFound = expected.count(key) > 0U;
+            ExpectEqual("found", isFound, tree.cFind(key) != tree.cend());
+        }
+
+        ExpectEqual("size", expected.size(), tree.GetSize());
+        ExpectAtMost("tombstones", tree.GetSize(), tree.GetTombstoneCount());
+        ExpectElements(tree, std::vector<int>{expected.cbegin(), expected.cend()});
+
+        if (i % 250 == 0) {
+            tree.SetRelaxedBalancing(false);
+            ExpectEqual("tombstones", 0U, tree.GetTombstoneCount());
+            ExpectValidAvlTree(tree);
+            tree.SetRelaxedBalancing(true);
+        }
+    }
+}
+
+void TestAvlTreeEmplaceBefore() {
+    std::mt19937 random{49U};
+    std::vector<int> keys(2000);
+    std::iota(keys.begin(), keys.end(), 0);
+
+    // Each key goes in before the next larger one already there, found without comparing against the new key, or at the end if there isn't one.
+    for (bool isRelaxed : {false, true}) {
+        BST_P::AvlTree<int> tree;
+        std::set<int> expected;
+        tree.SetRelaxedBalancing(isRelaxed);
+        std::shuffle(keys.begin(), keys.end(), random);
+
+        for (std::size_t i = 0U; (i < keys.size()) && (currentFailureCount == 0); ++i) {
+            auto next = expected.upper_bound(keys[i]);
+            auto position = (next == expected.end()) ? tree.cend() : tree.cFind(*next);
+            ExpectEqual("emplaced", keys[i], *(tree.EmplaceBefore(position, keys[i])));
+            expected.insert(keys[i]);
+
+            // Removing every third key leaves tombstones behind while relaxed, for later keys to go in around.
+            if (i % 3U == 2U) {
+                ExpectEqual("removed", true, tree.Remove(keys[i - 1U]));
+                expected.erase(keys[i - 1U]);
+            }
+
+            if (!isRelaxed || (i % 250U == 0U)) {
+                ExpectEqual("size", expected.size(), tree.GetSize());
+                ExpectElements(tree, std::vector<int>{expected.cbegin(), expected.cend()});
+            }
+
+            if (!isRelaxed) {
+                ExpectValidAvlTree(tree);
+            }
+        }
+
+        // Searches still go through the tombstones, so they only find everything if the tombstones stayed in order too.
+        for (int key : expected) {
+            ExpectTrue("found", tree.cFind(key) != tree.cend());
+        }
+
+        tree.SetRelaxedBalancing(false);
+        ExpectValidAvlTree(tree);
+        ExpectElements(tree, std::vector<int>{expected.cbegin(), expected.cend()});
+
+        BST_P::AvlTree<int> other;
+        other.Insert(0);
+        ExpectTrue("emplacing before another tree's element fails", tree.EmplaceBefore(other.cbegin(), 1) == tree.end());
+        ExpectEqual("size", expected.size(), tree.GetSize());
+    }
+}
 
-    std::cout << "Expected bool: true, Actual bool: " << (result.first ? "true" : "false") << "\n";
+void TestAvlTreeEmplaceAsync() {
+    typedef BST_P::AvlTree<int> Tree;
+    constexpr std::size_t IN_FLIGHT_COUNT = 16U;
+    std::mt19937 random{50U};
+    std::vector<int> keys(1500);
+    std::iota(keys.begin(), keys.end(), 0);
+    // Every tenth key comes round twice, so some insertions find their key already there, or still in flight.
+    for (std::size_t i = 0U; i < 1500U; i += 10U) {
+        keys.push_back(static_cast<int>(i));
+    }
 
-    for (auto itr = tree.end(); --itr != tree.begin();) {
-        std::cout << "[" << (*itr) << "] ";
+    for (bool isRelaxed : {false, true}) {
+        Tree tree;
+        tree.SetRelaxedBalancing(isRelaxed);
+        std::shuffle(keys.begin(), keys.end(), random);
+
+        // Each pending question is kept alongside its answer, and answered in a random order, so insertions commit out of order
+        // and keep finding the tree restructured under them. Some are answered straight away and never suspend at all.
+        std::vector<std::pair<BST_P::AsyncComparison, int>> pending;
+        auto compare = [&pending, &random](int const & a, int const & b) {
+            if (std::bernoulli_distribution{0.25}(random)) {
+                return BST_P::AsyncComparison{a - b};
+            }
+
+            pending.emplace_back(BST_P::AsyncComparison{}, a - b);
+            return pending.back().first;
+        };
+
+        std::vector<std::pair<int, Tree::Emplacement>> inFlight;
+        std::set<int> expected;
+        std::size_t insertedCount = 0U;
+        std::size_t nextKey = 0U;
+
+        while ((nextKey < keys.size()) || !inFlight.empty()) {
+            while ((nextKey < keys.size()) && (inFlight.size() < IN_FLIGHT_COUNT)) {
+                inFlight.emplace_back(keys[nextKey], tree.EmplaceAsync(compare, keys[nextKey]));
+                ++nextKey;
+            }
+
+            if (!pending.empty()) {
+                std::size_t index = std::uniform_int_distribution<std::size_t>{0U, pending.size() - 1U}(random);
+                auto question = std::move(pending[index]);
+                pending[index] = std::move(pending.back());
+                pending.pop_back();
+                question.first.Answer(question.second);
+            }
+
+            for (std::size_t i = 0U; i < inFlight.size();) {
+                if (!inFlight[i].second.IsDone()) {
+                    ++i;
+                    continue;
+                }
+
+                auto result = inFlight[i].second.GetResult();
+                ExpectEqual("inserted", expected.insert(inFlight[i].first).second, result.first);
+                ExpectEqual("emplaced", inFlight[i].first, *(result.second));
+                insertedCount += result.first ? 1U : 0U;
+                inFlight[i] = std::move(inFlight.back());
+                inFlight.pop_back();
+            }
+
+            if (!isRelaxed && (nextKey % 100U == 0U)) {
+                ExpectValidAvlTree(tree);
+            }
+        }
+
+        ExpectEqual("questions left", std::size_t{0U}, pending.size());
+        ExpectEqual("inserted", std::size_t{1500U}, insertedCount);
+        tree.SetRelaxedBalancing(false);
+        ExpectValidAvlTree(tree);
+        ExpectElements(tree, std::vector<int>{expected.cbegin(), expected.cend()});
+
+        // Abandoning an insertion mid-descent leaves the tree as it was, and answering its question afterwards does nothing.
+        {
+            auto abandoned = tree.EmplaceAsync([&pending](int const & a, int const & b) { pending.emplace_back(BST_P::AsyncComparison{}, a - b); return pending.back().first; }, 5000);
+            ExpectEqual("done", false, abandoned.IsDone());
+            ExpectThrow("an unfinished result to throw", [&abandoned]() { (void)abandoned.GetResult(); });
+        }
+
+        ExpectEqual("questions left", std::size_t{1U}, pending.size());
+        pending.back().first.Answer(pending.back().second);
+        ExpectElements(tree, std::vector<int>{expected.cbegin(), expected.cend()});
+        pending.clear();
     }
 
-    std::cout << "[" << *(tree.begin()) << "] \n";
+    // Two trees built alike are on the same structure version. Move-assigning one over the other while an insertion waits must still send it back
+    // to the root, or it would link under a node the other tree owns now.
+    {
+        std::vector<std::pair<BST_P::AsyncComparison, int>> pending;
+        auto compare = [&pending](int const &, int const & b) {
+            pending.emplace_back(BST_P::AsyncComparison{}, b);
+            return pending.back().first;
+        };
+
+        Tree destination;
+        Tree source;
+        destination.Insert(10);
+        source.Insert(20);
+
+        auto emplacement = destination.EmplaceAsync(compare, 15);
+        ExpectEqual("compared to", 10, pending.back().second);
+        destination = std::move(source);
+        pending.back().first.Answer(1);
+
+        ExpectEqual("done", false, emplacement.IsDone());
+        ExpectEqual("compared to after the move", 20, pending.back().second);
+        pending.back().first.Answer(-1);
+
+        ExpectEqual("done", true, emplacement.IsDone());
+        ExpectEqual("inserted", true, emplacement.GetResult().first);
+        ExpectValidAvlTree(destination);
+        ExpectValidAvlTree(source);
+        ExpectElements(destination, {15, 20});
+        ExpectElements(source, {10});
+    }
 }
 
-void TestAvlTreeAgain() {
+void TestAvlTreeComplexity() {
+    typedef BST_P::AvlTree<int, BST_P::CheckedAccess, BST_P::CountingStats> CountingTree;
+    constexpr int SIZE = 1 << 15;
+
+    std::vector<int> ascending(SIZE);
+    std::iota(ascending.begin(), ascending.end(), 0);
+    std::vector<int> descending{ascending.crbegin(), ascending.crend()};
+    std::vector<int> shuffled = ascending;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937{46U});
+
+    for (std::vector<int> const * order : {&ascending, &descending, &shuffled}) {
+        CountingTree tree;
+
+        for (int element : *order) {
+            tree.Insert(element);
+            ExpectAtMost("height while inserting", FindAvlHeightBound(tree.GetSize()), static_cast<double>(tree.GetHeight()));
+        }
+
+        ExpectValidAvlTree(tree);
+
+        // A Find compares once per level at most, so these catch both a tree that's too tall and a search that wanders.
+        std::uint64_t mostComparisons = 0U;
+        std::uint64_t totalComparisons = 0U;
+
+        for (int element = -1; element <= SIZE; ++element) {
+            tree.ResetStats();
+            (void)tree.cFind(element);
+
+            std::uint64_t comparisons = tree.GetStats().comparisons;
+            mostComparisons = std::max(mostComparisons, comparisons);
+            totalComparisons += comparisons;
+        }
+
+        ExpectAtMost("comparisons for one Find", static_cast<std::uint64_t>(tree.GetHeight()), mostComparisons);
+        ExpectAtMost("comparisons per Find on average", std::log2(static_cast<double>(SIZE)) + 1.0, static_cast<double>(totalComparisons) / static_cast<double>(SIZE + 2));
+
+        for (int element = 0; element < SIZE; element += 2) {
+            tree.Remove(element);
+            ExpectAtMost("height while removing", FindAvlHeightBound(tree.GetSize()), static_cast<double>(tree.GetHeight()));
+        }
+
+        ExpectValidAvlTree(tree);
+
+        ExpectEqual("nodes freed", static_cast<std::uint64_t>(SIZE / 2), tree.GetStats().nodesFreed);
+    }
+}
+
+void TestAvlTreeCloneAndCopyOnWrite() {
     BST_P::AvlTree<int> tree;
 
-    std::cout << "Expected height: 0, Actual height: " << tree.GetHeight() << "\n";
+    for (int i = 0; i < 10; ++i) {
+        tree.Insert(i);
+    }
 
-    tree.Insert(1);
+    BST_P::AvlTree<int> clone = tree.Clone();
+
+    ExpectEqual("height of the clone", tree.GetHeight(), clone.GetHeight());
+    ExpectValidAvlTree(clone);
+
+    clone.Remove(4);
+    clone.Insert(42);
+
+    ExpectElements(tree, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+    ExpectElements(clone, {0, 1, 2, 3, 5, 6, 7, 8, 9, 42});
+
+    BST_P::CowAvlTree<int> original{std::move(clone)};
+    BST_P::CowAvlTree<int> copy{original};
+
+    ExpectEqual("shared", true, copy.IsShared());
+
+    // Writes that wouldn't change anything don't need a copy of their own.
+    ExpectEqual("inserted a duplicate", false, copy.Insert(5).first);
+    ExpectEqual("emplaced a duplicate", false, copy.DefaultEmplace(6).first);
+    ExpectEqual("removed a missing element", false, copy.Remove(77));
+    ExpectEqual("shared", true, copy.IsShared());
+
+    copy.Insert(100);
+
+    ExpectEqual("shared", false, copy.IsShared());
+    ExpectEqual("found 100 in original", false, original.Find(100) != original.end());
+    ExpectEqual("found 100 in copy", true, copy.Find(100) != copy.end());
 
-    std::cout << "Expected height: 1, Actual height: " << tree.GetHeight() << "\n";
+    BST_P::CowAvlTree<int> other{original};
+    ExpectEqual("removed", true, other.Remove(5));
+    ExpectEqual("shared", false, other.IsShared());
+    ExpectElements(original.Read(), {0, 1, 2, 3, 5, 6, 7, 8, 9, 42});
 
-    for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
-        std::cout << "[" << (*itr) << "] ";
+    // The tree moved from is left empty, but everything still works on it.
+    ExpectEqual("size after moving", std::size_t{0U}, clone.GetSize());
+    ExpectTrue("begin is end after moving", clone.cbegin() == clone.cend());
+    ExpectTrue("nothing found after moving", clone.Find(1) == clone.end());
+    ExpectEqual("removed after moving", false, clone.Remove(1));
+    clone.Insert(3);
+    clone.Insert(1, [](int const & a, int const & b) { return a - b; });
+    clone.EmplaceBefore(clone.cend(), 5);
+    ExpectValidAvlTree(clone);
+    ExpectElements(clone, {1, 3, 5});
+
+    BST_P::AvlTree<int> moved{std::move(clone)};
+    ExpectElements(moved, {1, 3, 5});
+    clone.Insert(2);
+    clone.Rebalance();
+    clone.Reorder([](int const & a, int const & b) { return b - a; });
+    ExpectElements(clone, {2});
+    ExpectElements(clone.Clone(), {2});
+
+    // Each tree a growing vector moves has its root handed over to the header inside the new one, which iteration and retracing both walk up to.
+    static_assert(std::is_nothrow_move_constructible_v<BST_P::AvlTree<int>>, "Moving an AvlTree shouldn't allocate.");
+    std::vector<BST_P::AvlTree<int>> trees;
+
+    for (int i = 0; i < 20; ++i) {
+        trees.emplace_back();
+
+        for (int j = 0; j <= i; ++j) {
+            trees.back().Insert(j);
+        }
     }
 
-    std::cout << "\n";
+    for (std::size_t i = 0U; i < trees.size(); ++i) {
+        ExpectEqual("removed the moved tree's first element", true, trees[i].Remove(0));
+        ExpectValidAvlTree(trees[i]);
 
-    tree.Insert(2);
+        std::vector<int> expected(i);
+        std::iota(expected.begin(), expected.end(), 1);
+        ExpectElements(trees[i], expected);
+    }
+}
 
-    std::cout << "Expected height: 2, Actual height: " << tree.GetHeight() << "\n";
+void TestPersistentAvlTree() {
+    BST_P::PersistentAvlTree<int> empty;
+    BST_P::PersistentAvlTree<int> current = empty;
+    std::vector<BST_P::PersistentAvlTree<int>> versions;
 
-    for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
-        std::cout << "[" << (*itr) << "] ";
+    for (int i = 1; i <= 8; ++i) {
+        current = current.Insert(i).second;
+        versions.push_back(current);
     }
 
-    std::cout << "\n";
+    ExpectEqual("height", 4U, current.GetHeight());
+    ExpectEqual("size of the empty version", 0U, empty.GetSize());
 
-    tree.Insert(3);
+    auto removed = current.Remove(4);
 
-    std::cout << "Expected height: 2, Actual height: " << tree.GetHeight() << "\n";
+    ExpectEqual("removed", true, removed.first);
+    ExpectElements(removed.second, {1, 2, 3, 5, 6, 7, 8});
 
-    for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
-        std::cout << "[" << (*itr) << "] ";
+    // Every older version has to be unchanged.
+    std::vector<int> expected;
+
+    for (auto const & version : versions) {
+        expected.push_back(static_cast<int>(expected.size()) + 1);
+        ExpectElements(version, expected);
     }
 
-    std::cout << "\n";
+    ExpectEqual("found 4 in the version before removal", true, versions.back().Find(4) != versions.back().end());
+}
 
-    tree.Insert(4);
+void TestRcuAvlTree() {
+    BST_P::RcuAvlTree<int> tree;
+    std::atomic<bool> isWriting{true};
+    std::atomic<int> inconsistentReads{0};
+    std::vector<std::thread> readers;
+
+    // Every reader checks that the version it pinned is internally consistent while the writer keeps replacing it.
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&tree, &isWriting, &inconsistentReads]() {
+            while (isWriting.load()) {
+                auto view = tree.Read();
+                std::size_t count = 0U;
+                int previous = -1;
+
+                for (auto itr = view->begin(); itr != view->end(); ++itr, ++count) {
+                    if (*itr <= previous) {
+                        ++inconsistentReads;
+                    }
+
+                    previous = *itr;
+                }
+
+                if (count != view->GetSize()) {
+                    ++inconsistentReads;
+                }
+            }
+        });
+    }
 
-    std::cout << "Expected height: 3, Actual height: " << tree.GetHeight() << "\n";
+    for (int i = 0; i < 2000; ++i) {
+        tree.Insert(i);
+    }
 
-    for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
-        std::cout << "[" << (*itr) << "] ";
+    for (int i = 0; i < 2000; i += 2) {
+        tree.Remove(i);
     }
 
-    std::cout << "\n";
+    isWriting.store(false);
 
-    tree.Insert(5);
+    for (auto & reader : readers) {
+        reader.join();
+    }
 
-    std::cout << "Expected height: 3, Actual height: " << tree.GetHeight() << "\n";
+    tree.Reclaim();
 
-    for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
-        std::cout << "[" << (*itr) << "] ";
+    ExpectEqual("inconsistent reads", 0, inconsistentReads.load());
+    ExpectEqual("size", 1000U, tree.Read()->GetSize());
+    ExpectEqual("retired versions after reclaiming with no readers", 0U, tree.GetRetiredVersionCount());
+}
+
+void TestConcurrentAvlTree() {
+    BST_P::ConcurrentAvlTree<int> tree;
+    std::vector<std::thread> writers;
+
+    // Each writer inserts its own residue class and then removes every other element it inserted.
+    for (int t = 0; t < 4; ++t) {
+        writers.emplace_back([&tree, t]() {
+            for (int i = t; i < 4000; i += 4) {
+                tree.Insert(i);
+            }
+
+            for (int i = t; i < 4000; i += 8) {
+                tree.Remove(i);
+            }
+        });
+    }
+
+    for (auto & writer : writers) {
+        writer.join();
+    }
+
+    std::vector<int> elements;
+    tree.ForEach([&elements](int element) { elements.push_back(element); });
+
+    bool isSorted = true;
+    for (std::size_t i = 1U; i < elements.size(); ++i) {
+        isSorted = isSorted && (elements[i - 1U] < elements[i]);
     }
 
-    std::cout << "\n";
+    ExpectEqual("size", 2000U, tree.GetSize());
+    ExpectEqual("elements visited", 2000U, elements.size());
+    ExpectEqual("sorted", true, isSorted);
+    ExpectAtMost("height", 14, tree.GetHeight());
+    ExpectEqual("found 8", false, tree.Contains(8));
+    ExpectEqual("found 5", true, tree.Contains(5));
+}
+
+void TestShardedAvlTree() {
+    BST_P::ShardedAvlTree<int> tree{BST_P::subtract<int>{}, 64U};
+    std::vector<std::thread> writers;
+
+    // Each writer works on its own key range, so once the shards have split they rarely share a lock.
+    for (int t = 0; t < 4; ++t) {
+        writers.emplace_back([&tree, t]() {
+            for (int i = t * 1000; i < (t + 1) * 1000; ++i) {
+                tree.Insert(i);
+            }
+        });
+    }
 
-    tree.Insert(6);
+    for (auto & writer : writers) {
+        writer.join();
+    }
 
-    std::cout << "Expected height: 3, Actual height: " << tree.GetHeight() << "\n";
+    std::vector<int> elements;
+    tree.ForEach([&elements](int element) { elements.push_back(element); });
 
-    for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
-        std::cout << "[" << (*itr) << "] ";
+    bool isInOrder = elements.size() == 4000U;
+    for (std::size_t i = 0U; isInOrder && (i < elements.size()); ++i) {
+        isInOrder = elements[i] == static_cast<int>(i);
     }
 
-    std::cout << "\n";
+    ExpectEqual("size", 4000U, tree.GetSize());
+    ExpectEqual("every element in order across shards", true, isInOrder);
+    // A split is skipped when another one is under way, so under contention some shards can end up past the maximum and the count isn't fixed.
+    ExpectEqual("shards to have split", true, tree.GetShardCount() > 1U);
 
-    tree.Insert(7);
+    for (int i = 0; i < 3990; ++i) {
+        tree.Remove(i);
+    }
+
+    ExpectEqual("size after removal", 10U, tree.GetSize());
+    ExpectEqual("shard count once the cold shards are merged back into one", 1U, tree.GetShardCount());
+    ExpectEqual("found 3995", true, tree.Contains(3995));
+}
 
-    std::cout << "Expected height: 3, Actual height: " << tree.GetHeight() << "\n";
+void TestAvlTreeParallelTraversal() {
+    BST_P::AvlTree<int> tree;
+    BST_P::WorkStealingPool pool{4U};
 
-    for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
-        std::cout << "[" << (*itr) << "] ";
+    for (int i = 0; i < 100000; ++i) {
+        tree.Insert(i);
     }
 
-    std::cout << "\n";
+    std::atomic<long long> parallelSum{0};
+    tree.ParallelForEach([&parallelSum](int element) { parallelSum += element; }, pool);
+
+    long long reducedSum = tree.ParallelReduce(0LL, [](int element) { return static_cast<long long>(element); }, [](long long a, long long b) { return a + b; }, pool);
 
-    tree.Insert(8);
+    // Concatenation isn't commutative, so this only comes out sorted if the chunks are combined in order.
+    std::vector<int> inOrder = tree.ParallelReduce(
+        std::vector<int>{},
+        [](int element) { return std::vector<int>{element}; },
+        [](std::vector<int> a, std::vector<int> const & b) { a.insert(a.end(), b.begin(), b.end()); return a; },
+        pool
+    );
+
+    bool isInOrder = inOrder.size() == 100000U;
+    for (std::size_t i = 0U; isInOrder && (i < inOrder.size()); ++i) {
+        isInOrder = inOrder[i] == static_cast<int>(i);
+    }
 
-    std::cout << "Expected height: 4, Actual height: " << tree.GetHeight() << "\n";
+    std::vector<std::size_t> chunkSizes(64U, 0U);
+    std::size_t chunkCount = tree.ParallelForEachChunk([&chunkSizes](std::size_t chunkIndex, auto first, auto last) {
+        for (; first != last; ++first) {
+            ++chunkSizes[chunkIndex];
+        }
+    }, pool);
 
-    for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
-        std::cout << "[" << (*itr) << "] ";
+    std::size_t chunkedTotal = 0U;
+    for (std::size_t chunkSize : chunkSizes) {
+        chunkedTotal += chunkSize;
     }
 
-    std::cout << "\n";
+    ExpectEqual("ParallelForEach sum", 4999950000LL, parallelSum.load());
+    ExpectEqual("ParallelReduce sum", 4999950000LL, reducedSum);
+    ExpectEqual("ParallelReduce to keep elements in order", true, isInOrder);
+    ExpectEqual("chunk count", 32U, chunkCount);
+    ExpectEqual("elements across all chunks", 100000U, chunkedTotal);
 }
 
-void TestAvlTreeFromWikipedia() {
-    BST_P::AvlTree<char> tree;
+void TestAvlTreeRelaxedBalancing() {
+    BST_P::AvlTree<int> tree;
+    tree.SetRelaxedBalancing(true);
 
-    tree.Insert('M');
-    tree.Insert('N');
-    tree.Insert('O');
-    tree.Insert('L');
-    tree.Insert('K');
-    tree.Insert('Q');
-    tree.Insert('P');
-    tree.Insert('H');
-    tree.Insert('I');
-    tree.Insert('A');
+    // Ascending inserts are the worst case for an unbalanced tree. The height limit has to step in along the way.
+    for (int i = 0; i < 1000; ++i) {
+        tree.Insert(i);
+    }
 
-    std::cout << "Expected height: 4, Actual height: " << tree.GetHeight() << "\n";
+    ExpectAtMost("height while relaxed", 2U * 10U, tree.GetHeight());
 
-    for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
-        std::cout << "[" << (*itr) << "] ";
+    for (int i = 0; i < 1000; i += 2) {
+        tree.Remove(i);
     }
 
-    std::cout << "\n";
+    ExpectEqual("size", 500U, tree.GetSize());
+    ExpectEqual("found 500", false, tree.cFind(500) != tree.cend());
+    ExpectEqual("found 501", true, tree.cFind(501) != tree.cend());
+    ExpectEqual("first element", 1, *(tree.cbegin()));
+
+    // Reinserting a removed element brings its tombstone back to life.
+    std::size_t tombstoneCount = tree.GetTombstoneCount();
+    tree.Insert(500);
+    ExpectEqual("tombstones after reinserting 500", tombstoneCount - 1U, tree.GetTombstoneCount());
+
+    std::vector<int> expected;
+    for (int i = 1; i < 1000; i += 2) {
+        expected.push_back(i);
+    }
+
+    expected.insert(std::lower_bound(expected.begin(), expected.end(), 500), 500);
+    ExpectElements(tree, expected);
+
+    tree.SetRelaxedBalancing(false);
+    ExpectEqual("tombstones after rebalancing", 0U, tree.GetTombstoneCount());
+    ExpectAtMost("height", 12U, tree.GetHeight());
+    ExpectValidAvlTree(tree);
 }
 
-void TestAvlTreeRemoveAndEmplace() {
+void TestAvlTreeReorder() {
     BST_P::AvlTree<int> tree;
 
-    tree.Insert(1);
-    tree.Insert(2);
+    for (int i = 0; i < 20000; ++i) {
+        tree.Insert(i);
+    }
+
+    // Descending by last digit, then ascending. Large enough to take the parallel sort.
+    tree.Reorder([](int a, int b) { return (a % 10 != b % 10) ? ((b % 10) - (a % 10)) : (a - b); });
+
+    auto itr = tree.cbegin();
+    ExpectEqual("first element", 9, *itr);
+    ExpectEqual("second element", 19, *(++itr));
+    ExpectEqual("third element", 29, *(++itr));
+    ExpectEqual("last element", 19990, *(--tree.cend()));
+    ExpectEqual("found 12345 under the new order", true, tree.cFind(12345) != tree.cend());
+    ExpectEqual("height of a perfectly balanced tree of 20000", 15U, tree.GetHeight());
+
+    // Only the last digit matters now, so all but one element per digit are duplicates.
+    std::vector<std::unique_ptr<int>> duplicates;
+    tree.Reorder([](int a, int b) { return (a % 10) - (b % 10); }, duplicates);
+
+    ExpectEqual("size", 10U, tree.GetSize());
+    ExpectEqual("duplicates handed back", 19990U, duplicates.size());
+    ExpectEqual("first element, the first 0 in the previous order", 0, *(tree.cbegin()));
+    ExpectValidAvlTree(tree);
+
+    // A comparator that throws leaves the tree as it was, whether it throws sorting, on the pool or not, or looking for duplicates at the very end.
+    for (int size : {100, 20000}) {
+        BST_P::AvlTree<int> original;
+
+        for (int i = 0; i < size; ++i) {
+            original.Insert(i);
+        }
+
+        std::atomic<std::uint64_t> comparisonCount{0U};
+        original.Clone().Reorder([&comparisonCount](int a, int b) { ++comparisonCount; return b - a; });
+
+        for (std::uint64_t throwAt : {std::uint64_t{1U}, comparisonCount / 2U, comparisonCount.load()}) {
+            std::atomic<std::uint64_t> comparisonsLeft{throwAt};
+            ExpectThrow("a throwing comparator to propagate", [&original, &comparisonsLeft]() {
+                original.Reorder([&comparisonsLeft](int a, int b) {
+                    if (--comparisonsLeft == 0U) {
+                        throw std::runtime_error{"Comparator failed."};
+                    }
+
+                    return b - a;
+                });
+            });
+
+            std::vector<int> expected(static_cast<std::size_t>(size));
+            std::iota(expected.begin(), expected.end(), 0);
+            ExpectValidAvlTree(original);
+            ExpectElements(original, expected);
+            ExpectEqual("found under the old order", true, original.cFind(size / 2) != original.cend());
+        }
+    }
+}
+
+void TestAvlTreeSplitAndAppend() {
+    typedef BST_P::AvlTree<int, BST_P::CheckedAccess, BST_P::CountingStats> CountingTree;
+    CountingTree tree;
 
-    std::cout << "Expected height: 2, Actual height: " << tree.GetHeight() << "\n";
+    for (int i = 0; i < 1000; ++i) {
+        tree.Insert(i);
+    }
 
-    for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
-        std::cout << "[" << (*itr) << "] ";
+    auto sixHundred = tree.cFind(600);
+    int const * sixHundredElement = &(*sixHundred);
+    std::uint64_t comparisonCount = tree.GetStats().comparisons;
+    CountingTree upper = tree.SplitOff(sixHundred);
+
+    std::vector<int> lowerElements(600);
+    std::iota(lowerElements.begin(), lowerElements.end(), 0);
+    std::vector<int> upperElements(400);
+    std::iota(upperElements.begin(), upperElements.end(), 600);
+    ExpectValidAvlTree(tree);
+    ExpectValidAvlTree(upper);
+    ExpectElements(tree, lowerElements);
+    ExpectElements(upper, upperElements);
+    ExpectEqual("comparisons made splitting", comparisonCount, tree.GetStats().comparisons);
+    ExpectEqual("the split point's node to have moved over as it was", sixHundredElement, &(*(upper.cbegin())));
+    ExpectEqual("found 599 below the split", true, tree.cFind(599) != tree.cend());
+    ExpectEqual("found 600 above the split", true, upper.cFind(600) != upper.cend());
+
+    ExpectEqual("nothing split off at end()", true, tree.SplitOff(tree.cend()).IsEmpty());
+    ExpectEqual("size after splitting off nothing", 600U, tree.GetSize());
+
+    tree.Append(std::move(upper));
+    lowerElements.insert(lowerElements.end(), upperElements.cbegin(), upperElements.cend());
+    ExpectValidAvlTree(tree);
+    ExpectElements(tree, lowerElements);
+    ExpectEqual("height of a perfectly balanced tree of 1000", 10U, tree.GetHeight());
+    ExpectEqual("size of the tree appended", 0U, upper.GetSize());
+    upper.Insert(2000);
+    ExpectElements(upper, {2000});
+
+    // Tombstones don't survive either, since both relink the tree from scratch.
+    tree.SetRelaxedBalancing(true);
+    for (int i = 0; i < 1000; i += 2) {
+        tree.Remove(i);
     }
 
-    std::cout << "\nAttempting to remove 3. Expected result: false, Actual result: " << (tree.Remove(3) ? "true" : "false") << "\n";
+    CountingTree relaxedUpper = tree.SplitOff(tree.cFind(501));
+    ExpectEqual("tombstones left below", 0U, tree.GetTombstoneCount());
+    ExpectEqual("size below", 250U, tree.GetSize());
+    ExpectEqual("size above", 250U, relaxedUpper.GetSize());
+    tree.Append(std::move(relaxedUpper));
+    tree.SetRelaxedBalancing(false);
+    ExpectValidAvlTree(tree);
+    ExpectEqual("size once appended back", 500U, tree.GetSize());
+}
 
-    std::cout << "Expecting no changes from the previous prints...\nExpected height: 2, Actual height: " << tree.GetHeight() << "\n";
+void TestAvlTreeSaveAndLoad() {
+    BST_P::AvlTree<int> tree;
 
-    for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
-        std::cout << "[" << (*itr) << "] ";
+    for (int i = 0; i < 1000; ++i) {
+        tree.Insert((i * 7) % 1000);
     }
 
-    std::cout << "\nAttempting to remove 1. Expected result: true, Actual result: " << (tree.Remove(1) ? "true" : "false") << "\n";
+    std::stringstream saved;
+    tree.Save(saved);
 
-    std::cout << "Expected height: 1, Actual height: " << tree.GetHeight() << "\n";
+    BST_P::AvlTree<int> loaded;
+    loaded.Insert(-1);
+    loaded.Load(saved);
 
-    for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
-        std::cout << "[" << (*itr) << "] ";
+    bool isSame = loaded.GetSize() == tree.GetSize();
+    for (auto a = tree.cbegin(), b = loaded.cbegin(); isSame && (a != tree.cend()); ++a, ++b) {
+        isSame = *a == *b;
     }
 
-    std::cout << "\nAttempting to remove 2. Expected result: true, Actual result: " << (tree.Remove(2) ? "true" : "false") << "\n";
+    ExpectEqual("loaded tree to match the saved one", true, isSame);
+    ExpectEqual("loaded height of a perfectly balanced tree of 1000", 10U, loaded.GetHeight());
+    ExpectValidAvlTree(loaded);
+
+    std::string corrupted = saved.str();
+    corrupted[100] ^= 1;
+    std::stringstream corruptedStream{corrupted};
+
+    ExpectThrow("corruption to be caught", [&loaded, &corruptedStream]() { loaded.Load(corruptedStream); });
+    ExpectEqual("size after failing to load", 1000U, loaded.GetSize());
+
+    std::stringstream truncatedStream{saved.str().substr(0U, 50U)};
+    ExpectThrow("truncation to be caught", [&loaded, &truncatedStream]() { loaded.Load(truncatedStream); });
+
+    // Elements that aren't trivially copyable need a codec of their own.
+    struct StringCodec {
+        void Encode(std::ostream & stream, std::string const & element) const {
+            BST_P::WriteLittleEndian(stream, element.size(), 4U);
+            stream.write(element.data(), static_cast<std::streamsize>(element.size()));
+        }
+
+        std::string Decode(std::istream & stream) const {
+            std::string element(static_cast<std::size_t>(BST_P::ReadLittleEndian(stream, 4U)), '\0');
+            stream.read(element.data(), static_cast<std::streamsize>(element.size()));
+            return element;
+        }
+    };
+
+    auto compareStrings = [](std::string const & a, std::string const & b) { return a.compare(b); };
+    BST_P::AvlTree<std::string> words{compareStrings};
+    for (char const * word : {"pidgey", "abra", "zubat", "mew"}) {
+        words.Insert(word);
+    }
 
-    std::cout << "Expected height: 0, Actual height: " << tree.GetHeight() << "\nExpecting an empty list below...\n";
+    std::stringstream savedWords;
+    words.Save(savedWords, StringCodec{});
+    BST_P::AvlTree<std::string> loadedWords{compareStrings};
+    loadedWords.Load(savedWords, StringCodec{});
 
-    for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
-        std::cout << "[" << (*itr) << "] ";
+    ExpectElements(loadedWords, {"abra", "mew", "pidgey", "zubat"});
+}
+
+void TestMappedAvlTree() {
+    char const * imagePath = "mapped-avl-tree-test.img";
+    BST_P::AvlTree<int> tree;
+
+    for (int i = 0; i < 1000; ++i) {
+        tree.Insert(i * 3);
     }
 
-    std::cout << "\n";
+    {
+        std::ofstream image{imagePath, std::ios::binary | std::ios::trunc};
+        BST_P::MappedAvlTree<int>::WriteImage(tree, image);
+    }
 
-    tree.Insert(1);
-    tree.Insert(2);
-    tree.Insert(4);
-    tree.Insert(8);
-    tree.Insert(0);
+    {
+        // Each node is two 8-byte offsets and the int, padded out to the node size the header gives. The padding has to be written as zeros.
+        std::ifstream image{imagePath, std::ios::binary};
+        std::vector<char> bytes{std::istreambuf_iterator<char>{image}, std::istreambuf_iterator<char>{}};
+        std::uint32_t nodeSize = 0U;
+        std::memcpy(&nodeSize, bytes.data() + 8, sizeof(nodeSize));
+
+        bool isPaddingZeroed = true;
+        for (std::size_t node = 64U; node + nodeSize <= bytes.size(); node += nodeSize) {
+            for (std::size_t i = 16U + sizeof(int); i < nodeSize; ++i) {
+                isPaddingZeroed = isPaddingZeroed && (bytes[node + i] == 0);
+            }
+        }
+
+        ExpectEqual("image node size", std::uint32_t{24U}, nodeSize);
+        ExpectEqual("image padding to be zeroed", true, isPaddingZeroed);
+    }
 
-    tree.Insert(3);
-    tree.Insert(5);
-    tree.Insert(7);
-    tree.Insert(9);
-    tree.Insert(6);
+    {
+        BST_P::MappedAvlTree<int> mapped{imagePath};
+
+        bool isSame = mapped.GetSize() == tree.GetSize();
+        auto a = tree.cbegin();
+        for (auto b = mapped.cbegin(); isSame && (b != mapped.cend()); ++a, ++b) {
+            isSame = *a == *b;
+        }
+
+        ExpectEqual("mapped tree to match the written one", true, isSame);
+        ExpectEqual("found 2997", true, mapped.Contains(2997));
+        ExpectEqual("found 2998", false, mapped.Contains(2998));
+        ExpectEqual("lower bound of 1000", 1002, *(mapped.LowerBound(1000)));
+        ExpectEqual("lower bound of 3000 to be end()", true, mapped.LowerBound(3000) == mapped.cend());
+    }
+
+    struct Wide {
+        long long high;
+        long long low;
+    };
+
+    ExpectThrow("mapping as the wrong element type to be caught", [imagePath]() {
+        BST_P::MappedAvlTree<Wide> mappedAsWide{imagePath, [](Wide const & a, Wide const & b) { return (a.high != b.high) ? ((a.high < b.high) ? -1 : 1) : ((a.low < b.low) ? -1 : ((a.low > b.low) ? 1 : 0)); }};
+    });
+
+    std::remove(imagePath);
+}
 
-    std::cout << "Expected height: 4, Actual height: " << tree.GetHeight() << "\n";
+void TestAvlTreeCheckingPolicies() {
+    BST_P::AvlTree<int> checked;
+    checked.Insert(1);
 
-    for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
-        std::cout << "[" << (*itr) << "] ";
+    bool isEndCaught = false;
+
+    try {
+        (void)*(checked.cend());
+    } catch (std::out_of_range const &) {
+        isEndCaught = true;
     }
 
-    std::cout << "\n";
+    ExpectEqual("dereferencing end() to throw std::out_of_range", true, isEndCaught);
+
+    BST_P::AvlTree<int, BST_P::UncheckedAccess> unchecked;
 
-    auto eitr = tree.end();
-    for (--eitr; eitr != tree.begin(); --eitr) {
-        std::cout << "[" << (*eitr) << "] ";
+    for (int i = 0; i < 100; ++i) {
+        unchecked.Insert(i);
     }
 
-    std::cout << "[" << (*eitr) << "] \n";
+    int sum = 0;
+    for (int element : unchecked) {
+        sum += element;
+    }
 
-    tree.Insert(10);
-    tree.Insert(11);
-    tree.Insert(12);
-    tree.Insert(13);
-    tree.Insert(14);
-    tree.Insert(100);
+    ExpectEqual("sum over an unchecked tree", 4950, sum);
+    ExpectValidAvlTree(unchecked);
+}
 
-    std::cout << "Expected height: 5, Actual height: " << tree.GetHeight() << "\n";
+namespace {
+    constexpr BST_P::StaticAvlTree<int, 16> BuildStaticTree() {
+        BST_P::StaticAvlTree<int, 16> tree;
 
-    for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
-        std::cout << "[" << (*itr) << "] ";
+        for (int i = 0; i < 16; ++i) {
+            tree.Insert((i * 7) % 16);
+        }
+
+        return tree;
     }
 
-    std::cout << "\n";
+    consteval std::array<int, 5> BuildStatThresholds() {
+        BST_P::StaticAvlTree<int, 8> tree;
+
+        for (int threshold : {300, 100, 500, 200, 400, 100}) {
+            tree.Insert(threshold);
+        }
 
-    eitr = tree.end();
-    for (--eitr; eitr != tree.begin(); --eitr) {
-        std::cout << "[" << (*eitr) << "] ";
+        return tree.Freeze<5>();
     }
 
-    std::cout << "[" << (*eitr) << "] \n";
+    constexpr BST_P::StaticAvlTree<int, 16> STATIC_TREE = BuildStaticTree();
+    constexpr std::array<int, 5> STAT_THRESHOLDS = BuildStatThresholds();
 
-    tree.Remove(3);
+    static_assert(STATIC_TREE.GetSize() == 16U);
+    static_assert(STATIC_TREE.GetHeight() == 5U);
+    static_assert(STATIC_TREE.Contains(11) && !STATIC_TREE.Contains(16));
+    static_assert((*STATIC_TREE.cbegin() == 0) && (*--STATIC_TREE.cend() == 15));
+    static_assert((STAT_THRESHOLDS[0] == 100) && (STAT_THRESHOLDS[2] == 300) && (STAT_THRESHOLDS[4] == 500));
+}
+
+void TestStaticAvlTree() {
+    std::vector<int> expected(16U);
+    std::iota(expected.begin(), expected.end(), 0);
+
+    ExpectElements(STATIC_TREE, expected);
+    ExpectEqual("frozen thresholds", std::vector<int>{100, 200, 300, 400, 500}, std::vector<int>{STAT_THRESHOLDS.cbegin(), STAT_THRESHOLDS.cend()});
+
+    BST_P::StaticAvlTree<int, 2> full;
+    full.Insert(1);
+    full.Insert(2);
 
-    std::cout << "Expected height: 5, Actual height: " << tree.GetHeight() << "\n";
+    bool isFullCaught = false;
 
-    for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
-        std::cout << "[" << (*itr) << "] ";
+    try {
+        full.Insert(3);
+    } catch (std::length_error const &) {
+        isFullCaught = true;
     }
 
-    std::cout << "\n";
+    ExpectEqual("inserting into a full tree to throw std::length_error", true, isFullCaught);
+}
+
+void TestAvlTreeStats() {
+    BST_P::AvlTree<int, BST_P::CheckedAccess, BST_P::CountingStats> tree;
 
-    eitr = tree.end();
-    for (--eitr; eitr != tree.begin(); --eitr) {
-        std::cout << "[" << (*eitr) << "] ";
+    // Ascending insertions only ever need single rotations.
+    for (int i = 0; i < 127; ++i) {
+        tree.Insert(i);
     }
 
-    std::cout << "[" << (*eitr) << "] \n";
+    BST_P::AvlTreeStats stats = tree.GetStats();
 
-    tree.Remove(12);
+    ExpectEqual("nodes allocated", 127U, stats.nodesAllocated);
+    ExpectEqual("single rotations", 120U, stats.singleRotations);
+    ExpectEqual("double rotations", 0U, stats.doubleRotations);
+    ExpectEqual("height", 7U, stats.height);
+    ExpectEqual("ideal height", 7U, stats.idealHeight);
 
-    std::cout << "Expected height: 4, Actual height: " << tree.GetHeight() << "\n";
+    tree.ResetStats();
+    (void)tree.Find(63);
 
-    for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
-        std::cout << "[" << (*itr) << "] ";
+    stats = tree.GetStats();
+    ExpectEqual("comparisons to find the root", 1U, stats.comparisons);
+
+    tree.Insert(63);
+    tree.Remove(0);
+
+    stats = tree.GetStats();
+    ExpectEqual("nodes freed after a duplicate insert and a removal", 2U, stats.nodesFreed);
+    ExpectEqual("retraces", 1U, stats.retraces);
+    ExpectEqual("the memory footprint to cover the elements", true, stats.memoryFootprint > 126U * sizeof(int));
+}
+
+void TestComparisonCache() {
+    using BST_P::RankingAnswer;
+    BST_P::ComparisonCache cache{6U};
+
+    ExpectTrue("recording 0 > 1", cache.Record(0U, 1U, RankingAnswer::Higher));
+    ExpectTrue("recording 2 < 1", cache.Record(2U, 1U, RankingAnswer::Lower));
+    ExpectTrue("0 > 2 to be implied", cache.Find(0U, 2U) == std::optional{RankingAnswer::Higher});
+    ExpectTrue("2 < 0 to be implied", cache.Find(2U, 0U) == std::optional{RankingAnswer::Lower});
+    ExpectTrue("nothing to be known about 3", !cache.Find(3U, 0U).has_value());
+    ExpectTrue("nothing to be known about an item the cache doesn't have", !cache.Find(6U, 0U).has_value());
+
+    ExpectTrue("an implied answer not to be recorded again", !cache.Record(0U, 2U, RankingAnswer::Higher));
+    ExpectTrue("an answer contradicting an implied one to be rejected", !cache.Record(2U, 0U, RankingAnswer::Higher));
+    ExpectTrue("an answer contradicting a recorded one to be rejected", !cache.Record(1U, 0U, RankingAnswer::Higher));
+    ExpectTrue("a skip not to be recorded", !cache.Record(3U, 4U, RankingAnswer::Skip));
+    ExpectTrue("comparing an item to itself not to be recorded", !cache.Record(3U, 3U, RankingAnswer::Higher));
+    ExpectThrow("recording an item the cache doesn't have to throw", [&cache]() { cache.Record(6U, 0U, RankingAnswer::Higher); });
+    ExpectEqual("answer count", 2U, cache.GetAnswerCount());
+    ExpectTrue("a rejected answer to leave what's known alone", cache.Find(0U, 2U) == std::optional{RankingAnswer::Higher});
+
+    // 0 > 3 > 4 gives 0 > 4, which holds without 1, while 0 > 2 only held through 1.
+    ExpectTrue("recording 3 > 4", cache.Record(3U, 4U, RankingAnswer::Higher));
+    ExpectTrue("recording 0 > 3", cache.Record(0U, 3U, RankingAnswer::Higher));
+    ExpectTrue("recording 5 < 2", cache.Record(5U, 2U, RankingAnswer::Lower));
+    ExpectTrue("0 > 5 to be implied through 1 and 2", cache.Find(0U, 5U) == std::optional{RankingAnswer::Higher});
+
+    cache.Forget(1U);
+
+    ExpectEqual("answer count after forgetting 1", 3U, cache.GetAnswerCount());
+    ExpectTrue("nothing to be known about 1 after forgetting it", !cache.Find(1U, 0U).has_value() && !cache.Find(2U, 1U).has_value());
+    ExpectTrue("0 > 2 to be forgotten along with 1", !cache.Find(0U, 2U).has_value());
+    ExpectTrue("0 > 5 to be forgotten along with 1", !cache.Find(0U, 5U).has_value());
+    ExpectTrue("0 > 4 to outlive 1", cache.Find(0U, 4U) == std::optional{RankingAnswer::Higher});
+    ExpectTrue("2 > 5 to outlive 1", cache.Find(2U, 5U) == std::optional{RankingAnswer::Higher});
+    ExpectTrue("recording 2 > 0 once nothing contradicts it", cache.Record(2U, 0U, RankingAnswer::Higher));
+    ExpectTrue("2 > 4 to be implied", cache.Find(2U, 4U) == std::optional{RankingAnswer::Higher});
+
+    std::size_t askedCount = 0U;
+    BST_P::RankingOracle oracle = BST_P::MakeCachedOracle(cache, [&askedCount](BST_P::RankingItem item, BST_P::RankingItem rankedItem) {
+        ++askedCount;
+        return (item > rankedItem) ? RankingAnswer::Higher : RankingAnswer::Lower;
+    });
+
+    ExpectTrue("the cached oracle to answer from the cache", oracle(4U, 2U) == RankingAnswer::Lower);
+    ExpectTrue("the cached oracle to ask about 1", oracle(1U, 4U) == RankingAnswer::Lower);
+    ExpectTrue("the cached oracle to remember the answer about 1", oracle(4U, 1U) == RankingAnswer::Higher);
+    ExpectEqual("questions asked", 1U, askedCount);
+}
+
+void TestReadRecordedAnswers() {
+    using BST_P::RankingAnswer;
+    std::stringstream answers;
+    BST_P::RecordAnswer(answers, 3U, 1U, RankingAnswer::Higher);
+    BST_P::RecordAnswer(answers, 2U, 4U, RankingAnswer::Skip);
+    answers << "\n";
+    BST_P::RecordAnswer(answers, 0U, 3U, RankingAnswer::Lower);
+
+    std::vector<BST_P::RecordedAnswer> recorded = BST_P::ReadRecordedAnswers(answers);
+
+    ExpectEqual("recorded answer count", 2U, recorded.size());
+
+    if (recorded.size() == 2U) {
+        ExpectTrue("the first answer", (recorded[0].item == 3U) && (recorded[0].rankedItem == 1U) && (recorded[0].answer == RankingAnswer::Higher));
+        ExpectTrue("the second answer", (recorded[1].item == 0U) && (recorded[1].rankedItem == 3U) && (recorded[1].answer == RankingAnswer::Lower));
     }
 
-    std::cout << "\n";
+    answers.clear();
+    answers.seekg(0);
+    BST_P::RankingOracle oracle = BST_P::MakeReplayOracle(answers);
+
+    ExpectTrue("replaying an answer", oracle(3U, 1U) == RankingAnswer::Higher);
+    ExpectTrue("replaying an answer the other way round", oracle(3U, 0U) == RankingAnswer::Higher);
+    ExpectThrow("replaying a pair that was never answered to throw", [&oracle]() { (void)oracle(1U, 0U); });
+
+    char const * const malformedAnswers[] = {"1 2 ?\n", "1 >\n", "1 x <\n", "1 4294967296 >\n", "0 1 >\n2 2\n"};
+
+    for (char const * malformed : malformedAnswers) {
+        std::istringstream stream{malformed};
+        ExpectThrow("reading a malformed answer to throw", [&stream]() { (void)BST_P::ReadRecordedAnswers(stream); });
+    }
+}
+
+void TestRankingEngineSaveAndLoad() {
+    constexpr std::size_t ITEM_COUNT = 40U;
+    std::vector<std::uint32_t> scores(ITEM_COUNT);
+
+    for (std::size_t i = 0U; i < ITEM_COUNT; ++i) {
+        scores[i] = static_cast<std::uint32_t>((i * 17U) % ITEM_COUNT);
+    }
+
+    BST_P::RankingOracle oracle = BST_P::MakeGroundTruthOracle(scores);
+    BST_P::TrivialElementCodec<BST_P::RankingItem> codec;
+    BST_P::RankingEngine engine{ITEM_COUNT, 7U};
+
+    for (int i = 0; i < 15; ++i) {
+        (void)engine.PlaceNext(oracle);
+    }
+
+    std::stringstream saved;
+    engine.Save(saved, codec);
+
+    BST_P::RankingEngine loadedEngine{ITEM_COUNT, 11U};
+    loadedEngine.Load(saved, codec);
+
+    std::vector<BST_P::RankingItem> ranked(engine.GetRanking().cbegin(), engine.GetRanking().cend());
+    ExpectElements(loadedEngine.GetRanking(), ranked);
+    ExpectEqual("pool size after loading", engine.GetPoolSize(), loadedEngine.GetPoolSize());
+
+    for (BST_P::RankingItem item = 0U; item < ITEM_COUNT; ++item) {
+        ExpectEqual("whether an item is ranked after loading", engine.IsRanked(item), loadedEngine.IsRanked(item));
+    }
+
+    // A ranking that holds an item the engine doesn't have can't be loaded.
+    BST_P::RankingEngine smallEngine{ITEM_COUNT / 2U, 7U};
+    (void)smallEngine.PlaceNext(oracle);
+    saved.clear();
+    saved.seekg(0);
+    ExpectThrow("loading a ranking of other items to throw", [&]() { smallEngine.Load(saved, codec); });
+    ExpectEqual("ranked items after a failed load", 1U, smallEngine.GetRanking().GetSize());
+    ExpectEqual("pool size after a failed load", (ITEM_COUNT / 2U) - 1U, smallEngine.GetPoolSize());
+
+    std::istringstream truncated{saved.str().substr(0U, saved.str().size() / 2U)};
+    ExpectThrow("loading a truncated ranking to throw", [&]() { loadedEngine.Load(truncated, codec); });
+    ExpectElements(loadedEngine.GetRanking(), ranked);
+
+    while (!loadedEngine.IsDone()) {
+        (void)loadedEngine.PlaceNext(oracle);
+    }
+
+    std::vector<BST_P::RankingItem> expected(ITEM_COUNT);
+    std::iota(expected.begin(), expected.end(), 0U);
+    std::sort(expected.begin(), expected.end(), [&scores](BST_P::RankingItem a, BST_P::RankingItem b) { return scores[a] < scores[b]; });
+    ExpectElements(loadedEngine.GetRanking(), expected);
+}
+
+void TestForgetOutlivesRestart() {
+    using BST_P::RankingAnswer;
+    constexpr std::size_t ITEM_COUNT = 12U;
+    constexpr BST_P::RankingItem FORGOTTEN_ITEM = 5U;
+    std::vector<std::uint32_t> scores(ITEM_COUNT);
+    std::iota(scores.begin(), scores.end(), 0U);
+
+    BST_P::RankingOracle truth = BST_P::MakeGroundTruthOracle(scores);
+    BST_P::TrivialElementCodec<BST_P::RankingItem> codec;
+    std::stringstream answers;
+    std::stringstream saved;
+
+    {
+        BST_P::ComparisonCache cache{ITEM_COUNT};
+        BST_P::RankingEngine engine{ITEM_COUNT, 3U};
+        BST_P::RankingOracle oracle = BST_P::MakeCachedOracle(cache, [&truth, &answers](BST_P::RankingItem item, BST_P::RankingItem rankedItem) {
+            RankingAnswer answer = truth(item, rankedItem);
+            BST_P::RecordAnswer(answers, item, rankedItem, answer);
+            return answer;
+        });
+
+        while (!engine.IsDone()) {
+            (void)engine.PlaceNext(oracle);
+        }
+
+        ExpectTrue("unranking the item to forget", engine.Unrank(FORGOTTEN_ITEM));
+        cache.Forget(FORGOTTEN_ITEM);
+        BST_P::RecordForget(answers, FORGOTTEN_ITEM);
+        engine.Save(saved, codec);
+    }
+
+    // Picks up the way the game does: the saved ranking, plus every recorded answer replayed newest first.
+    std::vector<BST_P::RecordedAnswer> recorded = BST_P::ReadRecordedAnswers(answers);
+    BST_P::ComparisonCache cache{ITEM_COUNT};
+
+    for (auto answer = recorded.crbegin(); answer != recorded.crend(); ++answer) {
+        ExpectTrue("no replayed answer to be about the forgotten item", (answer->item != FORGOTTEN_ITEM) && (answer->rankedItem != FORGOTTEN_ITEM));
+        cache.Record(answer->item, answer->rankedItem, answer->answer);
+    }
+
+    BST_P::RankingEngine engine{ITEM_COUNT, 3U};
+    engine.Load(saved, codec);
+    ExpectEqual("pool size after picking up", 1U, engine.GetPoolSize());
+
+    std::size_t askedCount = 0U;
+    BST_P::RankingOracle oracle = BST_P::MakeCachedOracle(cache, [&truth, &askedCount](BST_P::RankingItem item, BST_P::RankingItem rankedItem) {
+        ++askedCount;
+        return truth(item, rankedItem);
+    });
+
+    (void)engine.PlaceNext(oracle);
+
+    ExpectTrue("the forgotten item to be asked about again", askedCount > 0U);
+    ExpectTrue("the ranking to be done", engine.IsDone());
+
+    std::vector<BST_P::RankingItem> expected(ITEM_COUNT);
+    std::iota(expected.begin(), expected.end(), 0U);
+    ExpectElements(engine.GetRanking(), expected);
+
+    std::istringstream forgottenTwice{"0 1 >\n2 1 <\n- 1\n1 2 >\n- 1\n3 0 >\n"};
+    recorded = BST_P::ReadRecordedAnswers(forgottenTwice);
+    ExpectEqual("answers left after forgetting 1 twice", 1U, recorded.size());
+    ExpectTrue("the answer left to be the one not about 1", !recorded.empty() && (recorded[0].item == 3U) && (recorded[0].rankedItem == 0U));
+    std::istringstream malformedForget{"0 1 >\n- x\n"};
+    ExpectThrow("reading a malformed forget to throw", [&malformedForget]() { (void)BST_P::ReadRecordedAnswers(malformedForget); });
+}
 
-    eitr = tree.end();
-    for (--eitr; eitr != tree.begin(); --eitr) {
-        std::cout << "[" << (*eitr) << "] ";
+int RunAvlTreeTests() {
+    struct NamedTest {
+        char const * name;
+        void (*run)();
+    };
+
+    NamedTest const tests[] = {
+        {"TestAvlTree", TestAvlTree},
+        {"TestAvlTreeAgain", TestAvlTreeAgain},
+        {"TestAvlTreeFromWikipedia", TestAvlTreeFromWikipedia},
+        {"TestAvlTreeRemoveAndEmplace", TestAvlTreeRemoveAndEmplace},
+        {"TestAvlTreeAgainstStdSet", TestAvlTreeAgainstStdSet},
+        {"TestRelaxedAvlTreeAgainstStdSet", TestRelaxedAvlTreeAgainstStdSet},
+        {"TestAvlTreeEmplaceBefore", TestAvlTreeEmplaceBefore},
+        {"TestAvlTreeEmplaceAsync", TestAvlTreeEmplaceAsync},
+        {"TestAvlTreeComplexity", TestAvlTreeComplexity},
+        {"TestAvlTreeCloneAndCopyOnWrite", TestAvlTreeCloneAndCopyOnWrite},
+        {"TestPersistentAvlTree", TestPersistentAvlTree},
+        {"TestRcuAvlTree", TestRcuAvlTree},
+        {"TestConcurrentAvlTree", TestConcurrentAvlTree},
+        {"TestShardedAvlTree", TestShardedAvlTree},
+        {"TestAvlTreeParallelTraversal", TestAvlTreeParallelTraversal},
+        {"TestAvlTreeRelaxedBalancing", TestAvlTreeRelaxedBalancing},
+        {"TestAvlTreeReorder", TestAvlTreeReorder},
+        {"TestAvlTreeSplitAndAppend", TestAvlTreeSplitAndAppend},
+        {"TestAvlTreeSaveAndLoad", TestAvlTreeSaveAndLoad},
+        {"TestMappedAvlTree", TestMappedAvlTree},
+        {"TestAvlTreeCheckingPolicies", TestAvlTreeCheckingPolicies},
+        {"TestStaticAvlTree", TestStaticAvlTree},
+        {"TestAvlTreeStats", TestAvlTreeStats},
+        {"TestComparisonCache", TestComparisonCache},
+        {"TestReadRecordedAnswers", TestReadRecordedAnswers},
+        {"TestRankingEngineSaveAndLoad", TestRankingEngineSaveAndLoad},
+        {"TestForgetOutlivesRestart", TestForgetOutlivesRestart},
+    };
+
+    int failedTestCount = 0;
+
+    for (NamedTest const & test : tests) {
+        currentTest = test.name;
+        currentFailureCount = 0;
+
+        try {
+            test.run();
+        } catch (std::exception const & exception) {
+            ++currentFailureCount;
+            std::cout << currentTest << ": Unexpected exception: " << exception.what() << "\n";
+        }
+
+        std::cout << ((currentFailureCount == 0) ? "[PASSED] " : "[FAILED] ") << test.name << "\n";
+        failedTestCount += (currentFailureCount == 0) ? 0 : 1;
     }
 
-    std::cout << "[" << (*eitr) << "] \n";
+    std::cout << (sizeof(tests) / sizeof(tests[0])) - static_cast<std::size_t>(failedTestCount) << " of " << (sizeof(tests) / sizeof(tests[0])) << " tests passed.\n";
+    return failedTestCount;
 }
@@ -4,3 +4,24 @@ void TestAvlTree();
 void TestAvlTreeAgain();
 void TestAvlTreeFromWikipedia();
 void TestAvlTreeRemoveAndEmplace();
+void TestAvlTreeAgainstStdSet();
+void TestRelaxedAvlTreeAgainstStdSet();
+void TestAvlTreeEmplaceBefore();
+void TestAvlTreeEmplaceAsync();
+void TestAvlTreeComplexity();
+void TestAvlTreeCloneAndCopyOnWrite();
+void TestPersistentAvlTree();
+void TestRcuAvlTree();
+void TestConcurrentAvlTree();
+void TestShardedAvlTree();
+void TestAvlTreeParallelTraversal();
+void TestAvlTreeRelaxedBalancing();
+void TestAvlTreeReorder();
+void TestAvlTreeSaveAndLoad();
+void TestMappedAvlTree();
+void TestAvlTreeCheckingPolicies();
+void TestStaticAvlTree();
+void TestAvlTreeStats();
+
+// Runs every test above, printing which passed and what each failure expected. Returns how many failed.
+int RunAvlTreeTests();
@@ -0,0 +1,97 @@
+#include "ComparisonCache.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace BST_P {
+
+ComparisonCache::ComparisonCache(std::size_t itemCount)
+    : _itemCount{itemCount}
+    , _wordsPerRow{(itemCount + 63U) / 64U}
+    , _isHigher(itemCount * ((itemCount + 63U) / 64U), 0U)
+    , _answers{} {
+}
+
+std::optional<RankingAnswer> ComparisonCache::Find(RankingItem item, RankingItem rankedItem) const {
+    if ((item >= _itemCount) || (rankedItem >= _itemCount)) {
+        return std::nullopt;
+    }
+
+    if (IsHigher(item, rankedItem)) {
+        return RankingAnswer::Higher;
+    }
+
+    if (IsHigher(rankedItem, item)) {
+        return RankingAnswer::Lower;
+    }
+
+    return std::nullopt;
+}
+
+bool ComparisonCache::Record(RankingItem item, RankingItem rankedItem, RankingAnswer answer) {
+    if ((item >= _itemCount) || (rankedItem >= _itemCount)) {
+        throw std::out_of_range{"Only the cache's own items can be compared."};
+    }
+
+    if ((answer == RankingAnswer::Skip) || (item == rankedItem) || Find(item, rankedItem).has_value()) {
+        return false;
+    }
+
+    RankingItem higher = (answer == RankingAnswer::Higher) ? item : rankedItem;
+    RankingItem lower = (answer == RankingAnswer::Higher) ? rankedItem : item;
+    _answers.emplace_back(higher, lower);
+    Close(higher, lower);
+
+    return true;
+}
+
+void ComparisonCache::Forget(RankingItem item) {
+    auto forgotten = std::remove_if(_answers.begin(), _answers.end(), [item](std::pair<RankingItem, RankingItem> const & answer) {
+        return (answer.first == item) || (answer.second == item);
+    });
+
+    if (forgotten == _answers.end()) {
+        return;
+    }
+
+    _answers.erase(forgotten, _answers.end());
+    std::fill(_isHigher.begin(), _isHigher.end(), 0U);
+
+    for (auto const & answer : _answers) {
+        Close(answer.first, answer.second);
+    }
+}
+
+void ComparisonCache::Close(RankingItem higher, RankingItem lower) {
+    std::uint64_t const * lowerRow = &_isHigher[lower * _wordsPerRow];
+    std::size_t lowerWord = lower / 64U;
+    std::uint64_t lowerBit = std::uint64_t{1U} << (lower % 64U);
+
+    for (std::size_t a = 0U; a < _itemCount; ++a) {
+        if ((a != higher) && !IsHigher(static_cast<RankingItem>(a), higher)) {
+            continue;
+        }
+
+        std::uint64_t * row = &_isHigher[a * _wordsPerRow];
+
+        for (std::size_t word = 0U; word < _wordsPerRow; ++word) {
+            row[word] |= lowerRow[word];
+        }
+
+        row[lowerWord] |= lowerBit;
+    }
+}
+
+RankingOracle MakeCachedOracle(ComparisonCache & cache, RankingOracle oracle) {
+    return [&cache, oracle = std::move(oracle)](RankingItem item, RankingItem rankedItem) {
+        if (auto known = cache.Find(item, rankedItem)) {
+            return *known;
+        }
+
+        RankingAnswer answer = oracle(item, rankedItem);
+        cache.Record(item, rankedItem, answer);
+
+        return answer;
+    };
+}
+
+}
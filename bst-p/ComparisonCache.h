@@ -0,0 +1,51 @@
+#pragma once
+#include "RankingEngine.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace BST_P {
+    /*
+     * Remembers every answer an oracle gave, and everything those answers imply: if a ranks higher than b and b higher than c, then a ranks higher than c too.
+     * It's kept closed under that as answers are recorded, as a reachability matrix with a row of bits per item, so looking an answer up is a single bit test.
+     * The matrix takes itemCount squared bits, so it's meant for rankings a person answers, not the synthetic datasets the simulator ranks.
+     */
+    class ComparisonCache final {
+    public:
+        explicit ComparisonCache(std::size_t itemCount);
+        ComparisonCache(ComparisonCache const &) = delete;
+        ComparisonCache(ComparisonCache &&) noexcept = delete;
+        ComparisonCache & operator=(ComparisonCache const &) = delete;
+        ComparisonCache & operator=(ComparisonCache &&) noexcept = delete;
+        inline ~ComparisonCache() = default;
+
+        // The answer the oracle gave or implied when asked about item and rankedItem, if any. Never a skip.
+        [[nodiscard]] std::optional<RankingAnswer> Find(RankingItem item, RankingItem rankedItem) const;
+        // Records an answer and everything it implies. Returns false, recording nothing, for a skip, an answer that's already known,
+        // or one that contradicts what's known. Throws std::out_of_range if either item isn't one of the cache's.
+        bool Record(RankingItem item, RankingItem rankedItem, RankingAnswer answer);
+        // Forgets every answer about item, along with whatever was only implied through them.
+        void Forget(RankingItem item);
+
+        [[nodiscard]] inline std::size_t GetItemCount() const { return _itemCount; }
+        // Answers recorded directly, not counting the ones implied by them.
+        [[nodiscard]] inline std::size_t GetAnswerCount() const { return _answers.size(); }
+
+    private:
+        [[nodiscard]] inline bool IsHigher(RankingItem a, RankingItem b) const { return (_isHigher[(a * _wordsPerRow) + (b / 64U)] >> (b % 64U)) & 1U; }
+        // Marks higher, and everything known to rank higher than it, as ranking higher than lower and everything below it.
+        void Close(RankingItem higher, RankingItem lower);
+
+        std::size_t _itemCount;
+        std::size_t _wordsPerRow;
+        // Row a has bit b set if a ranks higher than b.
+        std::vector<std::uint64_t> _isHigher;
+        // Each recorded answer as the item that ranked higher, then the one that ranked lower, so the matrix can be rebuilt without the ones forgotten.
+        std::vector<std::pair<RankingItem, RankingItem>> _answers;
+    };
+
+    // Answers from the cache when it can, and otherwise asks oracle and records what it answers, so oracle is never asked anything it's already answered.
+    [[nodiscard]] RankingOracle MakeCachedOracle(ComparisonCache & cache, RankingOracle oracle);
+}
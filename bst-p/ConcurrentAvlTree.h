@@ -0,0 +1,168 @@
+#pragma once
+#include "AVLTree.h"
+#include "EpochDomain.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+namespace BST_P {
+    /*
+     * An AVL tree that any number of threads may search and update at once, after Bronson, Casper, Chafi and Olukotun's optimistic concurrent AVL tree.
+     *
+     * Searches take no locks. Each node carries a version number that a rotation bumps whenever it moves the node down the tree;
+     * a search validates the version of the node it came from before trusting the child it read, and backs up one level if it changed.
+     * Updates lock only the one or two nodes they change, and rebalancing locks at most the four nodes a rotation touches, always top-down.
+     *
+     * Removing an element with two children only clears its payload and leaves the node behind as a routing node; routing nodes are unlinked
+     * as soon as they're down to one child. Unlinked nodes and replaced payloads are reclaimed through an EpochDomain.
+     *
+     * Because nodes can be unlinked at any time, there are no iterators. Find returns a copy of the element, and ForEach is only exact when no writer is running.
+     */
+    template<class T>
+    class ConcurrentAvlTree final {
+    public:
+        typedef std::int32_t Height;
+        typedef T value_type;
+        typedef value_type const & const_reference;
+        typedef typename AvlTree<T>::CompareFunctor CompareFunctor;
+
+        // Once this many nodes have been retired, the thread that retired the last one frees whatever no search can still reach.
+        static constexpr std::size_t RECLAIM_INTERVAL = 64U;
+
+    private:
+        typedef std::uint64_t Version;
+
+        // A test-and-test-and-set lock. A node lock is held for a handful of pointer writes at most, so spinning beats parking the thread.
+        class NodeLock final {
+        public:
+            void lock();
+            inline void unlock() { _isLocked.store(false, std::memory_order_release); }
+
+        private:
+            std::atomic<bool> _isLocked{false};
+        };
+
+        // Versions, child links and heights use sequentially consistent accesses throughout; the validation argument leans on a single total order.
+        class Node final {
+        public:
+            friend ConcurrentAvlTree;
+
+            static constexpr Version UNLINKED = 0x1U;
+            static constexpr Version SHRINKING = 0x2U;
+            static constexpr Version SHRINK_COUNT_INCREMENT = 0x4U;
+
+            Node(Node const &) = delete;
+            Node(Node &&) noexcept = delete;
+            Node & operator=(Node const &) = delete;
+            Node & operator=(Node &&) noexcept = delete;
+
+            // The node's key is the payload it was created with. It stays put for the node's whole life so searches can route through it even after removal.
+            inline explicit Node(std::unique_ptr<T> && key, Node * parent)
+                : _key{std::move(key)}, _value{_key.get()}, _parent{parent}, _leftChild{nullptr}, _rightChild{nullptr}, _height{1}, _version{0U} {}
+            // Makes the holder node, which has no key and keeps the root as its right child.
+            inline Node() : _key{}, _value{nullptr}, _parent{nullptr}, _leftChild{nullptr}, _rightChild{nullptr}, _height{0}, _version{0U} {}
+            inline ~Node() { T * value = _value.load(std::memory_order_relaxed); if (value != _key.get()) { delete value; } }
+
+            [[nodiscard]] inline Node * GetChild(bool isLeft) const { return (isLeft ? _leftChild : _rightChild).load(); }
+            inline void SetChild(bool isLeft, Node * child) { (isLeft ? _leftChild : _rightChild).store(child); }
+            [[nodiscard]] inline bool IsUnlinked() const { return IsUnlinked(_version.load()); }
+
+            [[nodiscard]] static inline bool IsShrinking(Version version) { return (version & SHRINKING) != 0U; }
+            [[nodiscard]] static inline bool IsUnlinked(Version version) { return (version & UNLINKED) != 0U; }
+            [[nodiscard]] static inline Height HeightOf(Node const * node) { return (node == nullptr) ? 0 : node->_height.load(); }
+
+        private:
+            std::unique_ptr<T> const _key;
+            // Null while the node is only routing. Otherwise either the key itself or a payload emplaced after the key was removed.
+            std::atomic<T *> _value;
+            std::atomic<Node *> _parent;
+            std::atomic<Node *> _leftChild;
+            std::atomic<Node *> _rightChild;
+            std::atomic<Height> _height;
+            std::atomic<Version> _version;
+            NodeLock _lock;
+        };
+
+        enum class AttemptResult { RETRY, CHANGED, UNCHANGED };
+
+        // FixHeight's "height" result doubles as a signal for the cases that need more than a height update.
+        static constexpr Height UNLINK_REQUIRED = -1;
+        static constexpr Height REBALANCE_REQUIRED = -2;
+        static constexpr Height NOTHING_REQUIRED = -3;
+
+    public:
+        explicit ConcurrentAvlTree(CompareFunctor defaultCompare = subtract<value_type>{});
+        ConcurrentAvlTree(ConcurrentAvlTree const &) = delete;
+        ConcurrentAvlTree(ConcurrentAvlTree &&) noexcept = delete;
+        ConcurrentAvlTree & operator=(ConcurrentAvlTree const &) = delete;
+        ConcurrentAvlTree & operator=(ConcurrentAvlTree &&) noexcept = delete;
+        ~ConcurrentAvlTree();
+
+        [[nodiscard]] std::optional<value_type> Find(const_reference dataToFind, CompareFunctor const & specializedCompareFunctor) const;
+        [[nodiscard]] inline std::optional<value_type> Find(const_reference dataToFind) const { return Find(dataToFind, _DefaultCompare); }
+        [[nodiscard]] inline bool Contains(const_reference dataToFind) const { return Find(dataToFind).has_value(); }
+
+        // Visits every element in order. Elements emplaced or removed while this runs may or may not be visited.
+        template<class Visitor> void ForEach(Visitor && visitor) const;
+
+        // Like AvlTree, these return whether the tree was changed: false if an equal element was already there, or if there was nothing to remove.
+        template<class... Args> bool Emplace(CompareFunctor const & emplaceCompareFunctor, Args&&... args);
+        template<class... Args> inline bool DefaultEmplace(Args&&... args) { return Emplace(_DefaultCompare, std::forward<Args>(args)...); }
+        inline bool Insert(const_reference dataToCopyAndInsert, CompareFunctor const & specializedInsertionCompareFunctor) { return Emplace(specializedInsertionCompareFunctor, dataToCopyAndInsert); }
+        inline bool Insert(const_reference dataToCopyAndInsert) { return Emplace(_DefaultCompare, dataToCopyAndInsert); }
+        inline bool Insert(value_type && dataToMoveAndInsert, CompareFunctor const & specializedInsertionCompareFunctor) { return Emplace(specializedInsertionCompareFunctor, std::move(dataToMoveAndInsert)); }
+        inline bool Insert(value_type && dataToMoveAndInsert) { return Emplace(_DefaultCompare, std::move(dataToMoveAndInsert)); }
+
+        bool Remove(const_reference dataToRemove, CompareFunctor const & specializedCompareFunctor);
+        inline bool Remove(const_reference dataToRemove) { return Remove(dataToRemove, _DefaultCompare); }
+
+        // The number of elements and the height are exact only when no writer is running.
+        [[nodiscard]] inline std::size_t GetSize() const { return _size.load(std::memory_order_relaxed); }
+        [[nodiscard]] inline Height GetHeight() const { return Node::HeightOf(_holder->GetChild(false)); }
+        [[nodiscard]] inline bool IsEmpty() const { return GetSize() == 0U; }
+
+        CompareFunctor const & GetDefaultCompare() const { return _DefaultCompare; }
+
+    private:
+        static void WaitUntilNotShrinking(Node * node);
+        static void DestroySubtree(Node * node);
+        template<class Visitor> static void ForEachInSubtree(Node const * node, Visitor & visitor);
+
+        AttemptResult AttemptFind(const_reference dataToFind, CompareFunctor const & Compare, Node * node, Version nodeVersion, bool isGoingLeft, T const *& outputFound) const;
+        // emplaced is null for a removal.
+        AttemptResult AttemptUpdate(const_reference data, CompareFunctor const & Compare, std::unique_ptr<T> & emplaced, Node * parent, Node * node, Version nodeVersion);
+        AttemptResult AttemptNodeUpdate(std::unique_ptr<T> & emplaced, Node * parent, Node * node);
+
+        // The _Locked functions expect the caller to hold the locks of the nodes passed to them, as noted per function.
+        // Requires parent and node locked.
+        bool AttemptUnlink_Locked(Node * parent, Node * node);
+        void RetireValue(Node const * node, T * value);
+        void ReclaimIfDue();
+
+        static Height NodeCondition(Node * node);
+        void FixHeightAndRebalance(Node * node);
+        // Requires node locked. Returns the next node that may need fixing, or null once nothing more needs doing.
+        static Node * FixHeight_Locked(Node * node);
+        // Requires parent and node locked.
+        Node * Rebalance_Locked(Node * parent, Node * node);
+        // Requires parent and node locked; locks heavyChild, and its inner child if a double rotation is needed.
+        Node * RebalanceTowardLightSide_Locked(Node * parent, Node * node, Node * heavyChild, Height lightHeight, bool isLeftHeavy);
+        // Requires parent, node and heavyChild locked. Moves node down toward its light side and heavyChild up into its place.
+        // The rotations unlink any routing node they leave with a single child on the spot, since they already hold the locks that takes.
+        Node * RotateOnce_Locked(Node * parent, Node * node, Node * heavyChild, Height lightHeight, Height outerHeight, Node * innerChild, Height innerHeight, bool isLeftHeavy);
+        // Requires parent, node, heavyChild and innerChild locked. Lifts heavyChild's inner child above both of them.
+        Node * RotateTwice_Locked(Node * parent, Node * node, Node * heavyChild, Height lightHeight, Height outerHeight, Node * innerChild, Height innerNearHeight, bool isLeftHeavy);
+
+        // Declared first so it outlives the holder; the holder's destructor frees live nodes, the domain's destructor frees retired ones.
+        mutable EpochDomain _domain;
+        std::unique_ptr<Node> _holder;
+        std::atomic<std::size_t> _size;
+        std::atomic<std::size_t> _retiredSinceReclaim;
+
+        CompareFunctor _DefaultCompare;
+    };
+}
+
+#include "ConcurrentAvlTree.inl"
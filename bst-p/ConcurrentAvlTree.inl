@@ -0,0 +1,577 @@
+#pragma once
+#include "ConcurrentAvlTree.h"
+#include <algorithm>
+#include <thread>
+
+namespace BST_P {
+    template<class T> void ConcurrentAvlTree<T>::NodeLock::lock() {
+        for (unsigned int spins = 0U; _isLocked.exchange(true, std::memory_order_acquire);) {
+            while (_isLocked.load(std::memory_order_relaxed)) {
+                if (++spins > 64U) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    template<class T> ConcurrentAvlTree<T>::ConcurrentAvlTree(CompareFunctor defaultCompare)
+        : _domain{}
+        , _holder{std::make_unique<Node>()}
+        , _size{0U}
+        , _retiredSinceReclaim{0U}
+        , _DefaultCompare{std::move(defaultCompare)} {}
+
+    template<class T> ConcurrentAvlTree<T>::~ConcurrentAvlTree() {
+        DestroySubtree(_holder->GetChild(false));
+    }
+
+    template<class T> void ConcurrentAvlTree<T>::DestroySubtree(Node * node) {
+        // The tree is balanced, so the recursion is only O(log n) deep.
+        if (node != nullptr) {
+            DestroySubtree(node->GetChild(true));
+            DestroySubtree(node->GetChild(false));
+            delete node;
+        }
+    }
+
+    template<class T> void ConcurrentAvlTree<T>::WaitUntilNotShrinking(Node * node) {
+        for (int spins = 0; spins < 100; ++spins) {
+            if (!Node::IsShrinking(node->_version.load())) {
+                return;
+            }
+        }
+
+        // A shrinking node is locked for the whole rotation, so waiting on its lock waits out the rotation.
+        std::lock_guard<NodeLock> lock{node->_lock};
+    }
+
+    template<class T> std::optional<T> ConcurrentAvlTree<T>::Find(const_reference dataToFind, CompareFunctor const & Compare) const {
+        EpochDomain::ReadGuard guard = _domain.EnterRead();
+        T const * found = nullptr;
+
+        while (AttemptFind(dataToFind, Compare, _holder.get(), _holder->_version.load(), false, found) == AttemptResult::RETRY) {}
+
+        // Copy while still inside the read section; the payload may be retired the moment we leave it.
+        return (found == nullptr) ? std::nullopt : std::optional<T>{*found};
+    }
+
+    template<class T> typename ConcurrentAvlTree<T>::AttemptResult ConcurrentAvlTree<T>::AttemptFind(
+        const_reference dataToFind, CompareFunctor const & Compare, Node * node, Version nodeVersion, bool isGoingLeft, T const *& outputFound
+    ) const {
+        for (;;) {
+            Node * child = node->GetChild(isGoingLeft);
+
+            // The child we just read is only trustworthy if node hasn't been rotated down since we arrived at it.
+            if (node->_version.load() != nodeVersion) {
+                return AttemptResult::RETRY;
+            }
+
+            if (child == nullptr) {
+                outputFound = nullptr;
+                return AttemptResult::UNCHANGED;
+            }
+
+            int comparison = Compare(dataToFind, *(child->_key));
+
+            if (comparison == 0) {
+                outputFound = child->_value.load();
+                return AttemptResult::UNCHANGED;
+            }
+
+            Version childVersion = child->_version.load();
+
+            if (Node::IsShrinking(childVersion)) {
+                WaitUntilNotShrinking(child);
+            } else if (!Node::IsUnlinked(childVersion) && (child == node->GetChild(isGoingLeft))) {
+                if (node->_version.load() != nodeVersion) {
+                    return AttemptResult::RETRY;
+                }
+
+                AttemptResult result = AttemptFind(dataToFind, Compare, child, childVersion, comparison < 0, outputFound);
+
+                if (result != AttemptResult::RETRY) {
+                    return result;
+                }
+            }
+
+            // Otherwise the child changed under us; read it again from this node.
+        }
+    }
+
+    template<class T> template<class Visitor> void ConcurrentAvlTree<T>::ForEach(Visitor && visitor) const {
+        EpochDomain::ReadGuard guard = _domain.EnterRead();
+        ForEachInSubtree(_holder->GetChild(false), visitor);
+    }
+
+    template<class T> template<class Visitor> void ConcurrentAvlTree<T>::ForEachInSubtree(Node const * node, Visitor & visitor) {
+        if (node == nullptr) {
+            return;
+        }
+
+        ForEachInSubtree(node->GetChild(true), visitor);
+
+        if (T const * value = node->_value.load()) {
+            visitor(*value);
+        }
+
+        ForEachInSubtree(node->GetChild(false), visitor);
+    }
+
+    template<class T> template<class... Args> bool ConcurrentAvlTree<T>::Emplace(CompareFunctor const & Compare, Args&&... args) {
+        std::unique_ptr<T> emplaced = std::make_unique<T>(std::forward<Args>(args)...);
+        T const & data = *emplaced;
+        AttemptResult result;
+
+        {
+            EpochDomain::ReadGuard guard = _domain.EnterRead();
+
+            do {
+                result = AttemptUpdate(data, Compare, emplaced, nullptr, _holder.get(), _holder->_version.load());
+            } while (result == AttemptResult::RETRY);
+        }
+
+        if (result == AttemptResult::CHANGED) {
+            _size.fetch_add(1U, std::memory_order_relaxed);
+        }
+
+        ReclaimIfDue();
+        return result == AttemptResult::CHANGED;
+    }
+
+    template<class T> bool ConcurrentAvlTree<T>::Remove(const_reference dataToRemove, CompareFunctor const & Compare) {
+        std::unique_ptr<T> noEmplacement;
+        AttemptResult result;
+
+        {
+            EpochDomain::ReadGuard guard = _domain.EnterRead();
+
+            do {
+                result = AttemptUpdate(dataToRemove, Compare, noEmplacement, nullptr, _holder.get(), _holder->_version.load());
+            } while (result == AttemptResult::RETRY);
+        }
+
+        if (result == AttemptResult::CHANGED) {
+            _size.fetch_sub(1U, std::memory_order_relaxed);
+        }
+
+        ReclaimIfDue();
+        return result == AttemptResult::CHANGED;
+    }
+
+    template<class T> typename ConcurrentAvlTree<T>::AttemptResult ConcurrentAvlTree<T>::AttemptUpdate(
+        const_reference data, CompareFunctor const & Compare, std::unique_ptr<T> & emplaced, Node * parent, Node * node, Version nodeVersion
+    ) {
+        // The holder has no key; everything sorts to its right.
+        int comparison = (node == _holder.get()) ? 1 : Compare(data, *(node->_key));
+
+        if (comparison == 0) {
+            return AttemptNodeUpdate(emplaced, parent, node);
+        }
+
+        bool isGoingLeft = comparison < 0;
+
+        for (;;) {
+            Node * child = node->GetChild(isGoingLeft);
+
+            if (node->_version.load() != nodeVersion) {
+                return AttemptResult::RETRY;
+            }
+
+            if (child == nullptr) {
+                if (!emplaced) {
+                    return AttemptResult::UNCHANGED;
+                }
+
+                {
+                    std::lock_guard<NodeLock> lock{node->_lock};
+
+                    if (node->_version.load() != nodeVersion) {
+                        return AttemptResult::RETRY;
+                    }
+
+                    // Someone else filled the gap first; go around and descend into their node instead.
+                    if (node->GetChild(isGoingLeft) != nullptr) {
+                        continue;
+                    }
+
+                    node->SetChild(isGoingLeft, new Node{std::move(emplaced), node});
+                }
+
+                FixHeightAndRebalance(node);
+                return AttemptResult::CHANGED;
+            }
+
+            Version childVersion = child->_version.load();
+
+            if (Node::IsShrinking(childVersion)) {
+                WaitUntilNotShrinking(child);
+            } else if (!Node::IsUnlinked(childVersion) && (child == node->GetChild(isGoingLeft))) {
+                if (node->_version.load() != nodeVersion) {
+                    return AttemptResult::RETRY;
+                }
+
+                AttemptResult result = AttemptUpdate(data, Compare, emplaced, node, child, childVersion);
+
+                if (result != AttemptResult::RETRY) {
+                    return result;
+                }
+            }
+        }
+    }
+
+    template<class T> typename ConcurrentAvlTree<T>::AttemptResult ConcurrentAvlTree<T>::AttemptNodeUpdate(std::unique_ptr<T> & emplaced, Node * parent, Node * node) {
+        bool isRemoving = !emplaced;
+
+        if (isRemoving && (node->_value.load() == nullptr)) {
+            return AttemptResult::UNCHANGED;
+        }
+
+        if (isRemoving && ((node->GetChild(true) == nullptr) || (node->GetChild(false) == nullptr))) {
+            // The node can come out of the tree entirely, which means changing its parent too.
+            T * removed;
+
+            {
+                std::lock_guard<NodeLock> parentLock{parent->_lock};
+
+                if (parent->IsUnlinked() || (node->_parent.load() != parent)) {
+                    return AttemptResult::RETRY;
+                }
+
+                std::lock_guard<NodeLock> lock{node->_lock};
+                removed = node->_value.load();
+
+                if (removed == nullptr) {
+                    return AttemptResult::UNCHANGED;
+                }
+
+                if (!AttemptUnlink_Locked(parent, node)) {
+                    return AttemptResult::RETRY;
+                }
+            }
+
+            RetireValue(node, removed);
+            FixHeightAndRebalance(parent);
+            return AttemptResult::CHANGED;
+        }
+
+        std::lock_guard<NodeLock> lock{node->_lock};
+
+        if (node->IsUnlinked()) {
+            return AttemptResult::RETRY;
+        }
+
+        T * current = node->_value.load();
+
+        if (!isRemoving) {
+            if (current != nullptr) {
+                return AttemptResult::UNCHANGED;
+            }
+
+            // Revive a routing node. Its key stays the original payload; the new payload is kept alongside it.
+            node->_value.store(emplaced.release());
+            return AttemptResult::CHANGED;
+        }
+
+        if (current == nullptr) {
+            return AttemptResult::UNCHANGED;
+        }
+
+        // It lost a child since we looked, so it has to be unlinked rather than left behind as a routing node.
+        if ((node->GetChild(true) == nullptr) || (node->GetChild(false) == nullptr)) {
+            return AttemptResult::RETRY;
+        }
+
+        node->_value.store(nullptr);
+        RetireValue(node, current);
+        return AttemptResult::CHANGED;
+    }
+
+    template<class T> bool ConcurrentAvlTree<T>::AttemptUnlink_Locked(Node * parent, Node * node) {
+        bool isLeftChild = parent->GetChild(true) == node;
+
+        if (!isLeftChild && (parent->GetChild(false) != node)) {
+            return false;
+        }
+
+        Node * leftChild = node->GetChild(true);
+        Node * rightChild = node->GetChild(false);
+
+        if ((leftChild != nullptr) && (rightChild != nullptr)) {
+            return false;
+        }
+
+        Node * splice = (leftChild != nullptr) ? leftChild : rightChild;
+        parent->SetChild(isLeftChild, splice);
+
+        if (splice != nullptr) {
+            splice->_parent.store(parent);
+        }
+
+        node->_version.store(Node::UNLINKED);
+        node->_value.store(nullptr);
+        _domain.Retire(node);
+        _retiredSinceReclaim.fetch_add(1U, std::memory_order_relaxed);
+        return true;
+    }
+
+    template<class T> void ConcurrentAvlTree<T>::RetireValue(Node const * node, T * value) {
+        // The node's key payload lives and dies with the node itself.
+        if (value != node->_key.get()) {
+            _domain.Retire(value);
+            _retiredSinceReclaim.fetch_add(1U, std::memory_order_relaxed);
+        }
+    }
+
+    template<class T> void ConcurrentAvlTree<T>::ReclaimIfDue() {
+        if ((_retiredSinceReclaim.load(std::memory_order_relaxed) >= RECLAIM_INTERVAL) && (_retiredSinceReclaim.exchange(0U, std::memory_order_relaxed) >= RECLAIM_INTERVAL)) {
+            _domain.Reclaim();
+        }
+    }
+
+    template<class T> typename ConcurrentAvlTree<T>::Height ConcurrentAvlTree<T>::NodeCondition(Node * node) {
+        Node * leftChild = node->GetChild(true);
+        Node * rightChild = node->GetChild(false);
+
+        if (((leftChild == nullptr) || (rightChild == nullptr)) && (node->_value.load() == nullptr)) {
+            return UNLINK_REQUIRED;
+        }
+
+        Height leftHeight = Node::HeightOf(leftChild);
+        Height rightHeight = Node::HeightOf(rightChild);
+        Height replacementHeight = 1 + std::max(leftHeight, rightHeight);
+        Height balance = leftHeight - rightHeight;
+
+        if ((balance < -1) || (balance > 1)) {
+            return REBALANCE_REQUIRED;
+        }
+
+        return (node->_height.load() != replacementHeight) ? replacementHeight : NOTHING_REQUIRED;
+    }
+
+    template<class T> void ConcurrentAvlTree<T>::FixHeightAndRebalance(Node * node) {
+        // The holder is the only node without a parent, and it never needs fixing.
+        while ((node != nullptr) && (node->_parent.load() != nullptr)) {
+            Height condition = NodeCondition(node);
+
+            if ((condition == NOTHING_REQUIRED) || node->IsUnlinked()) {
+                return;
+            }
+
+            if ((condition != UNLINK_REQUIRED) && (condition != REBALANCE_REQUIRED)) {
+                std::lock_guard<NodeLock> lock{node->_lock};
+                node = FixHeight_Locked(node);
+                continue;
+            }
+
+            Node * parent = node->_parent.load();
+            std::lock_guard<NodeLock> parentLock{parent->_lock};
+
+            // If the node moved in the meantime, loop around and look at it again.
+            if (!parent->IsUnlinked() && (node->_parent.load() == parent)) {
+                std::lock_guard<NodeLock> lock{node->_lock};
+                node = Rebalance_Locked(parent, node);
+            }
+        }
+    }
+
+    template<class T> typename ConcurrentAvlTree<T>::Node * ConcurrentAvlTree<T>::FixHeight_Locked(Node * node) {
+        Height condition = NodeCondition(node);
+
+        switch (condition) {
+        case REBALANCE_REQUIRED:
+        case UNLINK_REQUIRED:
+            // Needs the parent's lock too, which we can't take from here without breaking the top-down lock order.
+            return node;
+        case NOTHING_REQUIRED:
+            return nullptr;
+        default:
+            node->_height.store(condition);
+            return node->_parent.load();
+        }
+    }
+
+    template<class T> typename ConcurrentAvlTree<T>::Node * ConcurrentAvlTree<T>::Rebalance_Locked(Node * parent, Node * node) {
+        Node * leftChild = node->GetChild(true);
+        Node * rightChild = node->GetChild(false);
+
+        if (((leftChild == nullptr) || (rightChild == nullptr)) && (node->_value.load() == nullptr)) {
+            return AttemptUnlink_Locked(parent, node) ? FixHeight_Locked(parent) : node;
+        }
+
+        Height leftHeight = Node::HeightOf(leftChild);
+        Height rightHeight = Node::HeightOf(rightChild);
+        Height replacementHeight = 1 + std::max(leftHeight, rightHeight);
+        Height balance = leftHeight - rightHeight;
+
+        if (balance > 1) {
+            return RebalanceTowardLightSide_Locked(parent, node, leftChild, rightHeight, true);
+        }
+
+        if (balance < -1) {
+            return RebalanceTowardLightSide_Locked(parent, node, rightChild, leftHeight, false);
+        }
+
+        if (replacementHeight != node->_height.load()) {
+            node->_height.store(replacementHeight);
+            return FixHeight_Locked(parent);
+        }
+
+        return nullptr;
+    }
+
+    template<class T> typename ConcurrentAvlTree<T>::Node * ConcurrentAvlTree<T>::RebalanceTowardLightSide_Locked(Node * parent, Node * node, Node * heavyChild, Height lightHeight, bool isLeftHeavy) {
+        std::lock_guard<NodeLock> heavyLock{heavyChild->_lock};
+
+        // The imbalance went away before we got the lock.
+        if (heavyChild->_height.load() - lightHeight <= 1) {
+            return node;
+        }
+
+        Node * innerChild = heavyChild->GetChild(!isLeftHeavy);
+        Height outerHeight = Node::HeightOf(heavyChild->GetChild(isLeftHeavy));
+        Height innerHeight = Node::HeightOf(innerChild);
+
+        if (outerHeight >= innerHeight) {
+            return RotateOnce_Locked(parent, node, heavyChild, lightHeight, outerHeight, innerChild, innerHeight, isLeftHeavy);
+        }
+
+        {
+            std::lock_guard<NodeLock> innerLock{innerChild->_lock};
+            innerHeight = innerChild->_height.load();
+
+            if (outerHeight >= innerHeight) {
+                return RotateOnce_Locked(parent, node, heavyChild, lightHeight, outerHeight, innerChild, innerHeight, isLeftHeavy);
+            }
+
+            Height innerNearHeight = Node::HeightOf(innerChild->GetChild(isLeftHeavy));
+            Height balance = outerHeight - innerNearHeight;
+
+            // A double rotation is only safe if it won't leave the heavy child itself imbalanced, which stale heights can make happen.
+            if ((balance >= -1) && (balance <= 1)) {
+                return RotateTwice_Locked(parent, node, heavyChild, lightHeight, outerHeight, innerChild, innerNearHeight, isLeftHeavy);
+            }
+        }
+
+        // Otherwise straighten out the heavy child first by rotating it away from its inner child. node gets revisited afterward.
+        return RebalanceTowardLightSide_Locked(node, heavyChild, innerChild, outerHeight, !isLeftHeavy);
+    }
+
+    template<class T> typename ConcurrentAvlTree<T>::Node * ConcurrentAvlTree<T>::RotateOnce_Locked(
+        Node * parent, Node * node, Node * heavyChild, Height lightHeight, Height outerHeight, Node * innerChild, Height innerHeight, bool isLeftHeavy
+    ) {
+        Version nodeVersion = node->_version.load();
+        bool isNodeLeftOfParent = parent->GetChild(true) == node;
+
+        // Searches that are in node right now could be looking for something that's about to move above it. This sends them back up.
+        node->_version.store(nodeVersion | Node::SHRINKING);
+
+        node->SetChild(isLeftHeavy, innerChild);
+        if (innerChild != nullptr) {
+            innerChild->_parent.store(node);
+        }
+
+        heavyChild->SetChild(!isLeftHeavy, node);
+        node->_parent.store(heavyChild);
+
+        parent->SetChild(isNodeLeftOfParent, heavyChild);
+        heavyChild->_parent.store(parent);
+
+        Height nodeHeight = 1 + std::max(innerHeight, lightHeight);
+        node->_height.store(nodeHeight);
+        heavyChild->_height.store(1 + std::max(outerHeight, nodeHeight));
+
+        node->_version.store(nodeVersion + Node::SHRINK_COUNT_INCREMENT);
+
+        Height nodeBalance = innerHeight - lightHeight;
+
+        if ((node->_value.load() == nullptr) && ((innerChild == nullptr) || (lightHeight == 0)) && AttemptUnlink_Locked(heavyChild, node)) {
+            nodeHeight = std::max(innerHeight, lightHeight);
+            nodeBalance = 0;
+            heavyChild->_height.store(1 + std::max(outerHeight, nodeHeight));
+        }
+
+        if ((heavyChild->_value.load() == nullptr) && ((outerHeight == 0) || (nodeHeight == 0)) && AttemptUnlink_Locked(parent, heavyChild)) {
+            // Whatever took heavyChild's place is either node, checked below, or a subtree this rotation didn't touch.
+            return ((nodeBalance < -1) || (nodeBalance > 1)) ? node : FixHeight_Locked(parent);
+        }
+
+        // Report whichever of the two rotated nodes still needs work, if either does.
+        if ((nodeBalance < -1) || (nodeBalance > 1)) {
+            return node;
+        }
+
+        Height heavyChildBalance = outerHeight - nodeHeight;
+
+        if ((heavyChildBalance < -1) || (heavyChildBalance > 1)) {
+            return heavyChild;
+        }
+
+        return FixHeight_Locked(parent);
+    }
+
+    template<class T> typename ConcurrentAvlTree<T>::Node * ConcurrentAvlTree<T>::RotateTwice_Locked(
+        Node * parent, Node * node, Node * heavyChild, Height lightHeight, Height outerHeight, Node * innerChild, Height innerNearHeight, bool isLeftHeavy
+    ) {
+        Version nodeVersion = node->_version.load();
+        Version heavyChildVersion = heavyChild->_version.load();
+        bool isNodeLeftOfParent = parent->GetChild(true) == node;
+
+        Node * innerNearChild = innerChild->GetChild(isLeftHeavy);
+        Node * innerFarChild = innerChild->GetChild(!isLeftHeavy);
+        Height innerFarHeight = Node::HeightOf(innerFarChild);
+
+        // Both node and heavyChild move down.
+        node->_version.store(nodeVersion | Node::SHRINKING);
+        heavyChild->_version.store(heavyChildVersion | Node::SHRINKING);
+
+        node->SetChild(isLeftHeavy, innerFarChild);
+        if (innerFarChild != nullptr) {
+            innerFarChild->_parent.store(node);
+        }
+
+        heavyChild->SetChild(!isLeftHeavy, innerNearChild);
+        if (innerNearChild != nullptr) {
+            innerNearChild->_parent.store(heavyChild);
+        }
+
+        innerChild->SetChild(isLeftHeavy, heavyChild);
+        heavyChild->_parent.store(innerChild);
+        innerChild->SetChild(!isLeftHeavy, node);
+        node->_parent.store(innerChild);
+
+        parent->SetChild(isNodeLeftOfParent, innerChild);
+        innerChild->_parent.store(parent);
+
+        Height nodeHeight = 1 + std::max(innerFarHeight, lightHeight);
+        Height heavyChildHeight = 1 + std::max(outerHeight, innerNearHeight);
+        node->_height.store(nodeHeight);
+        heavyChild->_height.store(heavyChildHeight);
+
+        node->_version.store(nodeVersion + Node::SHRINK_COUNT_INCREMENT);
+        heavyChild->_version.store(heavyChildVersion + Node::SHRINK_COUNT_INCREMENT);
+
+        Height nodeBalance = innerFarHeight - lightHeight;
+
+        if ((node->_value.load() == nullptr) && ((innerFarChild == nullptr) || (lightHeight == 0)) && AttemptUnlink_Locked(innerChild, node)) {
+            nodeHeight = std::max(innerFarHeight, lightHeight);
+            nodeBalance = 0;
+        }
+
+        if ((heavyChild->_value.load() == nullptr) && ((outerHeight == 0) || (innerNearHeight == 0)) && AttemptUnlink_Locked(innerChild, heavyChild)) {
+            heavyChildHeight = std::max(outerHeight, innerNearHeight);
+        }
+
+        innerChild->_height.store(1 + std::max(heavyChildHeight, nodeHeight));
+
+        // heavyChild was checked before rotating, so only node and the new top can need more work.
+        if ((nodeBalance < -1) || (nodeBalance > 1)) {
+            return node;
+        }
+
+        if (NodeCondition(innerChild) != NOTHING_REQUIRED) {
+            return innerChild;
+        }
+
+        return FixHeight_Locked(parent);
+    }
+}
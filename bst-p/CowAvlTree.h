@@ -0,0 +1,90 @@
+#pragma once
+#include "AVLTree.h"
+#include <memory>
+#include <utility>
+
+namespace BST_P {
+    /*
+     * A copy-on-write handle to an AvlTree. Copying a CowAvlTree is O(1): both copies share the same tree until one of them is modified,
+     * at which point the modifying copy takes its own AvlTree::Clone() of the shared tree.
+     *
+     * Nodes carry parent pointers, so they can't be shared between differently shaped trees. Sharing is therefore all-or-nothing: the first
+     * write to a shared tree costs one O(n) clone, and every write after that is an ordinary AvlTree operation. Inserting a duplicate or removing
+     * something missing doesn't count as a write, and leaves the tree shared.
+     * Like AvlTree, a CowAvlTree is not thread-safe; copies shared between threads must be synchronized externally.
+     */
+    template<class T>
+    class CowAvlTree final {
+    public:
+        typedef AvlTree<T> Tree;
+        typedef typename Tree::value_type value_type;
+        typedef typename Tree::const_reference const_reference;
+        typedef typename Tree::const_iterator const_iterator;
+        typedef typename Tree::iterator iterator;
+        typedef typename Tree::CompareFunctor CompareFunctor;
+        typedef typename Tree::Height Height;
+
+        explicit CowAvlTree(CompareFunctor defaultCompare = subtract<value_type>{}) : _tree{std::make_shared<Tree>(defaultCompare)} {}
+        explicit CowAvlTree(Tree && tree) : _tree{std::make_shared<Tree>(std::move(tree))} {}
+        CowAvlTree(CowAvlTree const &) = default;
+        CowAvlTree(CowAvlTree &&) noexcept = default;
+        CowAvlTree & operator=(CowAvlTree const &) = default;
+        CowAvlTree & operator=(CowAvlTree &&) noexcept = default;
+        inline ~CowAvlTree() = default;
+
+        // Read access never copies. Iterators obtained here stay valid until the next write through *any* handle that shares this tree.
+        [[nodiscard]] inline Tree const & Read() const { return *_tree; }
+        [[nodiscard]] inline const_iterator cbegin() const { return _tree->cbegin(); }
+        [[nodiscard]] inline const_iterator begin() const { return _tree->cbegin(); }
+        [[nodiscard]] inline const_iterator cend() const { return _tree->cend(); }
+        [[nodiscard]] inline const_iterator end() const { return _tree->cend(); }
+        [[nodiscard]] inline const_iterator cFind(const_reference dataToFind) const { return _tree->cFind(dataToFind); }
+        [[nodiscard]] inline const_iterator Find(const_reference dataToFind) const { return _tree->cFind(dataToFind); }
+        [[nodiscard]] inline Height GetHeight() const { return _tree->GetHeight(); }
+        [[nodiscard]] inline bool IsEmpty() const { return _tree->IsEmpty(); }
+        [[nodiscard]] inline bool IsShared() const { return _tree.use_count() > 1; }
+        CompareFunctor const & GetDefaultCompare() const { return _tree->GetDefaultCompare(); }
+
+        // Write access detaches this handle from any other handles first.
+        [[nodiscard]] inline Tree & Write() { Detach(); return *_tree; }
+
+        // On a shared tree, these look the element up first and only detach if the write would change something. Inserting a duplicate into a shared tree
+        // returns an iterator into the shared tree, which mustn't be written through.
+        template<class... Args> inline std::pair<bool, iterator> Emplace(CompareFunctor emplaceCompareFunctor, Args&&... args) {
+            if (!IsShared()) {
+                return _tree->Emplace(emplaceCompareFunctor, std::forward<Args>(args)...);
+            }
+
+            return InsertIfMissing(emplaceCompareFunctor, value_type(std::forward<Args>(args)...));
+        }
+        template<class... Args> inline std::pair<bool, iterator> DefaultEmplace(Args&&... args) { return Emplace(_tree->GetDefaultCompare(), std::forward<Args>(args)...); }
+        inline std::pair<bool, iterator> Insert(const_reference dataToCopyAndInsert) { return InsertIfMissing(_tree->GetDefaultCompare(), dataToCopyAndInsert); }
+        inline std::pair<bool, iterator> Insert(value_type && dataToMoveAndInsert) { return InsertIfMissing(_tree->GetDefaultCompare(), std::move(dataToMoveAndInsert)); }
+        inline bool Remove(const_reference dataToRemove, std::unique_ptr<value_type> & outputRemovedData) {
+            return (!IsShared() || (_tree->cFind(dataToRemove) != _tree->cend())) && Write().Remove(dataToRemove, outputRemovedData);
+        }
+        inline bool Remove(const_reference dataToRemove) { return (!IsShared() || (_tree->cFind(dataToRemove) != _tree->cend())) && Write().Remove(dataToRemove); }
+        inline void Clear() { if (IsShared()) { _tree = std::make_shared<Tree>(_tree->GetDefaultCompare()); } else { _tree->Clear(); } }
+
+    private:
+        template<class Data> std::pair<bool, iterator> InsertIfMissing(CompareFunctor const & compare, Data && data) {
+            if (IsShared()) {
+                const_iterator found = _tree->cFind(data, compare);
+
+                if (found != _tree->cend()) {
+                    return std::make_pair(false, iterator{found});
+                }
+            }
+
+            return Write().Emplace(compare, std::forward<Data>(data));
+        }
+
+        inline void Detach() {
+            if (IsShared()) {
+                _tree = std::make_shared<Tree>(_tree->Clone());
+            }
+        }
+
+        std::shared_ptr<Tree> _tree;
+    };
+}
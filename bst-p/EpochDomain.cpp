@@ -0,0 +1,78 @@
+#include "EpochDomain.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <thread>
+
+namespace BST_P {
+
+EpochDomain::EpochDomain() : _epoch{1U} {}
+
+EpochDomain::~EpochDomain() {
+    // Nobody can be reading anymore, so everything still retired can go.
+    for (RetiredObject const & retired : _retired) {
+        retired.deleter(retired.object);
+    }
+}
+
+EpochDomain::ReadGuard EpochDomain::EnterRead() {
+    // Start scanning at a per-thread offset so threads don't all fight over the first few slots.
+    thread_local std::size_t const firstSlot = std::hash<std::thread::id>{}(std::this_thread::get_id()) % MAX_CONCURRENT_READERS;
+
+    for (;;) {
+        for (std::size_t i = 0U; i < MAX_CONCURRENT_READERS; ++i) {
+            std::atomic<Epoch> & slot = _slots[(firstSlot + i) % MAX_CONCURRENT_READERS].announcedEpoch;
+            Epoch freeSlot = 0U;
+
+            // Sequentially consistent, so a writer that misses this announcement is guaranteed to have published before we read anything.
+            if ((slot.load(std::memory_order_relaxed) == 0U) && slot.compare_exchange_strong(freeSlot, _epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst)) {
+                return ReadGuard{&slot};
+            }
+        }
+
+        std::this_thread::yield();
+    }
+}
+
+void EpochDomain::RetireErased(void * object, void (*deleter)(void *)) {
+    std::lock_guard<std::mutex> lock{_retiredMutex};
+    _retired.push_back(RetiredObject{object, deleter, _epoch.load(std::memory_order_seq_cst)});
+}
+
+std::size_t EpochDomain::Reclaim() {
+    std::vector<RetiredObject> reclaimable;
+
+    {
+        std::lock_guard<std::mutex> lock{_retiredMutex};
+
+        // Anything retired before this increment is unreachable to readers that announce the new epoch.
+        _epoch.fetch_add(1U, std::memory_order_seq_cst);
+
+        Epoch oldestActiveEpoch = std::numeric_limits<Epoch>::max();
+        for (ReaderSlot const & slot : _slots) {
+            Epoch announced = slot.announcedEpoch.load(std::memory_order_seq_cst);
+
+            if (announced != 0U) {
+                oldestActiveEpoch = std::min(oldestActiveEpoch, announced);
+            }
+        }
+
+        auto stillVisible = std::partition(_retired.begin(), _retired.end(), [oldestActiveEpoch](RetiredObject const & retired) { return retired.retiredEpoch >= oldestActiveEpoch; });
+        reclaimable.assign(stillVisible, _retired.end());
+        _retired.erase(stillVisible, _retired.end());
+    }
+
+    // Run the deleters outside the lock; they may be arbitrarily expensive.
+    for (RetiredObject const & retired : reclaimable) {
+        retired.deleter(retired.object);
+    }
+
+    return reclaimable.size();
+}
+
+std::size_t EpochDomain::GetRetiredCount() const {
+    std::lock_guard<std::mutex> lock{_retiredMutex};
+    return _retired.size();
+}
+
+}
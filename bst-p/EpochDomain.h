@@ -0,0 +1,78 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace BST_P {
+    /*
+     * Epoch-based reclamation. Readers announce the global epoch while they hold a ReadGuard; writers retire objects they have unlinked,
+     * and an object is only deleted once every reader that could still have seen it has left.
+     *
+     * Entering and leaving a read section costs one compare-exchange and one store on a reader slot of its own cache line.
+     * Readers never wait on writers. Retire and Reclaim take a mutex that only writers contend on.
+     */
+    class EpochDomain final {
+    public:
+        typedef std::uint64_t Epoch;
+        static constexpr std::size_t MAX_CONCURRENT_READERS = 256U;
+
+        class ReadGuard final {
+            friend EpochDomain;
+
+        public:
+            ReadGuard(ReadGuard const &) = delete;
+            inline ReadGuard(ReadGuard && other) noexcept : _slot{other._slot} { other._slot = nullptr; }
+            ReadGuard & operator=(ReadGuard const &) = delete;
+            ReadGuard & operator=(ReadGuard &&) noexcept = delete;
+            inline ~ReadGuard() { if (_slot != nullptr) { _slot->store(0U, std::memory_order_release); } }
+
+        private:
+            inline explicit ReadGuard(std::atomic<Epoch> * slot) : _slot{slot} {}
+
+            std::atomic<Epoch> * _slot;
+        };
+
+        EpochDomain();
+        EpochDomain(EpochDomain const &) = delete;
+        EpochDomain(EpochDomain &&) noexcept = delete;
+        EpochDomain & operator=(EpochDomain const &) = delete;
+        EpochDomain & operator=(EpochDomain &&) noexcept = delete;
+        ~EpochDomain();
+
+        // Anything published before this call is safe to read until the guard is destroyed. If every reader slot is taken, this spins until one frees up.
+        [[nodiscard]] ReadGuard EnterRead();
+
+        // Hands an already unlinked object over to the domain, which deletes it once no reader can still be looking at it.
+        template<class U> inline void Retire(U * object) { RetireErased(const_cast<std::remove_cv_t<U> *>(object), [](void * erased) { delete static_cast<U *>(erased); }); }
+
+        // Advances the epoch and deletes every retired object that no active reader can reach. Returns the number of objects deleted.
+        std::size_t Reclaim();
+
+        [[nodiscard]] inline Epoch GetEpoch() const { return _epoch.load(std::memory_order_seq_cst); }
+        [[nodiscard]] std::size_t GetRetiredCount() const;
+
+    private:
+        struct alignas(64) ReaderSlot {
+            std::atomic<Epoch> announcedEpoch{0U};
+        };
+
+        struct RetiredObject {
+            void * object;
+            void (*deleter)(void *);
+            Epoch retiredEpoch;
+        };
+
+        void RetireErased(void * object, void (*deleter)(void *));
+
+        // Epoch 0 marks a free slot, so the global epoch starts at 1.
+        std::atomic<Epoch> _epoch;
+        std::array<ReaderSlot, MAX_CONCURRENT_READERS> _slots;
+
+        mutable std::mutex _retiredMutex;
+        std::vector<RetiredObject> _retired;
+    };
+}
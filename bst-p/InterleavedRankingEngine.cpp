@@ -0,0 +1,136 @@
+#include "InterleavedRankingEngine.h"
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+namespace BST_P {
+
+InterleavedRankingEngine::InterleavedRankingEngine(std::size_t itemCount, std::uint32_t seed, std::size_t inFlightCount)
+    : _placed{itemCount, seed}
+    , _inFlightCount{std::max<std::size_t>(inFlightCount, 1U)}
+    , _questionCount{0U} {}
+
+std::pair<bool, RankingItem> InterleavedRankingEngine::PlaceNext(RankingOracle const & oracle) {
+    if (IsDone()) {
+        throw std::out_of_range{"There's nothing left to rank."};
+    }
+
+    std::vector<RankingItem> & pool = _placed._pool;
+
+    while ((_inFlight.size() < _inFlightCount) && !pool.empty()) {
+        std::size_t index = std::uniform_int_distribution<std::size_t>{0U, pool.size() - 1U}(_placed._random);
+        RankingItem item = pool[index];
+        pool[index] = pool.back();
+        pool.pop_back();
+
+        // In flight before it starts, since it asks its first question before EmplaceAsync even returns.
+        _inFlight.push_back(Placement{item, {}, std::nullopt});
+        Start(_inFlight.back());
+    }
+
+    std::optional<RankingItem> committed = CommitFinished();
+    std::optional<Question> question;
+
+    while (!question) {
+        // Only the very first items can go in without a question, with nothing ranked to compare them to.
+        if (_questions.empty()) {
+            return {true, *committed};
+        }
+
+        std::size_t index = std::uniform_int_distribution<std::size_t>{0U, _questions.size() - 1U}(_placed._random);
+
+        if (_questions[index].structureVersion != _placed._ranking.GetStructureVersion()) {
+            RankingItem item = _questions[index].item;
+            Start(FindPlacement(item));
+
+            // Starting over may have placed it with what it already knew.
+            if (std::optional<RankingItem> finished = CommitFinished()) {
+                committed = finished;
+                continue;
+            }
+
+            index = _questions.size() - 1U;
+        }
+
+        question.emplace(std::move(_questions[index]));
+        _questions[index] = std::move(_questions.back());
+        _questions.pop_back();
+    }
+
+    ++_questionCount;
+    RankingAnswer answer = oracle(question->item, question->rankedItem);
+
+    if (answer == RankingAnswer::Skip) {
+        Placement & skipped = FindPlacement(question->item);
+        skipped = std::move(_inFlight.back());
+        _inFlight.pop_back();
+        pool.push_back(question->item);
+        return {false, question->item};
+    }
+
+    int comparison = (answer == RankingAnswer::Lower) ? -1 : 1;
+    FindPlacement(question->item).answers.emplace_back(question->rankedItem, comparison);
+    question->comparison.Answer(comparison);
+    CommitFinished();
+
+    return {true, question->item};
+}
+
+void InterleavedRankingEngine::Start(Placement & placement) {
+    auto waiting = std::find_if(_questions.begin(), _questions.end(), [&placement](Question const & question) { return question.item == placement.item; });
+
+    if (waiting != _questions.end()) {
+        *waiting = std::move(_questions.back());
+        _questions.pop_back();
+    }
+
+    RankingItem item = placement.item;
+    placement.emplacement.reset();
+    placement.emplacement.emplace(_placed._ranking.EmplaceAsync([this](RankingItem const & a, RankingItem const & b) { return Compare(a, b); }, item));
+}
+
+AsyncComparison InterleavedRankingEngine::Compare(RankingItem item, RankingItem rankedItem) {
+    Placement const & placement = FindPlacement(item);
+    auto answered = std::find_if(placement.answers.cbegin(), placement.answers.cend(), [rankedItem](auto const & answer) { return answer.first == rankedItem; });
+
+    if (answered != placement.answers.cend()) {
+        return AsyncComparison{answered->second};
+    }
+
+    _questions.push_back(Question{item, rankedItem, AsyncComparison{}, _placed._ranking.GetStructureVersion()});
+    return _questions.back().comparison;
+}
+
+InterleavedRankingEngine::Placement & InterleavedRankingEngine::FindPlacement(RankingItem item) {
+    return *std::find_if(_inFlight.begin(), _inFlight.end(), [item](Placement const & placement) { return placement.item == item; });
+}
+
+std::optional<RankingItem> InterleavedRankingEngine::CommitFinished() {
+    std::optional<RankingItem> committed;
+
+    for (std::size_t i = 0U; i < _inFlight.size();) {
+        if (!_inFlight[i].emplacement->IsDone()) {
+            ++i;
+            continue;
+        }
+
+        committed = _inFlight[i].item;
+        _placed._positions[_inFlight[i].item] = _inFlight[i].emplacement->GetResult().second;
+        _inFlight[i] = std::move(_inFlight.back());
+        _inFlight.pop_back();
+    }
+
+    return committed;
+}
+
+void InterleavedRankingEngine::AbandonInFlight() {
+    for (Placement const & placement : _inFlight) {
+        _placed._pool.push_back(placement.item);
+    }
+
+    // Destroying the insertions abandons them, and with them the questions they were waiting on.
+    _inFlight.clear();
+    _questions.clear();
+}
+
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include "RankingEngine.h"
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace BST_P {
+    /*
+     * Ranks items by binary insertion like RankingEngine, but keeps several insertions in flight at once, each one through AvlTree::EmplaceAsync
+     * and suspended at the question it needs answered next. Each call to PlaceNext is the scheduler: it picks one of the pending questions at random,
+     * asks it, and the insertion waiting on it carries on until it needs another answer or is placed. Insertions are placed in whatever order
+     * their questions happen to finish them. Whenever one is placed, the others start their descent over, since the tree may have rotated under them.
+     * Each insertion remembers the answers it's been given, so starting over only asks the oracle what it hasn't asked yet, and a question picked after
+     * the tree changed is worked out again first, so it's never about a node that's no longer in the way.
+     * A skip abandons that insertion and returns its item to the pool. The ranking itself is kept by a RankingEngine, so it saves, loads, and unranks
+     * just the same. Items in flight aren't saved, and loading puts them back into the pool.
+     */
+    class InterleavedRankingEngine final {
+    public:
+        InterleavedRankingEngine(std::size_t itemCount, std::uint32_t seed, std::size_t inFlightCount);
+        InterleavedRankingEngine(InterleavedRankingEngine const &) = delete;
+        InterleavedRankingEngine(InterleavedRankingEngine &&) noexcept = delete;
+        InterleavedRankingEngine & operator=(InterleavedRankingEngine const &) = delete;
+        InterleavedRankingEngine & operator=(InterleavedRankingEngine &&) noexcept = delete;
+        inline ~InterleavedRankingEngine() = default;
+
+        // Tops up the insertions in flight from the pool and asks one question. Returns whether it wasn't skipped, and the item it was about,
+        // which may or may not have been placed by it. Throws std::out_of_range if there's nothing left to rank.
+        std::pair<bool, RankingItem> PlaceNext(RankingOracle const & oracle);
+        inline bool Unrank(RankingItem item) { return _placed.Unrank(item); }
+
+        [[nodiscard]] inline bool IsDone() const { return _placed.IsDone() && _inFlight.empty(); }
+        [[nodiscard]] inline bool IsRanked(RankingItem item) const { return _placed.IsRanked(item); }
+        [[nodiscard]] inline Ranking const & GetRanking() const { return _placed.GetRanking(); }
+        [[nodiscard]] inline std::size_t GetItemCount() const { return _placed.GetItemCount(); }
+        // Counts the items in flight too, since they aren't ranked yet.
+        [[nodiscard]] inline std::size_t GetPoolSize() const { return _placed.GetPoolSize() + _inFlight.size(); }
+        [[nodiscard]] inline std::size_t GetInFlightCount() const { return _inFlightCount; }
+        // Every question the oracle was asked, including the ones it answered with a skip.
+        [[nodiscard]] inline std::uint64_t GetQuestionCount() const { return _questionCount; }
+
+        template<class Codec> inline void Save(std::ostream & stream, Codec const & codec) const { _placed.Save(stream, codec); }
+        // The ranking is replaced wholesale, so whatever's in flight is abandoned first.
+        template<class Codec> void Load(std::istream & stream, Codec const & codec) {
+            AbandonInFlight();
+            _placed.Load(stream, codec);
+        }
+
+    private:
+        struct Placement {
+            RankingItem item;
+            // Each ranked item it was compared to, and how.
+            std::vector<std::pair<RankingItem, int>> answers;
+            std::optional<Ranking::Emplacement> emplacement;
+        };
+
+        struct Question {
+            RankingItem item;
+            RankingItem rankedItem;
+            AsyncComparison comparison;
+            // The ranking's structure version when it was asked.
+            std::uint64_t structureVersion;
+        };
+
+        // Starts the placement's insertion, or starts it over, abandoning the question it was waiting on.
+        void Start(Placement & placement);
+        AsyncComparison Compare(RankingItem item, RankingItem rankedItem);
+        Placement & FindPlacement(RankingItem item);
+        // Takes every finished insertion out of flight and records where its item went. Returns the last one, if any finished.
+        std::optional<RankingItem> CommitFinished();
+        void AbandonInFlight();
+
+        RankingEngine _placed;
+        std::vector<Placement> _inFlight;
+        // One per insertion in flight that isn't finished, since each one waits on a single question at a time.
+        std::vector<Question> _questions;
+        std::size_t _inFlightCount;
+        std::uint64_t _questionCount;
+    };
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include "AVLTree.h"
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ostream>
+#include <type_traits>
+
+namespace BST_P {
+    /*
+     * A read-only ordered set served straight out of a memory-mapped tree image, with no deserializing at all.
+     * Opening one maps the file and checks its header, which takes the same time however big the tree is. Pages are only read in as lookups reach them,
+     * and processes that open the same image share them through the page cache.
+     *
+     * The image holds no pointers. Nodes are stored in order, each with its element inline and its children given as distances from itself,
+     * so the image means the same wherever it's mapped. Iteration walks the nodes front to back; lookups descend from the root.
+     * Elements are copied byte for byte, so they have to be trivially copyable and must not point anywhere, and an image only opens on machines
+     * with the same endianness and type layout as the one that wrote it. Only the header is checked; the rest of the image is trusted.
+     */
+    template<class T>
+    class MappedAvlTree final {
+        static_assert(std::is_trivially_copyable_v<T>, "MappedAvlTree stores elements inline, byte for byte, so they have to be trivially copyable.");
+
+    public:
+        typedef T value_type;
+        typedef value_type const * const_pointer;
+        typedef value_type const & const_reference;
+        typedef typename AvlTree<T>::CompareFunctor CompareFunctor;
+
+        static constexpr std::uint32_t IMAGE_MAGIC = 0x4D545342U;
+        static constexpr std::uint32_t IMAGE_VERSION = 1U;
+
+    private:
+        // A child offset of 0 means there's no child.
+        struct ImageNode {
+            std::int64_t leftOffset;
+            std::int64_t rightOffset;
+            T element;
+        };
+
+        struct ImageHeader {
+            std::uint32_t magic;
+            std::uint32_t version;
+            std::uint32_t nodeSize;
+            std::uint32_t nodeAlignment;
+            std::uint64_t nodeCount;
+            std::uint64_t rootIndex;
+        };
+
+        // The header is padded out to here, so the nodes are aligned for anything up to a cache line.
+        static constexpr std::size_t NODES_OFFSET = 64U;
+        static_assert(alignof(ImageNode) <= NODES_OFFSET, "Elements aligned past a cache line aren't supported.");
+
+    public:
+        class ConstIterator final {
+            friend MappedAvlTree;
+
+        public:
+            typedef std::ptrdiff_t difference_type;
+            typedef T value_type;
+            typedef value_type const * pointer;
+            typedef value_type const & reference;
+            typedef std::bidirectional_iterator_tag iterator_category;
+
+            inline ConstIterator(ConstIterator const &) = default;
+            inline ConstIterator(ConstIterator &&) noexcept = default;
+            inline ConstIterator & operator=(ConstIterator const &) = default;
+            inline ConstIterator & operator=(ConstIterator &&) noexcept = default;
+            inline ~ConstIterator() = default;
+
+            [[nodiscard]] inline bool operator==(ConstIterator const & other) const { return _node == other._node; }
+            [[nodiscard]] inline bool operator!=(ConstIterator const & other) const { return !operator==(other); }
+            [[nodiscard]] inline reference operator*() const { return _node->element; }
+            inline pointer operator->() const { return &(_node->element); }
+            inline ConstIterator & operator++() { ++_node; return *this; }
+            [[nodiscard]] inline ConstIterator operator++(int) { ConstIterator copy{*this}; operator++(); return copy; }
+            inline ConstIterator & operator--() { --_node; return *this; }
+            [[nodiscard]] inline ConstIterator operator--(int) { ConstIterator copy{*this}; operator--(); return copy; }
+
+        private:
+            inline explicit ConstIterator(ImageNode const * node) : _node{node} {}
+
+            ImageNode const * _node;
+        };
+
+        typedef ConstIterator const_iterator;
+
+        // Throws if the file can't be mapped, isn't an image of this version, or its nodes aren't the size and alignment this element type needs.
+        explicit MappedAvlTree(char const * path, CompareFunctor defaultCompare = subtract<value_type>{});
+        MappedAvlTree(MappedAvlTree const &) = delete;
+        MappedAvlTree(MappedAvlTree &&) noexcept = delete;
+        MappedAvlTree & operator=(MappedAvlTree const &) = delete;
+        MappedAvlTree & operator=(MappedAvlTree &&) noexcept = delete;
+        inline ~MappedAvlTree() = default;
+
+        // Writes an AvlTree's elements out as an image, shaped as a perfectly balanced tree. Elements are written one at a time, so memory stays flat.
+        template<class Tree> static void WriteImage(Tree const & tree, std::ostream & stream);
+
+        [[nodiscard]] inline const_iterator begin() const { return const_iterator{_nodes}; }
+        [[nodiscard]] inline const_iterator cbegin() const { return begin(); }
+        [[nodiscard]] inline const_iterator end() const { return const_iterator{_nodes + _size}; }
+        [[nodiscard]] inline const_iterator cend() const { return end(); }
+
+        [[nodiscard]] const_iterator Find(const_reference dataToFind) const;
+        [[nodiscard]] inline bool Contains(const_reference dataToFind) const { return Find(dataToFind) != end(); }
+        // The first element that isn't ordered before dataToFind, or end() if there's none.
+        [[nodiscard]] const_iterator LowerBound(const_reference dataToFind) const;
+
+        [[nodiscard]] inline std::size_t GetSize() const { return _size; }
+        [[nodiscard]] inline bool IsEmpty() const { return _size == 0U; }
+
+        CompareFunctor const & GetDefaultCompare() const { return _DefaultCompare; }
+
+    private:
+        [[nodiscard]] static inline ImageNode const * GetChild(ImageNode const * node, bool isLeftChild) {
+            std::int64_t offset = isLeftChild ? node->leftOffset : node->rightOffset;
+            return (offset == 0) ? nullptr : (node + offset);
+        }
+
+        // Writes the nodes of the balanced subtree spanning [first, last) in order, taking their elements from itr.
+        template<class ElementIterator> static void WriteImageNodes(std::ostream & stream, ElementIterator & itr, std::uint64_t first, std::uint64_t last);
+        [[nodiscard]] static inline std::uint64_t FindMiddle(std::uint64_t first, std::uint64_t last) { return first + ((last - first) / 2U); }
+
+        MappedFile _file;
+        ImageNode const * _nodes;
+        ImageNode const * _root;
+        std::size_t _size;
+
+        CompareFunctor _DefaultCompare;
+    };
+}
+
+#include "MappedAvlTree.inl"
@@ -0,0 +1,109 @@
+#pragma once
+#include "MappedAvlTree.h"
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+namespace BST_P {
+    template<class T> MappedAvlTree<T>::MappedAvlTree(char const * path, CompareFunctor defaultCompare)
+        : _file{path}
+        , _nodes{nullptr}
+        , _root{nullptr}
+        , _size{0U}
+        , _DefaultCompare{std::move(defaultCompare)}
+    {
+        if (_file.GetSize() < NODES_OFFSET) {
+            throw std::runtime_error{"Not a tree image!"};
+        }
+
+        ImageHeader const & header = *static_cast<ImageHeader const *>(_file.GetData());
+
+        if (header.magic != IMAGE_MAGIC) {
+            throw std::runtime_error{"Not a tree image!"};
+        }
+
+        if (header.version != IMAGE_VERSION) {
+            throw std::runtime_error{"Tree image is from an unsupported version!"};
+        }
+
+        if ((header.nodeSize != sizeof(ImageNode)) || (header.nodeAlignment != alignof(ImageNode))) {
+            throw std::runtime_error{"Tree image holds a different element type!"};
+        }
+
+        if ((header.nodeCount > ((_file.GetSize() - NODES_OFFSET) / sizeof(ImageNode))) || ((header.nodeCount > 0U) && (header.rootIndex >= header.nodeCount))) {
+            throw std::runtime_error{"Tree image is truncated!"};
+        }
+
+        _nodes = reinterpret_cast<ImageNode const *>(static_cast<char const *>(_file.GetData()) + NODES_OFFSET);
+        _size = static_cast<std::size_t>(header.nodeCount);
+        _root = (_size > 0U) ? (_nodes + header.rootIndex) : nullptr;
+    }
+
+    template<class T> template<class Tree> void MappedAvlTree<T>::WriteImage(Tree const & tree, std::ostream & stream) {
+        std::uint64_t nodeCount = tree.GetSize();
+        ImageHeader header{IMAGE_MAGIC, IMAGE_VERSION, sizeof(ImageNode), alignof(ImageNode), nodeCount, FindMiddle(0U, nodeCount)};
+        char const padding[NODES_OFFSET] = {};
+
+        stream.write(reinterpret_cast<char const *>(&header), sizeof(header));
+        stream.write(padding, NODES_OFFSET - sizeof(header));
+
+        typename Tree::const_iterator itr = tree.cbegin();
+        WriteImageNodes(stream, itr, 0U, nodeCount);
+
+        if (!stream) {
+            throw std::runtime_error{"Failed to write tree image!"};
+        }
+    }
+
+    template<class T> template<class ElementIterator> void MappedAvlTree<T>::WriteImageNodes(std::ostream & stream, ElementIterator & itr, std::uint64_t first, std::uint64_t last) {
+        if (first == last) {
+            return;
+        }
+
+        // The recursion visits the subtree's slots in order, so the nodes go out in the same order the tree hands over their elements.
+        std::uint64_t middle = FindMiddle(first, last);
+        WriteImageNodes(stream, itr, first, middle);
+
+        std::int64_t leftOffset = (first == middle) ? 0 : (static_cast<std::int64_t>(FindMiddle(first, middle)) - static_cast<std::int64_t>(middle));
+        std::int64_t rightOffset = (middle + 1U == last) ? 0 : (static_cast<std::int64_t>(FindMiddle(middle + 1U, last)) - static_cast<std::int64_t>(middle));
+        // Assembled in zeroed bytes rather than as an ImageNode, so its padding goes out as zeros instead of whatever was on the stack.
+        alignas(ImageNode) char node[sizeof(ImageNode)] = {};
+        std::memcpy(node + offsetof(ImageNode, leftOffset), &leftOffset, sizeof(leftOffset));
+        std::memcpy(node + offsetof(ImageNode, rightOffset), &rightOffset, sizeof(rightOffset));
+        std::memcpy(node + offsetof(ImageNode, element), std::addressof(*itr), sizeof(T));
+        stream.write(node, sizeof(node));
+        ++itr;
+
+        WriteImageNodes(stream, itr, middle + 1U, last);
+    }
+
+    template<class T> typename MappedAvlTree<T>::const_iterator MappedAvlTree<T>::Find(const_reference dataToFind) const {
+        for (ImageNode const * node = _root; node != nullptr;) {
+            int comparison = _DefaultCompare(dataToFind, node->element);
+
+            if (comparison == 0) {
+                return const_iterator{node};
+            }
+
+            node = GetChild(node, comparison < 0);
+        }
+
+        return end();
+    }
+
+    template<class T> typename MappedAvlTree<T>::const_iterator MappedAvlTree<T>::LowerBound(const_reference dataToFind) const {
+        ImageNode const * bound = _nodes + _size;
+
+        for (ImageNode const * node = _root; node != nullptr;) {
+            if (_DefaultCompare(dataToFind, node->element) <= 0) {
+                bound = node;
+                node = GetChild(node, true);
+            } else {
+                node = GetChild(node, false);
+            }
+        }
+
+        return const_iterator{bound};
+    }
+}
@@ -0,0 +1,104 @@
+#include "MappedFile.h"
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace BST_P {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(char const * path) : _data{nullptr}, _size{0U} {
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error{"Couldn't open file to map!"};
+    }
+
+    LARGE_INTEGER size;
+
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        throw std::runtime_error{"Couldn't find the size of file to map!"};
+    }
+
+    _size = static_cast<std::size_t>(size.QuadPart);
+
+    if (_size == 0U) {
+        CloseHandle(file);
+        return;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+
+    if (mapping == nullptr) {
+        throw std::runtime_error{"Couldn't map file!"};
+    }
+
+    // The view keeps the mapping alive by itself.
+    _data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+
+    if (_data == nullptr) {
+        throw std::runtime_error{"Couldn't map file!"};
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (_data != nullptr) {
+        UnmapViewOfFile(_data);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(char const * path) : _data{nullptr}, _size{0U} {
+    int file = open(path, O_RDONLY);
+
+    if (file < 0) {
+        throw std::runtime_error{"Couldn't open file to map!"};
+    }
+
+    struct stat status;
+
+    if (fstat(file, &status) != 0) {
+        close(file);
+        throw std::runtime_error{"Couldn't find the size of file to map!"};
+    }
+
+    _size = static_cast<std::size_t>(status.st_size);
+
+    if (_size == 0U) {
+        close(file);
+        return;
+    }
+
+    // The mapping keeps the file open by itself.
+    void * data = mmap(nullptr, _size, PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+
+    if (data == MAP_FAILED) {
+        throw std::runtime_error{"Couldn't map file!"};
+    }
+
+    _data = data;
+}
+
+MappedFile::~MappedFile() {
+    if (_data != nullptr) {
+        munmap(const_cast<void *>(_data), _size);
+    }
+}
+
+#endif
+
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+
+namespace BST_P {
+    /*
+     * A whole file mapped read-only into memory: mmap on POSIX systems, CreateFileMapping on Windows.
+     * The mapping is shared, so every process that maps the same file reads the same pages out of the page cache.
+     */
+    class MappedFile final {
+    public:
+        // Throws if the file can't be opened or mapped.
+        explicit MappedFile(char const * path);
+        MappedFile(MappedFile const &) = delete;
+        MappedFile(MappedFile &&) noexcept = delete;
+        MappedFile & operator=(MappedFile const &) = delete;
+        MappedFile & operator=(MappedFile &&) noexcept = delete;
+        ~MappedFile();
+
+        // Null for an empty file, which can't be mapped.
+        [[nodiscard]] inline void const * GetData() const { return _data; }
+        [[nodiscard]] inline std::size_t GetSize() const { return _size; }
+
+    private:
+        void const * _data;
+        std::size_t _size;
+    };
+}
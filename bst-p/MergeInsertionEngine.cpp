@@ -0,0 +1,165 @@
+#include "MergeInsertionEngine.h"
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace BST_P {
+
+namespace {
+    // Thrown through Sort to abandon the round when the oracle skips.
+    struct SkippedItem {
+        RankingItem item;
+    };
+}
+
+MergeInsertionEngine::MergeInsertionEngine(std::size_t itemCount, std::uint32_t seed)
+    : _placed{itemCount, seed}
+    , _order(itemCount)
+    , _isSetAside(itemCount, false)
+    , _rankIndices(itemCount, 0U)
+    , _questionCount{0U} {
+    for (std::size_t i = 0U; i < itemCount; ++i) {
+        _order[i] = static_cast<RankingItem>(i);
+    }
+
+    std::mt19937 random{seed};
+    std::shuffle(_order.begin(), _order.end(), random);
+}
+
+std::pair<bool, RankingItem> MergeInsertionEngine::PlaceNext(RankingOracle const & oracle) {
+    if (_placed.IsDone()) {
+        throw std::out_of_range{"There's nothing left to rank."};
+    }
+
+    std::vector<RankingItem> items;
+    items.reserve(GetItemCount());
+
+    // Once everything left is set aside, it's all brought back.
+    if (std::none_of(_order.cbegin(), _order.cend(), [this](RankingItem item) { return !IsRanked(item) && !_isSetAside[item]; })) {
+        std::fill(_isSetAside.begin(), _isSetAside.end(), false);
+    }
+
+    for (RankingItem item : GetRanking()) {
+        _rankIndices[item] = items.size();
+        items.push_back(item);
+    }
+
+    for (RankingItem item : _order) {
+        if (!IsRanked(item) && !_isSetAside[item]) {
+            items.push_back(item);
+        }
+    }
+
+    std::vector<RankingItem> sorted;
+
+    try {
+        sorted = Sort(items, oracle);
+    } catch (SkippedItem const & skipped) {
+        _isSetAside[skipped.item] = true;
+        return {false, skipped.item};
+    }
+
+    Ranking ranking{&RankingEngine::CompareUnasked};
+
+    for (RankingItem item : sorted) {
+        ranking.Insert(item, [](RankingItem const &, RankingItem const &) { return 1; });
+    }
+
+    _placed.Adopt(std::move(ranking));
+    std::fill(_isSetAside.begin(), _isSetAside.end(), false);
+
+    return {true, items.back()};
+}
+
+bool MergeInsertionEngine::IsLower(RankingItem a, RankingItem b, RankingOracle const & oracle) {
+    if (IsRanked(a) && IsRanked(b)) {
+        return _rankIndices[a] < _rankIndices[b];
+    }
+
+    // The oracle's asked about the item being placed, which has to be one that isn't ranked yet.
+    bool isAskingAboutA = !IsRanked(a);
+    ++_questionCount;
+    RankingAnswer answer = isAskingAboutA ? oracle(a, b) : oracle(b, a);
+
+    if (answer == RankingAnswer::Skip) {
+        throw SkippedItem{isAskingAboutA ? a : b};
+    }
+
+    return (answer == RankingAnswer::Lower) == isAskingAboutA;
+}
+
+std::vector<RankingItem> MergeInsertionEngine::Sort(std::vector<RankingItem> const & items, RankingOracle const & oracle) {
+    if (items.size() < 2U) {
+        return items;
+    }
+
+    std::size_t pairCount = items.size() / 2U;
+    std::vector<RankingItem> higherItems;
+    std::unordered_map<RankingItem, RankingItem> lowerByHigher;
+    higherItems.reserve(pairCount);
+
+    for (std::size_t i = 0U; i < pairCount; ++i) {
+        RankingItem a = items[2U * i];
+        RankingItem b = items[(2U * i) + 1U];
+
+        if (IsLower(b, a, oracle)) {
+            std::swap(a, b);
+        }
+
+        higherItems.push_back(b);
+        lowerByHigher.emplace(b, a);
+    }
+
+    std::vector<RankingItem> higherSorted = Sort(higherItems, oracle);
+    // The lower items to insert, each paired with the higher one it has to rank below, except for an odd one out, which can go anywhere.
+    std::vector<RankingItem> pending;
+    pending.reserve(pairCount + 1U);
+
+    for (RankingItem higher : higherSorted) {
+        pending.push_back(lowerByHigher.at(higher));
+    }
+
+    if ((items.size() % 2U) != 0U) {
+        pending.push_back(items.back());
+    }
+
+    std::vector<RankingItem> sorted;
+    sorted.reserve(items.size());
+    sorted.push_back(pending.front());
+    sorted.insert(sorted.end(), higherSorted.cbegin(), higherSorted.cend());
+
+    // Pending items go in groups ending at the Jacobsthal numbers, 3, 5, 11, 21, 43 and so on, each group last to first.
+    // That way each one is searched for among 2^k - 1 items, which binary search does in k questions.
+    std::size_t groupEnd = 1U;
+    std::size_t previousJacobsthal = 1U;
+
+    while (groupEnd < pending.size()) {
+        std::size_t nextGroupEnd = groupEnd + (2U * previousJacobsthal);
+        previousJacobsthal = groupEnd;
+
+        for (std::size_t i = std::min(nextGroupEnd, pending.size()); i > groupEnd; --i) {
+            RankingItem item = pending[i - 1U];
+            auto last = (i - 1U < higherSorted.size()) ? std::find(sorted.begin(), sorted.end(), higherSorted[i - 1U]) : sorted.end();
+            auto first = sorted.begin();
+
+            while (first != last) {
+                auto middle = first + ((last - first) / 2);
+
+                if (IsLower(item, *middle, oracle)) {
+                    last = middle;
+                } else {
+                    first = middle + 1;
+                }
+            }
+
+            sorted.insert(first, item);
+        }
+
+        groupEnd = nextGroupEnd;
+    }
+
+    return sorted;
+}
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "RankingEngine.h"
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace BST_P {
+    /*
+     * Ranks items by Ford-Johnson merge-insertion, which asks fewer questions than binary insertion when ranking from scratch:
+     * it pairs the items up, ranks the higher of each pair recursively, then binary inserts the lower ones in an order that keeps every search
+     * one question short of the next power of two. Each call to PlaceNext runs a whole round over the ranked items and the pool.
+     * Ranked items are compared by where they stand in the ranking without asking anything, so only questions about the pool reach the oracle.
+     * A skip abandons the round and sets the item aside until the next round finishes. Wrap the oracle in MakeCachedOracle to keep the answers
+     * given before the skip, since the round is worked out again from the start.
+     * The ranking itself is kept by a RankingEngine, so it saves, loads, and unranks just the same.
+     */
+    class MergeInsertionEngine final {
+    public:
+        MergeInsertionEngine(std::size_t itemCount, std::uint32_t seed);
+        MergeInsertionEngine(MergeInsertionEngine const &) = delete;
+        MergeInsertionEngine(MergeInsertionEngine &&) noexcept = delete;
+        MergeInsertionEngine & operator=(MergeInsertionEngine const &) = delete;
+        MergeInsertionEngine & operator=(MergeInsertionEngine &&) noexcept = delete;
+        inline ~MergeInsertionEngine() = default;
+
+        // Places every item in the pool that isn't set aside. Returns whether they were placed rather than one being skipped, and either
+        // the item skipped or the last one placed. Throws std::out_of_range if the pool is empty.
+        std::pair<bool, RankingItem> PlaceNext(RankingOracle const & oracle);
+        inline bool Unrank(RankingItem item) { return _placed.Unrank(item); }
+
+        [[nodiscard]] inline bool IsDone() const { return _placed.IsDone(); }
+        [[nodiscard]] inline bool IsRanked(RankingItem item) const { return _placed.IsRanked(item); }
+        [[nodiscard]] inline Ranking const & GetRanking() const { return _placed.GetRanking(); }
+        [[nodiscard]] inline std::size_t GetItemCount() const { return _placed.GetItemCount(); }
+        [[nodiscard]] inline std::size_t GetPoolSize() const { return _placed.GetPoolSize(); }
+        // Every question the oracle was asked, including the ones it answered with a skip and the ones asked again after one.
+        [[nodiscard]] inline std::uint64_t GetQuestionCount() const { return _questionCount; }
+
+        template<class Codec> inline void Save(std::ostream & stream, Codec const & codec) const { _placed.Save(stream, codec); }
+        template<class Codec> inline void Load(std::istream & stream, Codec const & codec) { _placed.Load(stream, codec); }
+
+    private:
+        // Whether a ranks lower than b. Asks the oracle, about whichever of them isn't ranked, unless both are.
+        bool IsLower(RankingItem a, RankingItem b, RankingOracle const & oracle);
+        // Sorts items lowest first.
+        std::vector<RankingItem> Sort(std::vector<RankingItem> const & items, RankingOracle const & oracle);
+
+        RankingEngine _placed;
+        // Every item, shuffled once, so a round worked out again after a skip pairs things up the same way and asks the same questions.
+        std::vector<RankingItem> _order;
+        std::vector<bool> _isSetAside;
+        // Where each ranked item stood when the round started.
+        std::vector<std::size_t> _rankIndices;
+        std::uint64_t _questionCount;
+    };
+}
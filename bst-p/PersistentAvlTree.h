@@ -0,0 +1,170 @@
+#pragma once
+#include "AVLTree.h"
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace BST_P {
+    /*
+     * An immutable AVL tree. Emplace and Remove leave the tree they're called on untouched and return a new version instead.
+     * The new version copies only the nodes on the path from the root to the change (O(log n) of them) and shares every other subtree with the old version.
+     * Nodes and payloads are reference counted, so a node is freed as soon as no version refers to it anymore.
+     *
+     * Copying or moving a version is O(1). Versions may be read from several threads at once, but creating or destroying versions that share nodes
+     * from several threads at once relies on the atomic reference counts of std::shared_ptr and nothing more.
+     */
+    template<class T>
+    class PersistentAvlTree final {
+    public:
+        class ConstIterator;
+
+        typedef std::uint64_t Height;
+
+    private:
+        class Node final {
+        public:
+            friend PersistentAvlTree;
+
+            Node(Node const &) = delete;
+            Node(Node &&) noexcept = delete;
+            Node & operator=(Node const &) = delete;
+            Node & operator=(Node &&) noexcept = delete;
+            inline ~Node() = default;
+
+            inline explicit Node(std::shared_ptr<T const> data, std::shared_ptr<Node const> leftChild, std::shared_ptr<Node const> rightChild)
+                : _data{std::move(data)}
+                , _leftChild{std::move(leftChild)}
+                , _rightChild{std::move(rightChild)}
+                , _height{1U + std::max(HeightOf(_leftChild), HeightOf(_rightChild))} {}
+
+            [[nodiscard]] inline T const * GetData() const { return _data.get(); }
+            [[nodiscard]] inline Node const * GetRightChild() const { return _rightChild.get(); }
+            [[nodiscard]] inline Node const * GetLeftChild() const { return _leftChild.get(); }
+            [[nodiscard]] inline Height GetHeight() const { return _height; }
+
+            [[nodiscard]] static inline Height HeightOf(std::shared_ptr<Node const> const & node) { return !node ? 0U : node->_height; }
+
+        private:
+            std::shared_ptr<T const> _data;
+            std::shared_ptr<Node const> _leftChild;
+            std::shared_ptr<Node const> _rightChild;
+            Height _height;
+        };
+
+        typedef std::shared_ptr<Node const> NodePointer;
+
+    public:
+        /*
+         * Iterators keep the path from the root to their element. They stay valid for as long as the version they came from (or any copy of it) is alive,
+         * no matter how many newer versions are derived from it.
+         */
+        class ConstIterator final {
+            friend PersistentAvlTree;
+
+        public:
+            typedef std::ptrdiff_t difference_type;
+            typedef T value_type;
+            typedef value_type const * pointer;
+            typedef value_type const & reference;
+            typedef std::bidirectional_iterator_tag iterator_category;
+            typedef value_type const * const_pointer;
+            typedef value_type const & const_reference;
+
+            inline ConstIterator(ConstIterator const &) = default;
+            inline ConstIterator(ConstIterator &&) noexcept = default;
+            inline ConstIterator & operator=(ConstIterator const &) = default;
+            inline ConstIterator & operator=(ConstIterator &&) noexcept = default;
+            inline ~ConstIterator() = default;
+
+            [[nodiscard]] inline bool operator==(ConstIterator const & other) const { return (_root == other._root) && (GetNode() == other.GetNode()); }
+            [[nodiscard]] inline bool operator!=(ConstIterator const & other) const { return !operator==(other); }
+            inline pointer operator->() const { return _path.empty() ? nullptr : _path.back()->GetData(); }
+            inline ConstIterator& operator++() { Traverse(false); return *this; }
+            [[nodiscard]] inline ConstIterator operator++(int) { ConstIterator copy{*this}; operator++(); return copy; }
+            inline ConstIterator& operator--() { Traverse(true); return *this; }
+            [[nodiscard]] inline ConstIterator operator--(int) { ConstIterator copy{*this}; operator--(); return copy; }
+
+            [[nodiscard]] reference operator*() const;
+
+        private:
+            inline explicit ConstIterator(Node const * root) : _root{root} {}
+
+            [[nodiscard]] inline Node const * GetNode() const { return _path.empty() ? nullptr : _path.back(); }
+            void DescendToExtreme(Node const * node, bool isDescendingLeft);
+            bool Traverse(bool isTraversingLeft);
+
+            Node const * _root;
+            std::vector<Node const *> _path;
+        };
+
+        typedef T value_type;
+        typedef value_type const * const_pointer;
+        typedef value_type const & const_reference;
+        typedef ConstIterator const_iterator;
+        typedef ConstIterator iterator;
+        typedef typename AvlTree<T>::CompareFunctor CompareFunctor;
+
+        explicit PersistentAvlTree(CompareFunctor defaultCompare = subtract<value_type>{}) : _root{}, _size{0U}, _DefaultCompare{std::move(defaultCompare)} {}
+        PersistentAvlTree(PersistentAvlTree const &) = default;
+        PersistentAvlTree(PersistentAvlTree &&) noexcept = default;
+        PersistentAvlTree & operator=(PersistentAvlTree const &) = default;
+        PersistentAvlTree & operator=(PersistentAvlTree &&) noexcept = default;
+        inline ~PersistentAvlTree() = default;
+
+        [[nodiscard]] const_iterator cbegin() const;
+        [[nodiscard]] inline const_iterator begin() const { return cbegin(); }
+        [[nodiscard]] inline const_iterator cend() const { return const_iterator{_root.get()}; }
+        [[nodiscard]] inline const_iterator end() const { return cend(); }
+        [[nodiscard]] inline const_iterator cFind(const_reference dataToFind) const { return cFind(dataToFind, _DefaultCompare); }
+        [[nodiscard]] inline const_iterator Find(const_reference dataToFind) const { return cFind(dataToFind, _DefaultCompare); }
+        [[nodiscard]] const_iterator cFind(const_reference dataToFind, CompareFunctor const & specializedCompareFunctor) const;
+        [[nodiscard]] inline const_iterator Find(const_reference dataToFind, CompareFunctor const & specializedCompareFunctor) const { return cFind(dataToFind, specializedCompareFunctor); }
+
+        [[nodiscard]] inline Height GetHeight() const { return Node::HeightOf(_root); }
+        [[nodiscard]] inline std::size_t GetSize() const { return _size; }
+        [[nodiscard]] inline bool IsEmpty() const { return !_root; }
+        // True if both versions have the very same root node, which means they hold exactly the same elements.
+        [[nodiscard]] inline bool IsSameVersionAs(PersistentAvlTree const & other) const { return _root == other._root; }
+
+        CompareFunctor const & GetDefaultCompare() const { return _DefaultCompare; }
+
+        // Each of these returns whether the tree was changed, along with the resulting version. If nothing changed, the resulting version is a copy of this one.
+        template<class... Args> std::pair<bool, PersistentAvlTree> Emplace(CompareFunctor const & emplaceCompareFunctor, Args&&... args) const;
+        template<class... Args> inline std::pair<bool, PersistentAvlTree> DefaultEmplace(Args&&... args) const { return Emplace(_DefaultCompare, std::forward<Args>(args)...); }
+        inline std::pair<bool, PersistentAvlTree> Insert(const_reference dataToCopyAndInsert, CompareFunctor const & specializedInsertionCompareFunctor) const {
+            return Emplace(specializedInsertionCompareFunctor, dataToCopyAndInsert);
+        }
+        inline std::pair<bool, PersistentAvlTree> Insert(const_reference dataToCopyAndInsert) const { return Emplace(_DefaultCompare, dataToCopyAndInsert); }
+        inline std::pair<bool, PersistentAvlTree> Insert(value_type && dataToMoveAndInsert, CompareFunctor const & specializedInsertionCompareFunctor) const {
+            return Emplace(specializedInsertionCompareFunctor, std::move(dataToMoveAndInsert));
+        }
+        inline std::pair<bool, PersistentAvlTree> Insert(value_type && dataToMoveAndInsert) const { return Emplace(_DefaultCompare, std::move(dataToMoveAndInsert)); }
+
+        std::pair<bool, PersistentAvlTree> Remove(const_reference dataToRemove, std::shared_ptr<value_type const> & outputRemovedData, CompareFunctor const & specializedCompareFunctor) const;
+        inline std::pair<bool, PersistentAvlTree> Remove(const_reference dataToRemove, CompareFunctor const & specializedCompareFunctor) const {
+            std::shared_ptr<value_type const> _; return Remove(dataToRemove, _, specializedCompareFunctor);
+        }
+        inline std::pair<bool, PersistentAvlTree> Remove(const_reference dataToRemove, std::shared_ptr<value_type const> & outputRemovedData) const {
+            return Remove(dataToRemove, outputRemovedData, _DefaultCompare);
+        }
+        inline std::pair<bool, PersistentAvlTree> Remove(const_reference dataToRemove) const { std::shared_ptr<value_type const> _; return Remove(dataToRemove, _, _DefaultCompare); }
+
+    private:
+        inline explicit PersistentAvlTree(NodePointer root, std::size_t size, CompareFunctor const & defaultCompare) : _root{std::move(root)}, _size{size}, _DefaultCompare{defaultCompare} {}
+
+        static NodePointer Balance(std::shared_ptr<T const> const & data, NodePointer const & leftChild, NodePointer const & rightChild);
+        static NodePointer InsertInto(NodePointer const & node, std::shared_ptr<T const> const & dataToInsert, CompareFunctor const & Compare, Node const *& outputExistingNode);
+        static NodePointer RemoveFrom(NodePointer const & node, const_reference dataToRemove, CompareFunctor const & Compare, std::shared_ptr<T const> & outputRemovedData);
+        static NodePointer RemoveLeftmost(NodePointer const & node, std::shared_ptr<T const> & outputRemovedData);
+
+        NodePointer _root;
+        std::size_t _size;
+
+        CompareFunctor _DefaultCompare;
+    };
+}
+
+#include "PersistentAvlTree.inl"
@@ -0,0 +1,204 @@
+#pragma once
+#include "PersistentAvlTree.h"
+#include <stdexcept>
+
+namespace BST_P {
+    template<class T> T const & PersistentAvlTree<T>::ConstIterator::operator*() const {
+        if (_path.empty()) {
+            throw std::out_of_range{"Cannot dereference null node!"};
+        }
+
+        return *(_path.back()->GetData());
+    }
+
+    template<class T> void PersistentAvlTree<T>::ConstIterator::DescendToExtreme(Node const * node, bool isDescendingLeft) {
+        for (; node != nullptr; node = isDescendingLeft ? node->GetLeftChild() : node->GetRightChild()) {
+            _path.push_back(node);
+        }
+    }
+
+    template<class T> bool PersistentAvlTree<T>::ConstIterator::Traverse(bool isTraversingLeft) {
+        if (_path.empty()) {
+            // Stepping back from end() lands on the rightmost element. Stepping forward from end() stays put.
+            if (!isTraversingLeft || (_root == nullptr)) {
+                return false;
+            }
+
+            DescendToExtreme(_root, false);
+            return true;
+        }
+
+        Node const * current = _path.back();
+
+        if ((isTraversingLeft ? current->GetLeftChild() : current->GetRightChild()) != nullptr) {
+            DescendToExtreme(isTraversingLeft ? current->GetLeftChild() : current->GetRightChild(), !isTraversingLeft);
+            return true;
+        }
+
+        // Climb until we arrive from the opposite side. Running out of path means we walked off the end.
+        std::vector<Node const *> previousPath = isTraversingLeft ? _path : std::vector<Node const *>{};
+        _path.pop_back();
+
+        while (!_path.empty() && ((isTraversingLeft ? _path.back()->GetLeftChild() : _path.back()->GetRightChild()) == current)) {
+            current = _path.back();
+            _path.pop_back();
+        }
+
+        // Like AvlTree, stepping back from the first element leaves the iterator where it was.
+        if (_path.empty() && isTraversingLeft) {
+            _path = std::move(previousPath);
+            return false;
+        }
+
+        return true;
+    }
+
+    template<class T> typename PersistentAvlTree<T>::const_iterator PersistentAvlTree<T>::cbegin() const {
+        const_iterator itr{_root.get()};
+        itr.DescendToExtreme(_root.get(), true);
+        return itr;
+    }
+
+    template<class T> typename PersistentAvlTree<T>::const_iterator PersistentAvlTree<T>::cFind(const_reference dataToFind, CompareFunctor const & Compare) const {
+        const_iterator itr{_root.get()};
+
+        for (Node const * node = _root.get(); node != nullptr;) {
+            itr._path.push_back(node);
+            int comparison = Compare(dataToFind, *(node->GetData()));
+
+            if (comparison == 0) {
+                return itr;
+            }
+
+            node = (comparison > 0) ? node->GetRightChild() : node->GetLeftChild();
+        }
+
+        // equivalent to end()
+        itr._path.clear();
+        return itr;
+    }
+
+    template<class T> template<class... Args> std::pair<bool, PersistentAvlTree<T>> PersistentAvlTree<T>::Emplace(CompareFunctor const & Compare, Args&&... args) const {
+        std::shared_ptr<T const> emplaced = std::make_shared<T const>(std::forward<Args>(args)...);
+        Node const * existingNode = nullptr;
+        NodePointer root = InsertInto(_root, emplaced, Compare, existingNode);
+
+        if (existingNode != nullptr) {
+            return std::make_pair(false, *this);
+        }
+
+        return std::make_pair(true, PersistentAvlTree{std::move(root), _size + 1U, _DefaultCompare});
+    }
+
+    template<class T> std::pair<bool, PersistentAvlTree<T>> PersistentAvlTree<T>::Remove(const_reference dataToRemove, std::shared_ptr<value_type const> & outputRemovedData, CompareFunctor const & Compare) const {
+        std::shared_ptr<T const> removed;
+        NodePointer root = RemoveFrom(_root, dataToRemove, Compare, removed);
+
+        if (!removed) {
+            return std::make_pair(false, *this);
+        }
+
+        outputRemovedData = std::move(removed);
+        return std::make_pair(true, PersistentAvlTree{std::move(root), _size - 1U, _DefaultCompare});
+    }
+
+    template<class T> typename PersistentAvlTree<T>::NodePointer PersistentAvlTree<T>::Balance(std::shared_ptr<T const> const & data, NodePointer const & leftChild, NodePointer const & rightChild) {
+        Height leftHeight = Node::HeightOf(leftChild);
+        Height rightHeight = Node::HeightOf(rightChild);
+
+        // Every node here is freshly made, so "rotating" just means building the rotated shape out of the existing subtrees.
+        if (leftHeight > rightHeight + 1U) {
+            if (Node::HeightOf(leftChild->_leftChild) >= Node::HeightOf(leftChild->_rightChild)) {
+                return std::make_shared<Node const>(leftChild->_data, leftChild->_leftChild, std::make_shared<Node const>(data, leftChild->_rightChild, rightChild));
+            }
+
+            // It's a complex rotation; the inner grandchild ends up on top.
+            Node const & grandchild = *(leftChild->_rightChild);
+            return std::make_shared<Node const>(
+                grandchild._data,
+                std::make_shared<Node const>(leftChild->_data, leftChild->_leftChild, grandchild._leftChild),
+                std::make_shared<Node const>(data, grandchild._rightChild, rightChild)
+            );
+        }
+
+        if (rightHeight > leftHeight + 1U) {
+            if (Node::HeightOf(rightChild->_rightChild) >= Node::HeightOf(rightChild->_leftChild)) {
+                return std::make_shared<Node const>(rightChild->_data, std::make_shared<Node const>(data, leftChild, rightChild->_leftChild), rightChild->_rightChild);
+            }
+
+            Node const & grandchild = *(rightChild->_leftChild);
+            return std::make_shared<Node const>(
+                grandchild._data,
+                std::make_shared<Node const>(data, leftChild, grandchild._leftChild),
+                std::make_shared<Node const>(rightChild->_data, grandchild._rightChild, rightChild->_rightChild)
+            );
+        }
+
+        return std::make_shared<Node const>(data, leftChild, rightChild);
+    }
+
+    template<class T> typename PersistentAvlTree<T>::NodePointer PersistentAvlTree<T>::InsertInto(NodePointer const & node, std::shared_ptr<T const> const & dataToInsert, CompareFunctor const & Compare, Node const *& outputExistingNode) {
+        if (!node) {
+            return std::make_shared<Node const>(dataToInsert, nullptr, nullptr);
+        }
+
+        int comparison = Compare(*dataToInsert, *(node->GetData()));
+
+        if (comparison == 0) {
+            outputExistingNode = node.get();
+            return node;
+        }
+
+        // Only the nodes along the search path are rebuilt. The untouched sibling subtrees are shared with the previous version.
+        if (comparison < 0) {
+            NodePointer leftChild = InsertInto(node->_leftChild, dataToInsert, Compare, outputExistingNode);
+            return (outputExistingNode != nullptr) ? node : Balance(node->_data, leftChild, node->_rightChild);
+        }
+
+        NodePointer rightChild = InsertInto(node->_rightChild, dataToInsert, Compare, outputExistingNode);
+        return (outputExistingNode != nullptr) ? node : Balance(node->_data, node->_leftChild, rightChild);
+    }
+
+    template<class T> typename PersistentAvlTree<T>::NodePointer PersistentAvlTree<T>::RemoveFrom(NodePointer const & node, const_reference dataToRemove, CompareFunctor const & Compare, std::shared_ptr<T const> & outputRemovedData) {
+        if (!node) {
+            return node;
+        }
+
+        int comparison = Compare(dataToRemove, *(node->GetData()));
+
+        if (comparison < 0) {
+            NodePointer leftChild = RemoveFrom(node->_leftChild, dataToRemove, Compare, outputRemovedData);
+            return !outputRemovedData ? node : Balance(node->_data, leftChild, node->_rightChild);
+        }
+
+        if (comparison > 0) {
+            NodePointer rightChild = RemoveFrom(node->_rightChild, dataToRemove, Compare, outputRemovedData);
+            return !outputRemovedData ? node : Balance(node->_data, node->_leftChild, rightChild);
+        }
+
+        outputRemovedData = node->_data;
+
+        if (!(node->_leftChild)) {
+            return node->_rightChild;
+        }
+
+        if (!(node->_rightChild)) {
+            return node->_leftChild;
+        }
+
+        // With two children, the in-order successor's payload takes this node's place.
+        std::shared_ptr<T const> successorData;
+        NodePointer rightChild = RemoveLeftmost(node->_rightChild, successorData);
+        return Balance(successorData, node->_leftChild, rightChild);
+    }
+
+    template<class T> typename PersistentAvlTree<T>::NodePointer PersistentAvlTree<T>::RemoveLeftmost(NodePointer const & node, std::shared_ptr<T const> & outputRemovedData) {
+        if (!(node->_leftChild)) {
+            outputRemovedData = node->_data;
+            return node->_rightChild;
+        }
+
+        NodePointer leftChild = RemoveLeftmost(node->_leftChild, outputRemovedData);
+        return Balance(node->_data, leftChild, node->_rightChild);
+    }
+}
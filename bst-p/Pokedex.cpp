@@ -1,6 +1,6 @@
 #include "Pokedex.h"
 #include <cassert>
-#include <exception>
+#include <stdexcept>
 #include <fstream>
 #include <iostream>
 #include <limits>
@@ -23,7 +23,7 @@ Pokedex::Pokedex(char const * filename) {
                     break; // ID of 0 indicates end of the list.
                 }
                 std::cout << "Invalid ID " << id << " given!";
-                throw std::exception{"Bad ID given to Pokedex in constructor!"};
+                throw std::invalid_argument{"Bad ID given to Pokedex in constructor!"};
             }
 
             datafile >> token;
@@ -34,7 +34,7 @@ Pokedex::Pokedex(char const * filename) {
 
             if ((stat < 0) || (static_cast<long long>(stat) >= static_cast<long long>(std::numeric_limits<PokemonBaseStatValue>::max()))) {
                 std::cout << "Invalid HP value " << stat << "given!";
-                throw std::exception{"Bad HP value given to Pokedex in constructor!"};
+                throw std::invalid_argument{"Bad HP value given to Pokedex in constructor!"};
             }
 
             pokemon.SetBaseStat(PokemonBaseStatEnumId::HP, static_cast<PokemonBaseStatValue>(stat));
@@ -44,7 +44,7 @@ Pokedex::Pokedex(char const * filename) {
 
             if ((stat < 0) || (static_cast<long long>(stat) >= static_cast<long long>(std::numeric_limits<PokemonBaseStatValue>::max()))) {
                 std::cout << "Invalid Attack value " << stat << "given!";
-                throw std::exception{"Bad Attack value given to Pokedex in constructor!"};
+                throw std::invalid_argument{"Bad Attack value given to Pokedex in constructor!"};
             }
 
             pokemon.SetBaseStat(PokemonBaseStatEnumId::Attack, static_cast<PokemonBaseStatValue>(stat));
@@ -54,7 +54,7 @@ Pokedex::Pokedex(char const * filename) {
 
             if ((stat < 0) || (static_cast<long long>(stat) >= static_cast<long long>(std::numeric_limits<PokemonBaseStatValue>::max()))) {
                 std::cout << "Invalid Defense value " << stat << "given!";
-                throw std::exception{"Bad Defense value given to Pokedex in constructor!"};
+                throw std::invalid_argument{"Bad Defense value given to Pokedex in constructor!"};
             }
 
             pokemon.SetBaseStat(PokemonBaseStatEnumId::Defense, static_cast<PokemonBaseStatValue>(stat));
@@ -64,7 +64,7 @@ Pokedex::Pokedex(char const * filename) {
 
             if ((stat < 0) || (static_cast<long long>(stat) >= static_cast<long long>(std::numeric_limits<PokemonBaseStatValue>::max()))) {
                 std::cout << "Invalid Speed value " << stat << "given!";
-                throw std::exception{"Bad Speed value given to Pokedex in constructor!"};
+                throw std::invalid_argument{"Bad Speed value given to Pokedex in constructor!"};
             }
 
             pokemon.SetBaseStat(PokemonBaseStatEnumId::Speed, static_cast<PokemonBaseStatValue>(stat));
@@ -74,7 +74,7 @@ Pokedex::Pokedex(char const * filename) {
 
             if ((stat < 0) || (static_cast<long long>(stat) >= static_cast<long long>(std::numeric_limits<PokemonBaseStatValue>::max()))) {
                 std::cout << "Invalid Special value " << stat << "given!";
-                throw std::exception{"Bad Special value given to Pokedex in constructor!"};
+                throw std::invalid_argument{"Bad Special value given to Pokedex in constructor!"};
             }
 
             pokemon.SetBaseStat(PokemonBaseStatEnumId::Special, static_cast<PokemonBaseStatValue>(stat));
@@ -85,7 +85,7 @@ Pokedex::Pokedex(char const * filename) {
 
             if ((stat < 0) || (stat >= static_cast<int>(std::numeric_limits<PokemonEvolutionaryStage>::max()))) {
                 std::cout << "Invalid evolutionary stage value " << stat << "given!";
-                throw std::exception{ "Bad evolutionary stage value given to Pokedex in constructor!" };
+                throw std::invalid_argument{"Bad evolutionary stage value given to Pokedex in constructor!" };
             }
 
             pokemon.SetEvolutionaryStage(evolutionStage);
@@ -95,7 +95,7 @@ Pokedex::Pokedex(char const * filename) {
 
             if ((stat < 0) || (stat >= static_cast<int>(std::numeric_limits<RemainingPokemonEvolutionaryStages>::max()))) {
                 std::cout << "Invalid remaining evolution count " << stat << "given!";
-                throw std::exception{ "Bad remaining evolution count given to Pokedex in constructor!" };
+                throw std::invalid_argument{"Bad remaining evolution count given to Pokedex in constructor!" };
             }
 
             pokemon.SetEvolutionaryStagesLeft(evolutionsLeft);
@@ -114,7 +114,7 @@ Pokemon const & Pokedex::FindPokemon(PokemonId const id) const {
 
     if (found == _data.end()) {
         std::cout << "Cannot find Pokemon [" << id << "] in the Pokedex!\n";
-        throw std::exception{"Pokemon not in Pokedex!"};
+        throw std::out_of_range{"Pokemon not in Pokedex!"};
     }
 
     return found->second;
@@ -1,6 +1,7 @@
 #include "Pokemon.h"
 #include <cassert>
 #include <climits>
+#include <limits>
 
 namespace BST_P {
     PokemonBaseStat::PokemonBaseStat(PokemonBaseStatEnumId id, PokemonBaseStatValue value) : _id{id}, _value{value} {
@@ -0,0 +1,193 @@
+#include "RankingEngine.h"
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+
+namespace BST_P {
+
+RankingEngine::RankingEngine(std::size_t itemCount, std::uint32_t seed, std::size_t batchSize)
+    : _ranking{&CompareUnasked}
+    , _pool(itemCount)
+    , _positions(itemCount)
+    , _random{seed}
+    , _questionCount{0U}
+    , _batchSize{std::max<std::size_t>(batchSize, 1U)} {
+    for (std::size_t i = 0U; i < itemCount; ++i) {
+        _pool[i] = static_cast<RankingItem>(i);
+    }
+}
+
+std::pair<bool, RankingItem> RankingEngine::PlaceNext(RankingOracle const & oracle) {
+    if (_pool.empty()) {
+        throw std::out_of_range{"There's nothing left to rank."};
+    }
+
+    if (_batchSize > 1U) {
+        return PlaceBatch(oracle);
+    }
+
+    std::size_t index = std::uniform_int_distribution<std::size_t>{0U, _pool.size() - 1U}(_random);
+    RankingItem item = _pool[index];
+    bool isSkipping = false;
+
+    auto inserted = _ranking.Insert(item, [this, &oracle, &isSkipping](RankingItem const & a, RankingItem const & b) {
+        // Once skipped, the item just runs down the right side without asking anything, to be taken back out.
+        if (isSkipping) {
+            return 1;
+        }
+
+        RankingAnswer answer = Ask(oracle, a, b);
+        isSkipping = answer == RankingAnswer::Skip;
+
+        return (answer == RankingAnswer::Lower) ? -1 : 1;
+    });
+
+    if (isSkipping) {
+        _ranking.Remove(std::move(inserted.second));
+        return {false, item};
+    }
+
+    _positions[item] = inserted.second;
+    _pool[index] = _pool.back();
+    _pool.pop_back();
+
+    return {true, item};
+}
+
+std::pair<bool, RankingItem> RankingEngine::PlaceBatch(RankingOracle const & oracle) {
+    std::vector<RankingItem> batch;
+    batch.reserve(std::min(_batchSize, _pool.size()));
+
+    while ((batch.size() < _batchSize) && !_pool.empty()) {
+        std::size_t index = std::uniform_int_distribution<std::size_t>{0U, _pool.size() - 1U}(_random);
+        RankingItem item = _pool[index];
+        _pool[index] = _pool.back();
+        _pool.pop_back();
+
+        auto first = batch.begin();
+        auto last = batch.end();
+
+        while (first != last) {
+            auto middle = first + ((last - first) / 2);
+            RankingAnswer answer = Ask(oracle, item, *middle);
+
+            if (answer == RankingAnswer::Skip) {
+                _pool.push_back(item);
+                _pool.insert(_pool.end(), batch.cbegin(), batch.cend());
+                return {false, item};
+            }
+
+            if (answer == RankingAnswer::Lower) {
+                last = middle;
+            } else {
+                first = middle + 1;
+            }
+        }
+
+        batch.insert(first, item);
+    }
+
+    Ranking::const_iterator position = _ranking.cbegin();
+    // How many ranked items there are from position on.
+    std::size_t remainingCount = _ranking.GetSize();
+    std::vector<Ranking::const_iterator> stride;
+
+    for (std::size_t i = 0U; i < batch.size(); ++i) {
+        RankingItem item = batch[i];
+        RankingAnswer answer = RankingAnswer::Higher;
+
+        // Gallop until the item ranks lower than the last item of a stride, or there's nothing left to rank it lower than.
+        while ((remainingCount > 0U) && (answer == RankingAnswer::Higher)) {
+            std::size_t strideLength = 1U;
+            stride.clear();
+
+            while ((strideLength * 2U * (batch.size() - i)) <= remainingCount) {
+                strideLength *= 2U;
+            }
+
+            for (std::size_t j = 0U; j < strideLength; ++j, ++position) {
+                stride.push_back(position);
+            }
+
+            answer = Ask(oracle, item, *(stride.back()));
+
+            if (answer == RankingAnswer::Higher) {
+                remainingCount -= strideLength;
+            }
+        }
+
+        // Then it goes somewhere before the end of that stride, so the rest of the stride is binary searched.
+        if (answer == RankingAnswer::Lower) {
+            std::size_t first = 0U;
+            std::size_t last = stride.size() - 1U;
+
+            while ((first != last) && (answer != RankingAnswer::Skip)) {
+                std::size_t middle = first + ((last - first) / 2U);
+                answer = Ask(oracle, item, *(stride[middle]));
+
+                if (answer == RankingAnswer::Lower) {
+                    last = middle;
+                } else {
+                    first = middle + 1U;
+                }
+            }
+
+            position = stride[first];
+            remainingCount -= first;
+        }
+
+        if (answer == RankingAnswer::Skip) {
+            _pool.insert(_pool.end(), batch.cbegin() + static_cast<std::ptrdiff_t>(i), batch.cend());
+            return {false, item};
+        }
+
+        _positions[item] = _ranking.EmplaceBefore(position, item);
+    }
+
+    return {true, batch.back()};
+}
+
+bool RankingEngine::Unrank(RankingItem item) {
+    if (!IsRanked(item)) {
+        return false;
+    }
+
+    _ranking.Remove(std::move(*(_positions[item])));
+    _positions[item].reset();
+    _pool.push_back(item);
+
+    return true;
+}
+
+int RankingEngine::CompareUnasked(RankingItem const &, RankingItem const &) {
+    throw std::logic_error{"Ranked items can only be compared by asking the oracle."};
+}
+
+void RankingEngine::Adopt(Ranking && ranking) {
+    std::vector<bool> isInRanking(_positions.size(), false);
+
+    for (RankingItem item : ranking) {
+        if ((item >= isInRanking.size()) || isInRanking[item]) {
+            throw std::runtime_error{"The saved ranking doesn't match the items being ranked."};
+        }
+
+        isInRanking[item] = true;
+    }
+
+    _ranking = std::move(ranking);
+    _pool.clear();
+
+    for (std::size_t i = 0U; i < _positions.size(); ++i) {
+        _positions[i].reset();
+
+        if (!isInRanking[i]) {
+            _pool.push_back(static_cast<RankingItem>(i));
+        }
+    }
+
+    for (auto itr = _ranking.begin(); itr != _ranking.end(); ++itr) {
+        _positions[*itr] = itr;
+    }
+}
+
+}
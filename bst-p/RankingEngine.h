@@ -0,0 +1,93 @@
+#pragma once
+#include "AVLTree.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace BST_P {
+    // Items are numbered from 0. For the Pokedex, an item is its Pokemon's ID minus one.
+    typedef std::uint32_t RankingItem;
+
+    enum class RankingAnswer {
+        Higher,
+        Lower,
+        // Puts the item being placed back into the pool for later.
+        Skip,
+    };
+
+    // Asked whether item, the one being placed, should rank higher or lower than rankedItem. This is the only way a ranking engine learns anything about the items.
+    typedef std::function<RankingAnswer(RankingItem item, RankingItem rankedItem)> RankingOracle;
+
+    // Lowest first.
+    typedef AvlTree<RankingItem> Ranking;
+
+    /*
+     * Ranks items by binary insertion into an AvlTree, going by whatever the oracle answers. Each step picks an item from the pool at random
+     * and walks it down the ranking, asking one question per level. The oracle can be a person, or a stand-in for one when simulating.
+     * Nothing is known about the items except through the oracle, so the ranking's default compare functor throws; nothing the engine does calls it.
+     *
+     * With a batch size over one, each step instead draws a batch, ranks it among itself by binary insertion, and then merges it into the ranking
+     * from lowest to highest. Each item gallops on from where the last one went, in strides of the largest power of two that fits the ranked items
+     * left per batch item left, and then binary searches the last stride. That searches by position rather than down the tree, and skips past
+     * whatever the lower items already ruled out. A skip ends the batch early, returning the rest of it to the pool.
+     */
+    class RankingEngine final {
+    public:
+        RankingEngine(std::size_t itemCount, std::uint32_t seed, std::size_t batchSize = 1U);
+        RankingEngine(RankingEngine const &) = delete;
+        RankingEngine(RankingEngine &&) noexcept = delete;
+        RankingEngine & operator=(RankingEngine const &) = delete;
+        RankingEngine & operator=(RankingEngine &&) noexcept = delete;
+        inline ~RankingEngine() = default;
+
+        // Places an item, or a batch of them, from the pool. Returns whether they were placed rather than one being skipped, and either the item skipped
+        // or the last one placed. Throws std::out_of_range if the pool is empty.
+        std::pair<bool, RankingItem> PlaceNext(RankingOracle const & oracle);
+        // Takes a ranked item back out and returns it to the pool. Returns false if it wasn't ranked.
+        bool Unrank(RankingItem item);
+
+        [[nodiscard]] inline bool IsDone() const { return _pool.empty(); }
+        [[nodiscard]] inline bool IsRanked(RankingItem item) const { return (item < _positions.size()) && _positions[item].has_value(); }
+        [[nodiscard]] inline Ranking const & GetRanking() const { return _ranking; }
+        [[nodiscard]] inline std::size_t GetItemCount() const { return _positions.size(); }
+        [[nodiscard]] inline std::size_t GetPoolSize() const { return _pool.size(); }
+        [[nodiscard]] inline std::size_t GetBatchSize() const { return _batchSize; }
+        // Every question the oracle was asked, including the ones it answered with a skip.
+        [[nodiscard]] inline std::uint64_t GetQuestionCount() const { return _questionCount; }
+
+        template<class Codec> inline void Save(std::ostream & stream, Codec const & codec) const { _ranking.Save(stream, codec); }
+        // Replaces the ranking with a saved one, and puts every item it doesn't hold back into the pool.
+        // Throws, leaving the engine as it was, if the stream isn't a saved ranking of this engine's items.
+        template<class Codec> void Load(std::istream & stream, Codec const & codec) {
+            Ranking loaded{&CompareUnasked};
+            loaded.Load(stream, codec);
+            Adopt(std::move(loaded));
+        }
+        // Replaces the ranking with one worked out some other way, and puts every item it doesn't hold back into the pool.
+        // Throws std::runtime_error, leaving the engine as it was, if it holds anything other than this engine's items, or holds one twice.
+        void Adopt(Ranking && ranking);
+
+        [[noreturn]] static int CompareUnasked(RankingItem const & a, RankingItem const & b);
+
+    private:
+        // It places items itself, straight into the ranking and out of the pool.
+        friend class InterleavedRankingEngine;
+
+        std::pair<bool, RankingItem> PlaceBatch(RankingOracle const & oracle);
+        inline RankingAnswer Ask(RankingOracle const & oracle, RankingItem item, RankingItem rankedItem) { ++_questionCount; return oracle(item, rankedItem); }
+
+        Ranking _ranking;
+        std::vector<RankingItem> _pool;
+        // Where each ranked item sits, so it can be taken out again without asking anything. Empty for items in the pool.
+        std::vector<std::optional<Ranking::iterator>> _positions;
+        std::mt19937 _random;
+        std::uint64_t _questionCount;
+        std::size_t _batchSize;
+    };
+}
@@ -0,0 +1,117 @@
+#include "RankingOracles.h"
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace BST_P {
+
+namespace {
+    inline bool IsRankedHigher(std::vector<std::uint32_t> const & scores, RankingItem item, RankingItem rankedItem) {
+        return (scores.at(item) != scores.at(rankedItem)) ? (scores[item] > scores[rankedItem]) : (item > rankedItem);
+    }
+
+    inline std::uint64_t MakePairKey(RankingItem a, RankingItem b) {
+        return (static_cast<std::uint64_t>(a) << 32U) | b;
+    }
+}
+
+RankingOracle MakeGroundTruthOracle(std::vector<std::uint32_t> scores) {
+    return [scores = std::move(scores)](RankingItem item, RankingItem rankedItem) {
+        return IsRankedHigher(scores, item, rankedItem) ? RankingAnswer::Higher : RankingAnswer::Lower;
+    };
+}
+
+RankingOracle MakeNoisyOracle(std::vector<std::uint32_t> scores, double errorRate, std::uint32_t seed) {
+    // Shared, so copies of the oracle draw from one sequence instead of repeating each other's mistakes.
+    auto random = std::make_shared<std::mt19937>(seed);
+
+    return [scores = std::move(scores), errorRate, random](RankingItem item, RankingItem rankedItem) {
+        bool isWrong = std::bernoulli_distribution{errorRate}(*random);
+        return (IsRankedHigher(scores, item, rankedItem) != isWrong) ? RankingAnswer::Higher : RankingAnswer::Lower;
+    };
+}
+
+std::vector<RecordedAnswer> ReadRecordedAnswers(std::istream & answers) {
+    std::vector<RecordedAnswer> recorded;
+    std::string line;
+    std::size_t lineNumber = 0U;
+
+    while (std::getline(answers, line)) {
+        ++lineNumber;
+
+        std::size_t first = line.find_first_not_of(" \t\r");
+
+        if (first == std::string::npos) {
+            continue;
+        }
+
+        std::istringstream fields{line};
+        std::uint64_t item = 0U;
+
+        if (line[first] == '-') {
+            char forget = 0;
+            fields >> forget >> item;
+
+            if (!fields || (item > UINT32_MAX)) {
+                throw std::runtime_error{"Recorded forget " + std::to_string(lineNumber) + " isn't - and an item."};
+            }
+
+            std::erase_if(recorded, [item](RecordedAnswer const & answer) { return (answer.item == item) || (answer.rankedItem == item); });
+            continue;
+        }
+
+        std::uint64_t rankedItem = 0U;
+        char answer = 0;
+        fields >> item >> rankedItem >> answer;
+
+        if (!fields || (item > UINT32_MAX) || (rankedItem > UINT32_MAX) || ((answer != '>') && (answer != '<'))) {
+            throw std::runtime_error{"Recorded answer " + std::to_string(lineNumber) + " isn't an item, a ranked item, and > or <."};
+        }
+
+        recorded.push_back(RecordedAnswer{static_cast<RankingItem>(item), static_cast<RankingItem>(rankedItem), (answer == '>') ? RankingAnswer::Higher : RankingAnswer::Lower});
+    }
+
+    return recorded;
+}
+
+RankingOracle MakeReplayOracle(std::istream & answers) {
+    // Each pair is kept in the order it was answered in, mapped to whether the first item ranked higher.
+    auto isHigherByPair = std::make_shared<std::unordered_map<std::uint64_t, bool>>();
+
+    for (RecordedAnswer const & recorded : ReadRecordedAnswers(answers)) {
+        (*isHigherByPair)[MakePairKey(recorded.item, recorded.rankedItem)] = recorded.answer == RankingAnswer::Higher;
+    }
+
+    return [isHigherByPair](RankingItem item, RankingItem rankedItem) {
+        auto found = isHigherByPair->find(MakePairKey(item, rankedItem));
+
+        if (found != isHigherByPair->end()) {
+            return found->second ? RankingAnswer::Higher : RankingAnswer::Lower;
+        }
+
+        found = isHigherByPair->find(MakePairKey(rankedItem, item));
+
+        if (found == isHigherByPair->end()) {
+            throw std::runtime_error{"There's no recorded answer comparing " + std::to_string(item) + " and " + std::to_string(rankedItem) + "."};
+        }
+
+        return found->second ? RankingAnswer::Lower : RankingAnswer::Higher;
+    };
+}
+
+void RecordAnswer(std::ostream & answers, RankingItem item, RankingItem rankedItem, RankingAnswer answer) {
+    if (answer == RankingAnswer::Skip) {
+        return;
+    }
+
+    answers << item << " " << rankedItem << " " << ((answer == RankingAnswer::Higher) ? '>' : '<') << "\n";
+}
+
+void RecordForget(std::ostream & answers, RankingItem item) {
+    answers << "- " << item << "\n";
+}
+
+}
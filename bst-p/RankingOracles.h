@@ -0,0 +1,35 @@
+#pragma once
+#include "RankingEngine.h"
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace BST_P {
+    // Stand-ins for a person, for running ranking engines headless. scores is indexed by item.
+
+    // Higher scores rank higher. Ties go to the higher item, so the order is total.
+    [[nodiscard]] RankingOracle MakeGroundTruthOracle(std::vector<std::uint32_t> scores);
+    // Answers like the ground truth, except each answer is wrong with probability errorRate. Asked the same question twice, it may not answer the same way twice.
+    [[nodiscard]] RankingOracle MakeNoisyOracle(std::vector<std::uint32_t> scores, double errorRate, std::uint32_t seed);
+
+    struct RecordedAnswer {
+        RankingItem item;
+        RankingItem rankedItem;
+        RankingAnswer answer;
+    };
+
+    /*
+     * Reads recorded answers, one per line: the item that was being placed, the ranked item it was compared to, and > if it ranked higher or < if lower.
+     * A line of - and an item records that the item's answers were forgotten, and drops every answer about it from before that line.
+     * They're returned in the order they were recorded in. A malformed line throws std::runtime_error.
+     */
+    [[nodiscard]] std::vector<RecordedAnswer> ReadRecordedAnswers(std::istream & answers);
+    // Answers from recorded answers, which are all read up front. A pair answered one way round answers the other way round too.
+    // Asking about a pair that was never answered throws std::runtime_error.
+    [[nodiscard]] RankingOracle MakeReplayOracle(std::istream & answers);
+    // Writes an answer in the format MakeReplayOracle reads. Skips aren't written, since they say nothing about the order.
+    void RecordAnswer(std::ostream & answers, RankingItem item, RankingItem rankedItem, RankingAnswer answer);
+    // Writes that every answer about item so far was forgotten, so that reading the answers back doesn't bring them back.
+    void RecordForget(std::ostream & answers, RankingItem item);
+}
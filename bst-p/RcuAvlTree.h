@@ -0,0 +1,118 @@
+#pragma once
+#include "EpochDomain.h"
+#include "PersistentAvlTree.h"
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+namespace BST_P {
+    /*
+     * A tree many threads can read while one thread at a time writes to it, with readers never blocking.
+     * Every update builds a new PersistentAvlTree version off to the side and publishes it with a single atomic pointer store.
+     * A reader pins whichever version is published when it calls Read() and sees exactly that version until its ReadView is destroyed.
+     * Replaced versions are handed to an EpochDomain and freed once no ReadView can still be pointing at them.
+     *
+     * Writers are serialized against each other by a mutex that readers never touch.
+     */
+    template<class T>
+    class RcuAvlTree final {
+    public:
+        typedef PersistentAvlTree<T> Version;
+        typedef T value_type;
+        typedef value_type const & const_reference;
+        typedef typename Version::CompareFunctor CompareFunctor;
+
+        // Replaced versions are collected in batches so a burst of small writes doesn't rescan the reader slots every time.
+        static constexpr std::size_t RECLAIM_INTERVAL = 32U;
+
+        class ReadView final {
+            friend RcuAvlTree;
+
+        public:
+            ReadView(ReadView const &) = delete;
+            inline ReadView(ReadView &&) noexcept = default;
+            ReadView & operator=(ReadView const &) = delete;
+            ReadView & operator=(ReadView &&) noexcept = delete;
+            inline ~ReadView() = default;
+
+            [[nodiscard]] inline Version const & operator*() const { return *_version; }
+            [[nodiscard]] inline Version const * operator->() const { return _version; }
+
+        private:
+            inline explicit ReadView(EpochDomain::ReadGuard && guard, Version const * version) : _guard{std::move(guard)}, _version{version} {}
+
+            EpochDomain::ReadGuard _guard;
+            Version const * _version;
+        };
+
+        explicit RcuAvlTree(CompareFunctor defaultCompare = subtract<value_type>{}) : _published{new Version{std::move(defaultCompare)}}, _updatesSinceReclaim{0U} {}
+        RcuAvlTree(RcuAvlTree const &) = delete;
+        RcuAvlTree(RcuAvlTree &&) noexcept = delete;
+        RcuAvlTree & operator=(RcuAvlTree const &) = delete;
+        RcuAvlTree & operator=(RcuAvlTree &&) noexcept = delete;
+        inline ~RcuAvlTree() { delete _published.load(std::memory_order_relaxed); }
+
+        // Iterators taken from the view are only valid while the view is alive.
+        [[nodiscard]] ReadView Read() const;
+        // A copy of the current version that stays valid on its own, at the cost of touching the root's reference count.
+        [[nodiscard]] inline Version Snapshot() const { return *Read(); }
+
+        /*
+         * Runs updater on the current version and publishes what it returns, if it reports a change.
+         * updater takes a Version const & and returns the std::pair<bool, Version> that Version's own Emplace and Remove return.
+         */
+        template<class Updater> bool Update(Updater && updater);
+
+        template<class... Args> inline bool Emplace(CompareFunctor const & emplaceCompareFunctor, Args&&... args) {
+            return Update([&](Version const & current) { return current.Emplace(emplaceCompareFunctor, std::forward<Args>(args)...); });
+        }
+        template<class... Args> inline bool DefaultEmplace(Args&&... args) {
+            return Update([&](Version const & current) { return current.DefaultEmplace(std::forward<Args>(args)...); });
+        }
+        inline bool Insert(const_reference dataToCopyAndInsert) { return DefaultEmplace(dataToCopyAndInsert); }
+        inline bool Insert(value_type && dataToMoveAndInsert) { return DefaultEmplace(std::move(dataToMoveAndInsert)); }
+        inline bool Remove(const_reference dataToRemove) { return Update([&](Version const & current) { return current.Remove(dataToRemove); }); }
+        inline bool Remove(const_reference dataToRemove, CompareFunctor const & specializedCompareFunctor) {
+            return Update([&](Version const & current) { return current.Remove(dataToRemove, specializedCompareFunctor); });
+        }
+
+        // Frees whatever replaced versions no reader can see anymore. Writers call this on their own every RECLAIM_INTERVAL updates.
+        inline std::size_t Reclaim() { return _domain.Reclaim(); }
+        [[nodiscard]] inline std::size_t GetRetiredVersionCount() const { return _domain.GetRetiredCount(); }
+
+    private:
+        mutable EpochDomain _domain;
+        std::atomic<Version const *> _published;
+
+        std::mutex _writerMutex;
+        std::size_t _updatesSinceReclaim;
+    };
+
+    template<class T> typename RcuAvlTree<T>::ReadView RcuAvlTree<T>::Read() const {
+        // Announce first, then load. The other order would let a writer free the version between the load and the announcement.
+        EpochDomain::ReadGuard guard = _domain.EnterRead();
+        Version const * version = _published.load(std::memory_order_seq_cst);
+        return ReadView{std::move(guard), version};
+    }
+
+    template<class T> template<class Updater> bool RcuAvlTree<T>::Update(Updater && updater) {
+        std::lock_guard<std::mutex> lock{_writerMutex};
+        Version const * current = _published.load(std::memory_order_relaxed);
+        std::pair<bool, Version> result = updater(*current);
+
+        if (!result.first) {
+            return false;
+        }
+
+        _published.store(new Version{std::move(result.second)}, std::memory_order_seq_cst);
+        _domain.Retire(current);
+
+        if (++_updatesSinceReclaim >= RECLAIM_INTERVAL) {
+            _updatesSinceReclaim = 0U;
+            _domain.Reclaim();
+        }
+
+        return true;
+    }
+}
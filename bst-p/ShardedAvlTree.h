@@ -0,0 +1,111 @@
+#pragma once
+#include "AVLTree.h"
+#include "EpochDomain.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <vector>
+
+namespace BST_P {
+    /*
+     * An ordered set split by key range into independent AvlTree shards, each behind its own reader-writer lock.
+     * Operations on keys in different shards touch no common lock or counter, so they run in parallel without contending.
+     *
+     * The list of shards (the directory) is immutable once published and is swapped out whole, RCU style, whenever shards are split or merged.
+     * Operations find their shard without locking, lock only that shard, and retry if a split or merge moved their key elsewhere in the meantime.
+     * A shard that grows past the maximum shard size is split at its median; one that shrinks below a quarter of it is merged into a neighbour.
+     * Only size decides that, not how busy a shard is, so a small shard that every writer hits stays whole. Both hand the elements over in O(n) without comparing them.
+     *
+     * Shards are ordered by the default compare functor, so there are no overloads taking a specialized one.
+     */
+    template<class T>
+    class ShardedAvlTree final {
+    public:
+        typedef T value_type;
+        typedef value_type const & const_reference;
+        typedef typename AvlTree<T>::CompareFunctor CompareFunctor;
+
+        static constexpr std::size_t DEFAULT_MAX_SHARD_SIZE = 4096U;
+
+    private:
+        class Shard final {
+        public:
+            friend ShardedAvlTree;
+
+            inline explicit Shard(CompareFunctor const & compare, std::unique_ptr<T const> lowerBound, std::unique_ptr<T const> upperBound)
+                : _tree{compare}, _size{0U}, _lowerBound{std::move(lowerBound)}, _upperBound{std::move(upperBound)}, _isRetired{false} {}
+
+        private:
+            mutable std::shared_mutex _mutex;
+            AvlTree<T> _tree;
+            // Only written under the exclusive lock, but read without it by GetSize.
+            std::atomic<std::size_t> _size;
+            // Inclusive, and never changes. Null means the shard is unbounded below.
+            std::unique_ptr<T const> const _lowerBound;
+            // Exclusive, and only changes under the exclusive lock when the shard is split or merged. Null means unbounded above.
+            std::unique_ptr<T const> _upperBound;
+            // Set under the exclusive lock when the shard has been merged into its left neighbour.
+            bool _isRetired;
+        };
+
+        struct Directory {
+            std::vector<Shard *> shards;
+        };
+
+    public:
+        explicit ShardedAvlTree(CompareFunctor defaultCompare = subtract<value_type>{}, std::size_t maxShardSize = DEFAULT_MAX_SHARD_SIZE);
+        ShardedAvlTree(ShardedAvlTree const &) = delete;
+        ShardedAvlTree(ShardedAvlTree &&) noexcept = delete;
+        ShardedAvlTree & operator=(ShardedAvlTree const &) = delete;
+        ShardedAvlTree & operator=(ShardedAvlTree &&) noexcept = delete;
+        ~ShardedAvlTree();
+
+        // A copy of the stored element equal to dataToFind, if there is one.
+        [[nodiscard]] std::optional<value_type> Find(const_reference dataToFind) const;
+        [[nodiscard]] inline bool Contains(const_reference dataToFind) const { return Find(dataToFind).has_value(); }
+
+        // Visits every element in order, across all shards. Splits and merges wait until it's done; each shard is read-locked while it's visited.
+        template<class Visitor> void ForEach(Visitor && visitor) const;
+
+        // These return whether the tree was changed, like AvlTree's do.
+        template<class... Args> bool DefaultEmplace(Args&&... args);
+        inline bool Insert(const_reference dataToCopyAndInsert) { return DefaultEmplace(dataToCopyAndInsert); }
+        inline bool Insert(value_type && dataToMoveAndInsert) { return DefaultEmplace(std::move(dataToMoveAndInsert)); }
+        bool Remove(const_reference dataToRemove);
+
+        // Exact only when no writer is running.
+        [[nodiscard]] std::size_t GetSize() const;
+        [[nodiscard]] inline bool IsEmpty() const { return GetSize() == 0U; }
+        [[nodiscard]] std::size_t GetShardCount() const;
+        [[nodiscard]] inline std::size_t GetMaxShardSize() const { return _maxShardSize; }
+
+        CompareFunctor const & GetDefaultCompare() const { return _DefaultCompare; }
+
+    private:
+        [[nodiscard]] bool IsInShard(Shard const & shard, const_reference data) const;
+        [[nodiscard]] std::size_t FindShardIndex(Directory const & directory, const_reference data) const;
+        // Runs operation on the shard that owns data, with that shard locked exclusively or shared.
+        template<bool IS_EXCLUSIVE, class Operation> void WithShardFor(const_reference data, Operation && operation) const;
+
+        // Both give up if someone else is restructuring already; the next operation that finds the shard too big or too small will try again.
+        void TrySplitShard(Shard * shard);
+        void TryMergeShard(Shard * shard);
+        // Moves every element from source onto the end of destination, which must be its left neighbour. Both must be locked exclusively.
+        static void MoveAllElements(Shard & source, Shard & destination);
+        // Requires _restructureMutex. Replaces the directory and retires the old one.
+        void PublishDirectory(std::unique_ptr<Directory> directory);
+
+        mutable EpochDomain _domain;
+        std::atomic<Directory const *> _directory;
+        // Serializes splits, merges and ForEach. Operations on elements never touch it.
+        mutable std::mutex _restructureMutex;
+        std::size_t const _maxShardSize;
+
+        CompareFunctor _DefaultCompare;
+    };
+}
+
+#include "ShardedAvlTree.inl"
@@ -0,0 +1,268 @@
+#pragma once
+#include "ShardedAvlTree.h"
+#include <algorithm>
+#include <cassert>
+
+namespace BST_P {
+    template<class T> ShardedAvlTree<T>::ShardedAvlTree(CompareFunctor defaultCompare, std::size_t maxShardSize)
+        : _domain{}
+        , _directory{new Directory{{new Shard{defaultCompare, nullptr, nullptr}}}}
+        , _maxShardSize{maxShardSize}
+        , _DefaultCompare{std::move(defaultCompare)} {
+        // Smaller shards would be merged as soon as they're split.
+        assert(maxShardSize >= 4U);
+    }
+
+    template<class T> ShardedAvlTree<T>::~ShardedAvlTree() {
+        Directory const * directory = _directory.load();
+
+        for (Shard * shard : directory->shards) {
+            delete shard;
+        }
+
+        delete directory;
+    }
+
+    template<class T> bool ShardedAvlTree<T>::IsInShard(Shard const & shard, const_reference data) const {
+        return !shard._isRetired && (!shard._upperBound || (_DefaultCompare(data, *(shard._upperBound)) < 0));
+    }
+
+    template<class T> std::size_t ShardedAvlTree<T>::FindShardIndex(Directory const & directory, const_reference data) const {
+        // The last shard whose lower bound is at or below data. Lower bounds never change, so no lock is needed to read them.
+        std::size_t low = 0U;
+        std::size_t high = directory.shards.size();
+
+        while (high - low > 1U) {
+            std::size_t middle = low + ((high - low) / 2U);
+
+            if (_DefaultCompare(data, *(directory.shards[middle]->_lowerBound)) >= 0) {
+                low = middle;
+            } else {
+                high = middle;
+            }
+        }
+
+        return low;
+    }
+
+    template<class T> template<bool IS_EXCLUSIVE, class Operation> void ShardedAvlTree<T>::WithShardFor(const_reference data, Operation && operation) const {
+        EpochDomain::ReadGuard guard = _domain.EnterRead();
+
+        for (;;) {
+            Directory const * directory = _directory.load();
+            Shard & shard = *(directory->shards[FindShardIndex(*directory, data)]);
+
+            if constexpr (IS_EXCLUSIVE) {
+                std::unique_lock<std::shared_mutex> lock{shard._mutex};
+
+                if (IsInShard(shard, data)) {
+                    operation(shard);
+                    return;
+                }
+            } else {
+                std::shared_lock<std::shared_mutex> lock{shard._mutex};
+
+                if (IsInShard(shard, data)) {
+                    operation(shard);
+                    return;
+                }
+            }
+
+            // A split or merge moved data's range to another shard after we read the directory. The new directory is already published.
+        }
+    }
+
+    template<class T> std::optional<T> ShardedAvlTree<T>::Find(const_reference dataToFind) const {
+        std::optional<value_type> found;
+
+        WithShardFor<false>(dataToFind, [&found, &dataToFind](Shard & shard) {
+            auto itr = shard._tree.cFind(dataToFind);
+
+            if (itr != shard._tree.cend()) {
+                found.emplace(*itr);
+            }
+        });
+
+        return found;
+    }
+
+    template<class T> template<class Visitor> void ShardedAvlTree<T>::ForEach(Visitor && visitor) const {
+        std::lock_guard<std::mutex> restructureLock{_restructureMutex};
+
+        // Nothing can replace the directory while we hold the restructure lock.
+        for (Shard const * shard : _directory.load()->shards) {
+            std::shared_lock<std::shared_mutex> lock{shard->_mutex};
+
+            for (auto itr = shard->_tree.cbegin(); itr != shard->_tree.cend(); ++itr) {
+                visitor(*itr);
+            }
+        }
+    }
+
+    template<class T> template<class... Args> bool ShardedAvlTree<T>::DefaultEmplace(Args&&... args) {
+        // The element has to exist before we know which shard it goes in.
+        value_type emplaced(std::forward<Args>(args)...);
+        bool isEmplaced = false;
+        Shard * owner = nullptr;
+
+        WithShardFor<true>(emplaced, [&](Shard & shard) {
+            isEmplaced = shard._tree.DefaultEmplace(std::move(emplaced)).first;
+
+            if (isEmplaced) {
+                shard._size.store(shard._size.load(std::memory_order_relaxed) + 1U, std::memory_order_relaxed);
+            }
+
+            owner = (shard._size.load(std::memory_order_relaxed) > _maxShardSize) ? &shard : nullptr;
+        });
+
+        if (owner != nullptr) {
+            TrySplitShard(owner);
+        }
+
+        return isEmplaced;
+    }
+
+    template<class T> bool ShardedAvlTree<T>::Remove(const_reference dataToRemove) {
+        bool isRemoved = false;
+        Shard * owner = nullptr;
+
+        WithShardFor<true>(dataToRemove, [&](Shard & shard) {
+            isRemoved = shard._tree.Remove(dataToRemove);
+
+            if (isRemoved) {
+                shard._size.store(shard._size.load(std::memory_order_relaxed) - 1U, std::memory_order_relaxed);
+            }
+
+            owner = (shard._size.load(std::memory_order_relaxed) < (_maxShardSize / 4U)) ? &shard : nullptr;
+        });
+
+        if (isRemoved && (owner != nullptr)) {
+            TryMergeShard(owner);
+        }
+
+        return isRemoved;
+    }
+
+    template<class T> std::size_t ShardedAvlTree<T>::GetSize() const {
+        EpochDomain::ReadGuard guard = _domain.EnterRead();
+        std::size_t size = 0U;
+
+        for (Shard const * shard : _directory.load()->shards) {
+            size += shard->_size.load(std::memory_order_relaxed);
+        }
+
+        return size;
+    }
+
+    template<class T> std::size_t ShardedAvlTree<T>::GetShardCount() const {
+        EpochDomain::ReadGuard guard = _domain.EnterRead();
+        return _directory.load()->shards.size();
+    }
+
+    template<class T> void ShardedAvlTree<T>::TrySplitShard(Shard * shard) {
+        std::unique_lock<std::mutex> restructureLock{_restructureMutex, std::try_to_lock};
+
+        if (!restructureLock.owns_lock()) {
+            return;
+        }
+
+        // Only restructuring retires shards, so every shard in the current directory stays alive while we hold the restructure lock.
+        // If shard isn't in it anymore, someone else already dealt with it.
+        Directory const & directory = *(_directory.load());
+        auto position = std::find(directory.shards.begin(), directory.shards.end(), shard);
+
+        if (position == directory.shards.end()) {
+            return;
+        }
+
+        {
+            std::unique_lock<std::shared_mutex> lock{shard->_mutex};
+            std::size_t size = shard->_size.load(std::memory_order_relaxed);
+
+            if (size <= _maxShardSize) {
+                return;
+            }
+
+            auto median = shard->_tree.cbegin();
+            for (std::size_t i = 0U; i < size / 2U; ++i) {
+                ++median;
+            }
+
+            // The upper half, median included, is handed over as it is and relinked in O(n), so the lock isn't held through a comparison or an allocation per element.
+            auto upperShard = std::make_unique<Shard>(_DefaultCompare, std::make_unique<T const>(*median), std::move(shard->_upperBound));
+            upperShard->_tree = shard->_tree.SplitOff(median);
+
+            shard->_upperBound = std::make_unique<T const>(*(upperShard->_lowerBound));
+            upperShard->_size.store(size - (size / 2U), std::memory_order_relaxed);
+            shard->_size.store(size / 2U, std::memory_order_relaxed);
+
+            auto splitDirectory = std::make_unique<Directory>(directory);
+            splitDirectory->shards.insert(splitDirectory->shards.begin() + ((position - directory.shards.begin()) + 1), upperShard.release());
+
+            // Publish before unlocking, so anyone who finds the upper half missing from this shard also finds the new directory.
+            PublishDirectory(std::move(splitDirectory));
+        }
+
+        _domain.Reclaim();
+    }
+
+    template<class T> void ShardedAvlTree<T>::TryMergeShard(Shard * shard) {
+        std::unique_lock<std::mutex> restructureLock{_restructureMutex, std::try_to_lock};
+
+        if (!restructureLock.owns_lock()) {
+            return;
+        }
+
+        Directory const & directory = *(_directory.load());
+        auto position = std::find(directory.shards.begin(), directory.shards.end(), shard);
+
+        if ((position == directory.shards.end()) || (directory.shards.size() < 2U)) {
+            return;
+        }
+
+        // Merge with whichever neighbour is smaller. The left shard always absorbs the right one, so that lower bounds never have to change.
+        std::size_t index = static_cast<std::size_t>(position - directory.shards.begin());
+        bool hasLeftNeighbour = index > 0U;
+        bool hasRightNeighbour = index + 1U < directory.shards.size();
+        bool isMergingLeft = hasLeftNeighbour && (!hasRightNeighbour
+            || (directory.shards[index - 1U]->_size.load(std::memory_order_relaxed) < directory.shards[index + 1U]->_size.load(std::memory_order_relaxed)));
+        std::size_t leftIndex = isMergingLeft ? (index - 1U) : index;
+        Shard * left = directory.shards[leftIndex];
+        Shard * right = directory.shards[leftIndex + 1U];
+
+        {
+            // Key order, though with restructuring serialized nobody else ever holds two shard locks anyway.
+            std::unique_lock<std::shared_mutex> leftLock{left->_mutex};
+            std::unique_lock<std::shared_mutex> rightLock{right->_mutex};
+
+            // Leave some room so the merged shard doesn't split again right away.
+            if ((shard->_size.load(std::memory_order_relaxed) >= (_maxShardSize / 4U))
+                || (left->_size.load(std::memory_order_relaxed) + right->_size.load(std::memory_order_relaxed) > (_maxShardSize / 2U))) {
+                return;
+            }
+
+            MoveAllElements(*right, *left);
+            left->_upperBound = std::move(right->_upperBound);
+            right->_isRetired = true;
+
+            auto mergedDirectory = std::make_unique<Directory>(directory);
+            mergedDirectory->shards.erase(mergedDirectory->shards.begin() + (leftIndex + 1U));
+            PublishDirectory(std::move(mergedDirectory));
+            _domain.Retire(right);
+        }
+
+        // Only now that right is unlocked; operations still waiting on its lock hold read guards, so it won't actually be freed until they see it's retired.
+        _domain.Reclaim();
+    }
+
+    template<class T> void ShardedAvlTree<T>::MoveAllElements(Shard & source, Shard & destination) {
+        destination._tree.Append(std::move(source._tree));
+
+        destination._size.store(destination._size.load(std::memory_order_relaxed) + source._size.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        source._size.store(0U, std::memory_order_relaxed);
+    }
+
+    template<class T> void ShardedAvlTree<T>::PublishDirectory(std::unique_ptr<Directory> directory) {
+        _domain.Retire(_directory.exchange(directory.release()));
+    }
+}
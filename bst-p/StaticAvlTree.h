@@ -0,0 +1,122 @@
+#pragma once
+#include "AVLTree.h"
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace BST_P {
+    /*
+     * A fixed-capacity ordered set that works entirely in constant expressions, for lookup tables that are known at compile time.
+     * Nodes live in an array inside the tree and link to each other by index, so nothing is allocated and a finished tree can itself be constexpr.
+     * Insert, Find and iteration all work in a consteval context, and Freeze copies the elements out into a sorted std::array for a static constexpr table.
+     *
+     * Besides their children, nodes are threaded to their neighbours in order. Rotations never change the order, so iteration is a single load per step.
+     * Elements have to be default constructible, since every slot holds one, and the comparator has to be callable in constant expressions.
+     * Going past CAPACITY throws std::length_error, which in a constant expression is a compile error.
+     */
+    template<class T, std::size_t CAPACITY, class Compare = subtract<T>>
+    class StaticAvlTree final {
+        static_assert(std::is_default_constructible_v<T>, "StaticAvlTree holds an element in every slot, so elements have to be default constructible.");
+
+    public:
+        typedef T value_type;
+        typedef value_type const * const_pointer;
+        typedef value_type const & const_reference;
+
+    private:
+        typedef std::size_t Index;
+
+        // The slot past the last node is the header. It stands in for every missing child, so its height has to stay 0,
+        // and it closes the thread, so its next node is the first element and its previous node is the last.
+        static constexpr Index HEADER = CAPACITY;
+
+        // No AVL tree that fits in memory is taller than this.
+        static constexpr std::size_t MAX_HEIGHT = 2U * (sizeof(Index) * 8U);
+
+        struct Node {
+            T data{};
+            Index leftChild = HEADER;
+            Index rightChild = HEADER;
+            Index next = HEADER;
+            Index previous = HEADER;
+            std::size_t height = 0U;
+        };
+
+    public:
+        class ConstIterator final {
+            friend StaticAvlTree;
+
+        public:
+            typedef std::ptrdiff_t difference_type;
+            typedef T value_type;
+            typedef value_type const * pointer;
+            typedef value_type const & reference;
+            typedef std::bidirectional_iterator_tag iterator_category;
+
+            constexpr ConstIterator(ConstIterator const &) = default;
+            constexpr ConstIterator(ConstIterator &&) noexcept = default;
+            constexpr ConstIterator & operator=(ConstIterator const &) = default;
+            constexpr ConstIterator & operator=(ConstIterator &&) noexcept = default;
+            constexpr ~ConstIterator() = default;
+
+            [[nodiscard]] constexpr bool operator==(ConstIterator const & other) const { return (_nodes == other._nodes) && (_index == other._index); }
+            [[nodiscard]] constexpr bool operator!=(ConstIterator const & other) const { return !operator==(other); }
+            [[nodiscard]] constexpr reference operator*() const { return _nodes[_index].data; }
+            constexpr pointer operator->() const { return &(_nodes[_index].data); }
+            constexpr ConstIterator & operator++() { _index = _nodes[_index].next; return *this; }
+            [[nodiscard]] constexpr ConstIterator operator++(int) { ConstIterator copy{*this}; operator++(); return copy; }
+            constexpr ConstIterator & operator--() { _index = _nodes[_index].previous; return *this; }
+            [[nodiscard]] constexpr ConstIterator operator--(int) { ConstIterator copy{*this}; operator--(); return copy; }
+
+        private:
+            constexpr ConstIterator(Node const * nodes, Index index) : _nodes{nodes}, _index{index} {}
+
+            Node const * _nodes;
+            Index _index;
+        };
+
+        typedef ConstIterator const_iterator;
+
+        constexpr explicit StaticAvlTree(Compare compare = Compare{}) : _nodes{}, _root{HEADER}, _size{0U}, _Compare{compare} {}
+        constexpr StaticAvlTree(StaticAvlTree const &) = default;
+        constexpr StaticAvlTree(StaticAvlTree &&) noexcept = default;
+        constexpr StaticAvlTree & operator=(StaticAvlTree const &) = default;
+        constexpr StaticAvlTree & operator=(StaticAvlTree &&) noexcept = default;
+        constexpr ~StaticAvlTree() = default;
+
+        // Returns false, and leaves the tree alone, if an equal element is already in it. Throws std::length_error if the tree is full.
+        constexpr bool Insert(const_reference data);
+
+        [[nodiscard]] constexpr const_iterator Find(const_reference dataToFind) const;
+        [[nodiscard]] constexpr bool Contains(const_reference dataToFind) const { return Find(dataToFind) != end(); }
+
+        // Copies the elements out in order. SIZE has to be exactly the tree's size, or this throws std::length_error.
+        template<std::size_t SIZE> [[nodiscard]] constexpr std::array<T, SIZE> Freeze() const;
+
+        [[nodiscard]] constexpr const_iterator begin() const { return const_iterator{_nodes.data(), _nodes[HEADER].next}; }
+        [[nodiscard]] constexpr const_iterator cbegin() const { return begin(); }
+        [[nodiscard]] constexpr const_iterator end() const { return const_iterator{_nodes.data(), HEADER}; }
+        [[nodiscard]] constexpr const_iterator cend() const { return end(); }
+
+        [[nodiscard]] constexpr std::size_t GetSize() const { return _size; }
+        [[nodiscard]] static constexpr std::size_t GetCapacity() { return CAPACITY; }
+        [[nodiscard]] constexpr bool IsEmpty() const { return _size == 0U; }
+        [[nodiscard]] constexpr std::size_t GetHeight() const { return _nodes[_root].height; }
+
+    private:
+        [[nodiscard]] constexpr Index & GetChild(Index node, bool isLeftChild) { return isLeftChild ? _nodes[node].leftChild : _nodes[node].rightChild; }
+        constexpr void UpdateHeight(Index node);
+        // Returns the subtree's new top.
+        [[nodiscard]] constexpr Index Rotate(Index top, bool isRotatingLeft);
+        [[nodiscard]] constexpr Index Rebalance(Index node);
+
+        std::array<Node, CAPACITY + 1U> _nodes;
+        Index _root;
+        std::size_t _size;
+
+        Compare _Compare;
+    };
+}
+
+#include "StaticAvlTree.inl"
@@ -0,0 +1,129 @@
+#pragma once
+#include "StaticAvlTree.h"
+#include <stdexcept>
+
+namespace BST_P {
+    template<class T, std::size_t CAPACITY, class Compare> constexpr bool StaticAvlTree<T, CAPACITY, Compare>::Insert(const_reference data) {
+        std::array<Index, MAX_HEIGHT> path{};
+        std::array<bool, MAX_HEIGHT> isPathLeft{};
+        std::size_t depth = 0U;
+        // The last nodes the search passed on the right and on the left are the new node's neighbours in order.
+        Index previous = HEADER;
+        Index next = HEADER;
+
+        for (Index node = _root; node != HEADER;) {
+            int comparison = _Compare(data, _nodes[node].data);
+
+            if (comparison == 0) {
+                return false;
+            }
+
+            path[depth] = node;
+            isPathLeft[depth] = comparison < 0;
+            ++depth;
+
+            if (comparison < 0) {
+                next = node;
+            } else {
+                previous = node;
+            }
+
+            node = GetChild(node, comparison < 0);
+        }
+
+        if (_size == CAPACITY) {
+            throw std::length_error{"StaticAvlTree is full!"};
+        }
+
+        Index inserted = _size++;
+        _nodes[inserted] = Node{data, HEADER, HEADER, next, previous, 1U};
+        _nodes[previous].next = inserted;
+        _nodes[next].previous = inserted;
+
+        Index subtree = inserted;
+
+        while (depth > 0U) {
+            --depth;
+            GetChild(path[depth], isPathLeft[depth]) = subtree;
+            subtree = Rebalance(path[depth]);
+        }
+
+        _root = subtree;
+        return true;
+    }
+
+    template<class T, std::size_t CAPACITY, class Compare> constexpr typename StaticAvlTree<T, CAPACITY, Compare>::const_iterator StaticAvlTree<T, CAPACITY, Compare>::Find(const_reference dataToFind) const {
+        for (Index node = _root; node != HEADER;) {
+            int comparison = _Compare(dataToFind, _nodes[node].data);
+
+            if (comparison == 0) {
+                return const_iterator{_nodes.data(), node};
+            }
+
+            node = (comparison < 0) ? _nodes[node].leftChild : _nodes[node].rightChild;
+        }
+
+        return end();
+    }
+
+    template<class T, std::size_t CAPACITY, class Compare> template<std::size_t SIZE> constexpr std::array<T, SIZE> StaticAvlTree<T, CAPACITY, Compare>::Freeze() const {
+        if (SIZE != _size) {
+            throw std::length_error{"Frozen array has to be the same size as the tree!"};
+        }
+
+        std::array<T, SIZE> frozen{};
+        std::size_t i = 0U;
+
+        for (const_reference element : *this) {
+            frozen[i++] = element;
+        }
+
+        return frozen;
+    }
+
+    template<class T, std::size_t CAPACITY, class Compare> constexpr void StaticAvlTree<T, CAPACITY, Compare>::UpdateHeight(Index node) {
+        std::size_t leftHeight = _nodes[_nodes[node].leftChild].height;
+        std::size_t rightHeight = _nodes[_nodes[node].rightChild].height;
+        _nodes[node].height = ((leftHeight > rightHeight) ? leftHeight : rightHeight) + 1U;
+    }
+
+    template<class T, std::size_t CAPACITY, class Compare> constexpr typename StaticAvlTree<T, CAPACITY, Compare>::Index StaticAvlTree<T, CAPACITY, Compare>::Rotate(Index top, bool isRotatingLeft) {
+        Index pivot = GetChild(top, !isRotatingLeft);
+        GetChild(top, !isRotatingLeft) = GetChild(pivot, isRotatingLeft);
+        GetChild(pivot, isRotatingLeft) = top;
+
+        UpdateHeight(top);
+        UpdateHeight(pivot);
+        return pivot;
+    }
+
+    template<class T, std::size_t CAPACITY, class Compare> constexpr typename StaticAvlTree<T, CAPACITY, Compare>::Index StaticAvlTree<T, CAPACITY, Compare>::Rebalance(Index node) {
+        UpdateHeight(node);
+
+        std::size_t leftHeight = _nodes[_nodes[node].leftChild].height;
+        std::size_t rightHeight = _nodes[_nodes[node].rightChild].height;
+
+        if (leftHeight > rightHeight + 1U) {
+            Index child = _nodes[node].leftChild;
+
+            // A child leaning the other way needs a double rotation.
+            if (_nodes[_nodes[child].rightChild].height > _nodes[_nodes[child].leftChild].height) {
+                _nodes[node].leftChild = Rotate(child, true);
+            }
+
+            return Rotate(node, false);
+        }
+
+        if (rightHeight > leftHeight + 1U) {
+            Index child = _nodes[node].rightChild;
+
+            if (_nodes[_nodes[child].leftChild].height > _nodes[_nodes[child].rightChild].height) {
+                _nodes[node].rightChild = Rotate(child, false);
+            }
+
+            return Rotate(node, true);
+        }
+
+        return node;
+    }
+}
@@ -0,0 +1,155 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+namespace BST_P {
+
+namespace {
+    // Lets Push and TaskGroup::Wait tell whether they're running on one of the pool's own workers, and which one.
+    thread_local WorkStealingPool const * currentPool = nullptr;
+    thread_local std::size_t currentQueueIndex = 0U;
+}
+
+void WorkStealingPool::TaskGroup::Run(Task task) {
+    _pendingCount.fetch_add(1U, std::memory_order_relaxed);
+
+    _pool.Push([this, task = std::move(task)]() {
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock{_exceptionMutex};
+
+            if (!_exception) {
+                _exception = std::current_exception();
+            }
+        }
+
+        _pendingCount.fetch_sub(1U, std::memory_order_release);
+    });
+}
+
+void WorkStealingPool::TaskGroup::Wait() {
+    WaitForPendingTasks();
+
+    std::exception_ptr exception;
+    std::swap(exception, _exception);
+
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+void WorkStealingPool::TaskGroup::WaitForPendingTasks() {
+    std::size_t queueIndex = _pool.GetCurrentQueueIndex();
+
+    // Help out rather than block; the task we're waiting on may be sitting in our own deque.
+    while (_pendingCount.load(std::memory_order_acquire) > 0U) {
+        if (!_pool.TryRunOne(queueIndex)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+WorkStealingPool::WorkStealingPool(std::size_t threadCount) : _queuedCount{0U}, _nextExternalQueue{0U}, _isStopping{false} {
+    if (threadCount == 0U) {
+        threadCount = std::max<std::size_t>(std::thread::hardware_concurrency(), 1U);
+    }
+
+    for (std::size_t i = 0U; i < threadCount; ++i) {
+        _queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    for (std::size_t i = 0U; i < threadCount; ++i) {
+        _threads.emplace_back(&WorkStealingPool::WorkerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock{_sleepMutex};
+        _isStopping = true;
+    }
+
+    _wakeUp.notify_all();
+
+    for (std::thread & thread : _threads) {
+        thread.join();
+    }
+}
+
+WorkStealingPool & WorkStealingPool::GetDefault() {
+    static WorkStealingPool pool;
+    return pool;
+}
+
+std::size_t WorkStealingPool::GetCurrentQueueIndex() {
+    // Threads from outside the pool spread their tasks over the workers round robin.
+    return (currentPool == this) ? currentQueueIndex : (_nextExternalQueue.fetch_add(1U, std::memory_order_relaxed) % _queues.size());
+}
+
+void WorkStealingPool::Push(Task task) {
+    WorkerQueue & queue = *(_queues[GetCurrentQueueIndex()]);
+
+    {
+        std::lock_guard<std::mutex> lock{queue.mutex};
+        queue.tasks.push_back(std::move(task));
+    }
+
+    _queuedCount.fetch_add(1U, std::memory_order_release);
+
+    // Taking the lock orders this against a worker that has just checked for work and is about to sleep.
+    {
+        std::lock_guard<std::mutex> lock{_sleepMutex};
+    }
+
+    _wakeUp.notify_one();
+}
+
+bool WorkStealingPool::TryRunOne(std::size_t queueIndex) {
+    Task task;
+
+    for (std::size_t i = 0U; !task && (i < _queues.size()); ++i) {
+        bool isOwnQueue = i == 0U;
+        WorkerQueue & queue = *(_queues[(queueIndex + i) % _queues.size()]);
+        std::lock_guard<std::mutex> lock{queue.mutex};
+
+        if (queue.tasks.empty()) {
+            continue;
+        }
+
+        if (isOwnQueue) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+
+    if (!task) {
+        return false;
+    }
+
+    _queuedCount.fetch_sub(1U, std::memory_order_relaxed);
+    task();
+    return true;
+}
+
+void WorkStealingPool::WorkerLoop(std::size_t queueIndex) {
+    currentPool = this;
+    currentQueueIndex = queueIndex;
+
+    for (;;) {
+        if (TryRunOne(queueIndex)) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock{_sleepMutex};
+        _wakeUp.wait(lock, [this]() { return _isStopping || (_queuedCount.load(std::memory_order_acquire) > 0U); });
+
+        if (_isStopping && (_queuedCount.load(std::memory_order_acquire) == 0U)) {
+            return;
+        }
+    }
+}
+
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace BST_P {
+    /*
+     * A fixed set of worker threads, each with its own task deque. A worker pushes and pops its own tasks at the back (newest first, for locality)
+     * and, when it runs dry, steals the oldest task from the front of another worker's deque. Oldest tasks tend to be the biggest pieces of work
+     * in a recursive split, so steals are rare and worth it.
+     *
+     * Tasks are submitted and waited on through a TaskGroup. A thread waiting on a group runs pending tasks instead of blocking,
+     * so tasks may safely wait on groups of their own.
+     */
+    class WorkStealingPool final {
+    public:
+        typedef std::function<void()> Task;
+
+        class TaskGroup final {
+        public:
+            inline explicit TaskGroup(WorkStealingPool & pool) : _pool{pool}, _pendingCount{0U} {}
+            TaskGroup(TaskGroup const &) = delete;
+            TaskGroup(TaskGroup &&) noexcept = delete;
+            TaskGroup & operator=(TaskGroup const &) = delete;
+            TaskGroup & operator=(TaskGroup &&) noexcept = delete;
+            // Tasks refer to the group, so it can't go away before they're done. An exception nobody waited for is dropped.
+            inline ~TaskGroup() { WaitForPendingTasks(); }
+
+            void Run(Task task);
+            // Returns once every task run through this group has finished, rethrowing the first exception any of them threw.
+            void Wait();
+
+        private:
+            void WaitForPendingTasks();
+
+            WorkStealingPool & _pool;
+            std::atomic<std::size_t> _pendingCount;
+            std::mutex _exceptionMutex;
+            std::exception_ptr _exception;
+        };
+
+        // Zero means one thread per hardware thread.
+        explicit WorkStealingPool(std::size_t threadCount = 0U);
+        WorkStealingPool(WorkStealingPool const &) = delete;
+        WorkStealingPool(WorkStealingPool &&) noexcept = delete;
+        WorkStealingPool & operator=(WorkStealingPool const &) = delete;
+        WorkStealingPool & operator=(WorkStealingPool &&) noexcept = delete;
+        // Finishes every task already submitted before returning.
+        ~WorkStealingPool();
+
+        [[nodiscard]] inline std::size_t GetThreadCount() const { return _threads.size(); }
+
+        // A process-wide pool with one thread per hardware thread, created on first use.
+        static WorkStealingPool & GetDefault();
+
+    private:
+        struct WorkerQueue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        void Push(Task task);
+        // Runs one task from the given worker's own deque or, failing that, one stolen from another. Returns false if there was nothing to run.
+        bool TryRunOne(std::size_t queueIndex);
+        [[nodiscard]] std::size_t GetCurrentQueueIndex();
+        void WorkerLoop(std::size_t queueIndex);
+
+        std::vector<std::unique_ptr<WorkerQueue>> _queues;
+        std::vector<std::thread> _threads;
+        std::atomic<std::size_t> _queuedCount;
+        std::atomic<std::size_t> _nextExternalQueue;
+
+        std::mutex _sleepMutex;
+        std::condition_variable _wakeUp;
+        bool _isStopping;
+    };
+}
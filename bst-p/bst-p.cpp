@@ -1,25 +1,83 @@
 #include <iostream>
-#include "AvlTree.h"
+#include "ComparisonCache.h"
+#include "InterleavedRankingEngine.h"
+#include "MergeInsertionEngine.h"
 #include "Pokedex.h"
-#include <format>
+#include "RankingEngine.h"
+#include "RankingOracles.h"
 #include "cpp11-strfmt.h"
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+constexpr char const * RANKING_FILE_NAME = "ranking.dat";
+constexpr char const * RANKING_TEMPORARY_FILE_NAME = "ranking.dat.tmp";
+// Every answer given, in the format MakeReplayOracle reads, so sessions can be replayed headless.
+constexpr char const * ANSWERS_FILE_NAME = "answers.txt";
+// Pass this to rank with MergeInsertionEngine rather than RankingEngine.
+constexpr char const * MERGE_INSERTION_OPTION = "--merge-insertion";
+// Pass this and a batch size to have RankingEngine place Pokemon in batches.
+constexpr char const * BATCH_OPTION = "--batch";
+// Pass this and a count to have that many Pokemon being placed at once, with their questions asked in a shuffled order.
+constexpr char const * INTERLEAVE_OPTION = "--interleave";
+
+BST_P::Pokemon const & FindRankedPokemon(BST_P::Pokedex const & pokedex, BST_P::RankingItem item) {
+    return pokedex.FindPokemon(static_cast<BST_P::PokemonId>(item + 1U));
+}
+
+// Saves each Pokemon by its ID and checks it's in the Pokedex when loading.
+class PokemonIdCodec final {
+public:
+    inline explicit PokemonIdCodec(BST_P::Pokedex const & pokedex) : _pokedex{pokedex} {}
+
+    void Encode(std::ostream & stream, BST_P::RankingItem item) const { BST_P::WriteLittleEndian(stream, item + 1U, sizeof(BST_P::PokemonId)); }
+    BST_P::RankingItem Decode(std::istream & stream) const {
+        BST_P::PokemonId id = static_cast<BST_P::PokemonId>(BST_P::ReadLittleEndian(stream, sizeof(BST_P::PokemonId)));
+        return static_cast<BST_P::RankingItem>(_pokedex.FindPokemon(id).GetId() - 1U);
+    }
+
+private:
+    BST_P::Pokedex const & _pokedex;
+};
+
+// Saves to a temporary file first and only then replaces the last save with it, so a failed save never costs the ranking that was already saved.
+template<class Engine> void SaveRanking(Engine const & engine, PokemonIdCodec const & codec) {
+    std::ofstream savedRanking{RANKING_TEMPORARY_FILE_NAME, std::ios::binary | std::ios::trunc};
+
+    if (!savedRanking) {
+        std::cout << "Couldn't save the ranking: " << RANKING_TEMPORARY_FILE_NAME << " couldn't be opened.\n";
+        return;
+    }
+
+    try {
+        engine.Save(savedRanking, codec);
+        savedRanking.close();
+
+        if (!savedRanking) {
+            throw std::runtime_error{"It couldn't be written."};
+        }
+    } catch (std::exception const & e) {
+        std::cout << "Couldn't save the ranking to " << RANKING_TEMPORARY_FILE_NAME << ": " << e.what() << "\n";
+        std::error_code ignored;
+        std::filesystem::remove(RANKING_TEMPORARY_FILE_NAME, ignored);
+        return;
+    }
+
+    // Unlike std::rename, this replaces the old save on Windows too.
+    std::error_code error;
+    std::filesystem::rename(RANKING_TEMPORARY_FILE_NAME, RANKING_FILE_NAME, error);
 
-/*
- * Need to rewrite Node::FindHeight(SubtreeHeightMap)
- * Need to rewrite Rotate
- * Need to rewrite Remove
- *
- * FindHeight is the only of these which MIGHT be okay in its current form, but I am definitely not using it properly at the moment.
- * Rotate has a BIG fundamental problem - the subtree height map is WRONG if it does not account for new parent-child relationships.
- *      Technically I should just wipe that stupid map every time I modify the tree in any way, because if the tree has any changes at all the map is completely useless.
- *      ...Maybe I'm being too dramatic. MOST of the entries should still be meaningful, but the entries regarding the precise nodes involved with the rotation (child, parent, grandparent) can not be relied upon.
- *      Try just wiping those entries first and see if the map still works. By the way, I need to have MUCH better test cases which really interrogate the subtree height map and rotation logic in general.
- * Even supposing Rotate works completely correctly (which it doesn't), Remove similarly has problems with its balance factor assumptions.
- *      I think the best way to go here will be to rely on a fixed Rotate function and a now-properly-populated subtree height map.
- *      No more balance factor shortcuts, I should be using the subtree height to determine if I still need to propogate balance factor adjustments after a rotation.
- *      I suppose the non-rotation logic during Remove is still valid. After a rotation, though, I can't make any assumptions. There's just too many possibilities.
- */
+    if (error) {
+        std::cout << "Couldn't replace " << RANKING_FILE_NAME << " with " << RANKING_TEMPORARY_FILE_NAME << ": " << error.message() << "\n";
+    }
+}
 
 void PrintPokemon(BST_P::Pokemon const & pokemon) {
     BST_P::PokemonBaseStat highestStat = pokemon.GetHighestBaseStat();
@@ -85,183 +143,142 @@ void PrintTwoPokemon(BST_P::Pokemon const & A, BST_P::Pokemon const & B) {
     );
 }
 
-void BubbleSortRelativePokemonRankings(BST_P::AvlTree<BST_P::Pokemon const *> const & tree, int * relativePokemonRankings) {
-    typedef BST_P::AvlTree<BST_P::Pokemon const *>::const_iterator itr_type;
-
-    for (itr_type end = tree.cend(); end != tree.cbegin(); --end) {
-        bool isDone = true;
-
-        itr_type next = tree.cbegin();
-        itr_type prev = next++;
+BST_P::RankingAnswer AskWhichRanksHigher(BST_P::Pokemon const & A, BST_P::Pokemon const & B, bool & isViewingList) {
+    std::cout << "Should " << A.GetName() << " award more experience than " << B.GetName() << "?\n\n";
+    PrintTwoPokemon(A, B);
+    std::cout << "\n";
 
-        while (next != end) {
-            BST_P::PokemonId nextId = (*next)->GetId();
-            BST_P::PokemonId prevId = (*prev)->GetId();
-            int nextRank = relativePokemonRankings[nextId];
-            int prevRank = relativePokemonRankings[prevId];
+    char input = 0;
 
-            if (nextRank < prevRank) {
-                isDone = false;
-                relativePokemonRankings[nextId] = prevRank;
-                relativePokemonRankings[prevId] = nextRank;
-            }
-
-            prev = next++;
+    while (true) {
+        if (isViewingList) {
+            std::cout << "!!! After finishing with " << A.GetName() << ", the sorted list will be printed. !!!\n";
         }
 
-        if (isDone) {
+        std::cout << "These inputs [m, M, >, +, q, Q, 1, 2, y, Y] all mean: " << A.GetName() << " should award MORE experience than " << B.GetName() << "\n";
+        std::cout << "These inputs [l, L, <, -, p, P, 0, 9, n, N] all mean: " << A.GetName() << " should award LESS experience than " << B.GetName() << "\n";
+        std::cout << "These inputs [k, K, $, ^, w, W, s, S] all mean: Skip " << A.GetName() << " and come back to it later.\n";
+        std::cout << "These inputs [u, U, !, ?, z, Z, t, T] all mean: After finishing with " << A.GetName() << ", I'd" << (isViewingList ? " no longer " : " ") << "like to view the sorted list.\n";
+
+        std::cin >> input;
+
+        switch (input) {
+
+        case 'm':
+        case 'M':
+        case '>':
+        case '+':
+        case 'q':
+        case 'Q':
+        case '1':
+        case '2':
+        case 'y':
+        case 'Y':
+            return BST_P::RankingAnswer::Higher;
+
+        case 'l':
+        case 'L':
+        case '<':
+        case '-':
+        case 'p':
+        case 'P':
+        case '0':
+        case '9':
+        case 'n':
+        case 'N':
+            return BST_P::RankingAnswer::Lower;
+
+        case 'k':
+        case 'K':
+        case '$':
+        case '^':
+        case 'w':
+        case 'W':
+        case 's':
+        case 'S':
+            return BST_P::RankingAnswer::Skip;
+
+        case 'u':
+        case 'U':
+        case '!':
+        case '?':
+        case 'z':
+        case 'Z':
+        case 't':
+        case 'T':
+            isViewingList = !isViewingList;
             break;
+
+        default:
+            std::cout << "Please provide a valid input.\n\n";
+            break;
+
         }
     }
 }
 
-int main() {
-    srand(static_cast<unsigned int>(time(0)));
-    BST_P::Pokedex pokedex("pokedata.txt");
+// Runs a whole session with any of the ranking engines, from picking up the saved ranking to printing the results.
+template<class Engine> void RankPokemon(Engine & engine, BST_P::Pokedex const & pokedex) {
     size_t pokemonCount = pokedex.GetNumberOfPokemon();
-    size_t unsortedPokemonCount = pokemonCount;
-    BST_P::PokemonId * availablePokemonToSort = new BST_P::PokemonId [pokemonCount];
-    int * relativePokemonRankings = new int [pokemonCount + 1];
+    PokemonIdCodec codec{pokedex};
+    std::ifstream savedRanking{RANKING_FILE_NAME, std::ios::binary};
+    bool isPickingUp = false;
+
+    if (savedRanking) {
+        try {
+            engine.Load(savedRanking, codec);
+            isPickingUp = true;
+            std::cout << "Picking up where you left off, with " << engine.GetRanking().GetSize() << " Pokemon already ranked.\n\n";
+        } catch (std::exception const & e) {
+            std::cout << "Couldn't load the ranking saved in " << RANKING_FILE_NAME << ", so starting over: " << e.what() << "\n\n";
+        }
 
-    for (size_t i = 0U; i < pokemonCount; ++i) {
-        availablePokemonToSort[i] = static_cast<BST_P::PokemonId>(i + 1U);
-        relativePokemonRankings[i] = static_cast<int>(i);
+        savedRanking.close();
     }
-    relativePokemonRankings[pokemonCount] = static_cast<int>(pokemonCount);
 
-    BST_P::AvlTree<BST_P::Pokemon const *> sortedPokemonTree{
-        [relativePokemonRankings](BST_P::Pokemon const * A, BST_P::Pokemon const * B) {
-            if (A == B) {
-                return 0;
-            }
+    // Skipped and removed Pokemon come back around, so nothing already answered, or implied by what was answered, is asked again.
+    BST_P::ComparisonCache cache{pokemonCount};
+    std::ifstream recordedAnswers{ANSWERS_FILE_NAME};
 
-            if (A == nullptr) {
-                return -1;
-            }
+    // The saved ranking may be missing whatever was placed since the engine last saved, so the answers given since then are replayed too.
+    // Answers about a removed Pokemon that was answered again are dropped as they're read. The rest are replayed newest first, so the newest win if any contradict.
+    if (isPickingUp && recordedAnswers) {
+        try {
+            std::vector<BST_P::RecordedAnswer> recorded = BST_P::ReadRecordedAnswers(recordedAnswers);
 
-            if (B == nullptr) {
-                return 1;
+            for (auto answer = recorded.crbegin(); answer != recorded.crend(); ++answer) {
+                cache.Record(answer->item, answer->rankedItem, answer->answer);
             }
 
-            return (relativePokemonRankings[A->GetId()] > relativePokemonRankings[B->GetId()]) ? 1 : -1;
+            std::cout << "Remembering " << cache.GetAnswerCount() << " answers from " << ANSWERS_FILE_NAME << ", so they won't be asked again.\n\n";
+        } catch (std::exception const & e) {
+            std::cout << "Couldn't replay the answers recorded in " << ANSWERS_FILE_NAME << ", so they may be asked again: " << e.what() << "\n\n";
         }
-    };
-
-    while (unsortedPokemonCount > 0U) {
-        size_t index = rand() % unsortedPokemonCount;
-        bool isSkippingPokemon = false;
-        bool isViewingList = false;
-
-        auto inserted = sortedPokemonTree.Insert(
-            &(pokedex.FindPokemon(availablePokemonToSort[index])),
-            [&isSkippingPokemon, &isViewingList](BST_P::Pokemon const * A, BST_P::Pokemon const * B) {
-                if (isSkippingPokemon) {
-                    return 1;
-                }
-
-                if (A == B) {
-                    return 0;
-                }
-
-                if (A == nullptr) {
-                    return -1;
-                }
-
-                if (B == nullptr) {
-                    return 1;
-                }
 
-                std::cout << "Should " << A->GetName() << " award more experience than " << B->GetName() << "?\n\n";
-                PrintTwoPokemon(*A, *B);
-                std::cout << "\n";
-
-                char input = 0;
-                int result = 0;
-
-                while (result == 0) {
-                    if (isViewingList) {
-                        std::cout << "!!! After finishing with " << A->GetName() << ", the sorted list will be printed. !!!\n";
-                    }
-
-                    std::cout << "These inputs [m, M, >, +, q, Q, 1, 2, y, Y] all mean: " << A->GetName() << " should award MORE experience than " << B->GetName() << "\n";
-                    std::cout << "These inputs [l, L, <, -, p, P, 0, 9, n, N] all mean: " << A->GetName() << " should award LESS experience than " << B->GetName() << "\n";
-                    std::cout << "These inputs [k, K, $, ^, w, W, s, S] all mean: Skip " << A->GetName() << " and come back to it later.\n";
-                    std::cout << "These inputs [u, U, !, ?, z, Z, t, T] all mean: After finishing with " << A->GetName() << ", I'd" << (isViewingList ? " no longer " : " ") << "like to view the sorted list.\n";
-
-                    std::cin >> input;
+        recordedAnswers.close();
+    }
 
-                    switch (input) {
-
-                    case 'm':
-                    case 'M':
-                    case '>':
-                    case '+':
-                    case 'q':
-                    case 'Q':
-                    case '1':
-                    case '2':
-                    case 'y':
-                    case 'Y':
-                        result = 1;
-                        break;
-
-                    case 'l':
-                    case 'L':
-                    case '<':
-                    case '-':
-                    case 'p':
-                    case 'P':
-                    case '0':
-                    case '9':
-                    case 'n':
-                    case 'N':
-                        result = -1;
-                        break;
-
-                    case 'k':
-                    case 'K':
-                    case '$':
-                    case '^':
-                    case 'w':
-                    case 'W':
-                    case 's':
-                    case 'S':
-                        isSkippingPokemon = true;
-                        result = 1;
-                        break;
-
-                    case 'u':
-                    case 'U':
-                    case '!':
-                    case '?':
-                    case 'z':
-                    case 'Z':
-                    case 't':
-                    case 'T':
-                        isViewingList = !isViewingList;
-                        break;
-
-                    default:
-                        std::cout << "Please provide a valid input.\n\n";
-                        break;
+    std::ofstream answers{ANSWERS_FILE_NAME, std::ios::app};
+    bool isViewingList = false;
+    BST_P::RankingOracle oracle = BST_P::MakeCachedOracle(cache, [&pokedex, &answers, &isViewingList](BST_P::RankingItem item, BST_P::RankingItem rankedItem) {
+        BST_P::RankingAnswer answer = AskWhichRanksHigher(FindRankedPokemon(pokedex, item), FindRankedPokemon(pokedex, rankedItem), isViewingList);
+        BST_P::RecordAnswer(answers, item, rankedItem, answer);
+        answers.flush();
+        return answer;
+    });
 
-                    }
-                }
+    while (!engine.IsDone()) {
+        // Save before every question. An engine only saves the Pokemon it's finished placing, which for merge-insertion is only once a whole round is answered,
+        // and for batches once a whole batch is, but the answers given since are replayed when the ranking's picked up again.
+        SaveRanking(engine, codec);
 
-                return result;
-            }
-        );
+        isViewingList = false;
+        auto placed = engine.PlaceNext(oracle);
 
         std::cout << "\n";
 
-        if (isSkippingPokemon) {
-            std::cout << (*inserted.second)->GetName() << " will be skipped for now.\n";
-            sortedPokemonTree.Remove(std::move(inserted.second));
-        } else {
-            --unsortedPokemonCount;
-            BST_P::PokemonId swap = availablePokemonToSort[unsortedPokemonCount];
-            availablePokemonToSort[unsortedPokemonCount] = availablePokemonToSort[index];
-            availablePokemonToSort[index] = swap;
+        if (!placed.first) {
+            std::cout << FindRankedPokemon(pokedex, placed.second).GetName() << " will be skipped for now.\n";
         }
 
         if (!isViewingList) {
@@ -270,8 +287,9 @@ int main() {
 
         std::cout << "\nHere is the current list of sorted entries:\n\n";
 
-        for (decltype(sortedPokemonTree)::const_iterator itr = sortedPokemonTree.cbegin(); itr != sortedPokemonTree.cend(); ++itr) {
-            std::cout << string_format("%03u: %s\n", (*itr)->GetId(), (*itr)->GetName());
+        for (BST_P::RankingItem item : engine.GetRanking()) {
+            BST_P::Pokemon const & pokemon = FindRankedPokemon(pokedex, item);
+            std::cout << string_format("%03u: %s\n", pokemon.GetId(), pokemon.GetName());
         }
 
         std::cout << "\nWould you like to remove an entry from this list? It will be placed back into the sortable pool and you can re-evaluate it later.\n";
@@ -294,26 +312,22 @@ int main() {
                     break;
                 }
 
-                BubbleSortRelativePokemonRankings(sortedPokemonTree, relativePokemonRankings);
-
-                BST_P::PokemonId pokemonToRemoveId = static_cast<BST_P::PokemonId>(pokemonToRemove);
-                std::unique_ptr<decltype(sortedPokemonTree)::value_type> removed;
+                BST_P::RankingItem itemToRemove = static_cast<BST_P::RankingItem>(pokemonToRemove - 1U);
 
-                if (sortedPokemonTree.Remove(&(pokedex.FindPokemon(pokemonToRemoveId)), removed)) {
-                    std::cout << "\n" << (*removed)->GetName() << " was removed from the list. It will be placed back into the sortable pool to be re-evaluated later.\n\n";
-                    assert(unsortedPokemonCount < pokemonCount);
+                if (engine.Unrank(itemToRemove)) {
+                    char const * name = FindRankedPokemon(pokedex, itemToRemove).GetName();
+                    char input = 0;
+                    std::cout << "\n" << name << " was removed from the list. It will be placed back into the sortable pool to be re-evaluated later.\n";
+                    std::cout << "Would you like to answer the questions about " << name << " again? Otherwise, it will be placed using the answers you've already given. [y/n]: ";
+                    std::cin >> input;
 
-                    size_t j;
-                    for (j = unsortedPokemonCount; j < pokemonCount; ++j) {
-                        if (availablePokemonToSort[j] == pokemonToRemoveId) {
-                            availablePokemonToSort[j] = availablePokemonToSort[unsortedPokemonCount];
-                            availablePokemonToSort[unsortedPokemonCount] = pokemonToRemoveId;
-                            break;
-                        }
+                    if ((input == 'y') || (input == 'Y')) {
+                        cache.Forget(itemToRemove);
+                        BST_P::RecordForget(answers, itemToRemove);
+                        answers.flush();
                     }
 
-                    assert(j < pokemonCount);
-                    ++unsortedPokemonCount;
+                    std::cout << "\n";
                 } else {
                     pokemonToRemove = pokemonCount;
                 }
@@ -323,17 +337,36 @@ int main() {
                 std::cout << "Invalid input.\n";
             }
         }
-
-        isViewingList = false;
     }
 
-    BubbleSortRelativePokemonRankings(sortedPokemonTree, relativePokemonRankings);
+    SaveRanking(engine, codec);
     std::cout << "\n\nResults:\n\n";
 
-    for (decltype(sortedPokemonTree)::const_iterator itr = sortedPokemonTree.cbegin(); itr != sortedPokemonTree.cend(); ++itr) {
-        std::cout << (*itr)->GetName() << "\n";
+    for (BST_P::RankingItem item : engine.GetRanking()) {
+        std::cout << FindRankedPokemon(pokedex, item).GetName() << "\n";
     }
+}
 
-    delete [] relativePokemonRankings;
-    delete [] availablePokemonToSort;
+int main(int argc, char ** argv) {
+    BST_P::Pokedex pokedex("pokedata.txt");
+    std::uint32_t seed = std::random_device{}();
+
+    // Merge-insertion asks fewer questions ranking from scratch, but nothing shows up in the list until a whole round is answered.
+    // Batches show up a batch at a time, and ask fewer questions than one Pokemon at a time once the list is long.
+    // Interleaving asks about as many questions as one Pokemon at a time, but seldom asks about the same Pokemon twice in a row.
+    if ((argc > 1) && (std::strcmp(argv[1], MERGE_INSERTION_OPTION) == 0)) {
+        BST_P::MergeInsertionEngine engine{pokedex.GetNumberOfPokemon(), seed};
+        std::cout << "The ranking is only saved once a whole round is answered. If you quit partway through one, the answers you gave are kept in " << ANSWERS_FILE_NAME << " and won't be asked again.\n\n";
+        RankPokemon(engine, pokedex);
+    } else if ((argc > 2) && (std::strcmp(argv[1], BATCH_OPTION) == 0)) {
+        BST_P::RankingEngine engine{pokedex.GetNumberOfPokemon(), seed, static_cast<std::size_t>(std::strtoul(argv[2], nullptr, 10))};
+        std::cout << "The ranking is only saved once a whole batch is placed. If you quit partway through one, the answers you gave are kept in " << ANSWERS_FILE_NAME << " and won't be asked again.\n\n";
+        RankPokemon(engine, pokedex);
+    } else if ((argc > 2) && (std::strcmp(argv[1], INTERLEAVE_OPTION) == 0)) {
+        BST_P::InterleavedRankingEngine engine{pokedex.GetNumberOfPokemon(), seed, static_cast<std::size_t>(std::strtoul(argv[2], nullptr, 10))};
+        RankPokemon(engine, pokedex);
+    } else {
+        BST_P::RankingEngine engine{pokedex.GetNumberOfPokemon(), seed};
+        RankPokemon(engine, pokedex);
+    }
 }
@@ -1,13 +1,14 @@
 #pragma once
+#include <cstdio>
 #include <string>
 #include <memory>
-#include <exception>
+#include <stdexcept>
 
 template <class... Args> std::string string_format(std::string const & format, Args ... args) {
     int rawSize = 1 + std::snprintf(nullptr, 0, format.c_str(), args ...);
 
     if (rawSize <= 0) {
-        throw std::exception{"Bad string format passed to cpp11-strfmt::string_format."};
+        throw std::invalid_argument{"Bad string format passed to cpp11-strfmt::string_format."};
     }
 
     size_t size = static_cast<size_t>(rawSize);